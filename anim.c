@@ -0,0 +1,362 @@
+#include "anim.h"
+
+// Longest run or literal block of one RLE token
+#define RLE_MAX 128
+
+// A record and its length must fit in the last byte of one chunk and the
+// whole next one
+#define CHUNK_MIN (ANIM_RECORD_MAX + 1)
+_Static_assert(ANIM_STREAM_CHUNK >= CHUNK_MIN, "ANIM_STREAM_CHUNK too small for a record");
+
+// Beating heart on one module, loops forever
+static const uint8_t anim_demo_data[] = {
+    ANIM_FRAME(ANIM_KEY, ANIM_CUT, 300),
+    ANIM_LITERALS(1), 0x66, ANIM_RUN(3), 0xFF, ANIM_LITERALS(4), 0x7E, 0x3C, 0x18, 0x00,
+    ANIM_FRAME(ANIM_KEY, ANIM_CUT, 300),
+    ANIM_LITERALS(6), 0x00, 0x24, 0x7E, 0x7E, 0x3C, 0x18, ANIM_RUN(2), 0x00,
+    // Back to the big heart: the XOR with the small one
+    ANIM_FRAME(ANIM_DELTA, ANIM_FADE, 600),
+    ANIM_LITERALS(8), 0x66, 0xDB, 0x81, 0x81, 0x42, 0x24, 0x18, 0x00,
+    ANIM_FRAME(ANIM_KEY, ANIM_WIPE, 500),
+    ANIM_RUN(8), 0x00,
+    ANIM_FRAME(ANIM_KEY, ANIM_SLIDE, 800),
+    ANIM_LITERALS(1), 0x66, ANIM_RUN(3), 0xFF, ANIM_LITERALS(4), 0x7E, 0x3C, 0x18, 0x00,
+};
+
+const anim_seq_t anim_demo = {
+    .data = anim_demo_data,
+    .frames = 5,
+    .loop_frame = 0,
+    .loop_offset = 0,
+    .devices = 1,
+};
+
+void anim_decoder_start(anim_decoder_t *d, const anim_seq_t *seq) {
+    d->seq = seq;
+    d->pos = seq->data;
+    d->index = 0;
+    d->stream = 0;
+}
+
+void anim_decoder_stream(anim_decoder_t *d, const anim_seq_t *seq, stream_t *s) {
+    d->seq = seq;
+    d->pos = 0;
+    d->index = 0;
+    d->stream = s;
+}
+
+// Expand an RLE body over size bytes of frame, overwriting or XOR-ing
+static uint8_t rle_decode(const uint8_t **src, uint8_t *frame, uint16_t size, uint8_t xor) {
+    const uint8_t *s = *src;
+    uint16_t i = 0;
+
+    while (i < size) {
+        uint8_t ctrl = *s++;
+        uint16_t n = (ctrl & 0x7F) + 1;
+        if (i + n > size) return 0;
+
+        if (ctrl & 0x80) {
+            uint8_t v = *s++;
+            for (; n > 0; n--, i++) {
+                frame[i] = xor ? frame[i] ^ v : v;
+            }
+        } else {
+            for (; n > 0; n--, i++) {
+                frame[i] = xor ? frame[i] ^ *s++ : *s++;
+            }
+        }
+    }
+    *src = s;
+    return 1;
+}
+
+// Header and body of the record at *src
+static uint8_t decode_record(const uint8_t **src, uint16_t size, uint8_t *frame,
+                             anim_frame_info_t *info) {
+    const uint8_t *s = *src;
+    uint8_t flags = s[0];
+    info->duration_ms = s[1] | ((uint16_t)s[2] << 8);
+    info->transition = (anim_transition_t)((flags & ANIM_TRANS_MASK) >> ANIM_TRANS_SHIFT);
+    s += 3;
+
+    if (!rle_decode(&s, frame, size, (flags & ANIM_TYPE_MASK) == ANIM_DELTA)) {
+        return 0;
+    }
+    *src = s;
+    return 1;
+}
+
+// Next length-prefixed record once all of it is in RAM. The stream wraps
+// to the loop record by itself.
+static uint8_t decode_streamed(anim_decoder_t *d, uint8_t *frame, anim_frame_info_t *info) {
+    stream_t *st = d->stream;
+    uint8_t record[ANIM_RECORD_MAX];
+
+    stream_poll(st);
+    if (stream_available(st) < 2) return ANIM_WAIT;
+    uint16_t len = stream_peek(st, 0) | ((uint16_t)stream_peek(st, 1) << 8);
+    if (len < 4 || len > ANIM_RECORD_MAX) return 0;
+    if (stream_available(st) < 2u + len) return ANIM_WAIT;
+
+    stream_read(st, 0, 2);
+    stream_read(st, record, len);
+    stream_poll(st);
+
+    const uint8_t *s = record;
+    if (!decode_record(&s, 8 * d->seq->devices, frame, info) || s != record + len) {
+        return 0;
+    }
+    d->index++;
+    if (d->index >= d->seq->frames) {
+        d->index = d->seq->loop_frame;
+    }
+    return 1;
+}
+
+uint8_t anim_decode_next(anim_decoder_t *d, uint8_t *frame, anim_frame_info_t *info) {
+    const anim_seq_t *seq = d->seq;
+
+    if (d->stream) {
+        return decode_streamed(d, frame, info);
+    }
+
+    if (d->index >= seq->frames) {
+        d->pos = seq->data + seq->loop_offset;
+        d->index = seq->loop_frame;
+    }
+
+    const uint8_t *s = d->pos;
+    if (!decode_record(&s, 8 * seq->devices, frame, info)) {
+        return 0;
+    }
+    d->pos = s;
+    d->index++;
+    return 1;
+}
+
+static void put_u32(uint8_t *out, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    return in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+uint16_t anim_image_header(const anim_seq_t *seq, uint32_t loop_offset, uint32_t size,
+                           uint8_t *out) {
+    put_u32(&out[0], ANIM_IMAGE_MAGIC);
+    out[4] = (uint8_t)seq->frames;
+    out[5] = (uint8_t)(seq->frames >> 8);
+    out[6] = (uint8_t)seq->loop_frame;
+    out[7] = (uint8_t)(seq->loop_frame >> 8);
+    out[8] = seq->devices;
+    out[9] = out[10] = out[11] = 0;
+    put_u32(&out[12], loop_offset);
+    put_u32(&out[16], size);
+    return ANIM_IMAGE_HEADER;
+}
+
+uint8_t anim_image_open(anim_seq_t *seq, stream_t *s, const storage_t *dev, uint8_t *buf,
+                        uint16_t chunk, uint32_t addr) {
+    uint8_t h[ANIM_IMAGE_HEADER];
+
+    while (dev->busy());
+    dev->read(addr, h, sizeof(h));
+    while (dev->busy());
+
+    // Erased flash reads 0xFF and fails the magic
+    if (get_u32(&h[0]) != ANIM_IMAGE_MAGIC) return 0;
+
+    seq->data = 0;
+    seq->frames = h[4] | ((uint16_t)h[5] << 8);
+    seq->loop_frame = h[6] | ((uint16_t)h[7] << 8);
+    seq->loop_offset = 0;
+    seq->devices = h[8];
+    uint32_t loop_offset = get_u32(&h[12]);
+    uint32_t size = get_u32(&h[16]);
+    if (seq->frames == 0 || seq->devices == 0 || seq->devices > MAX7219_NUM_DEVICES ||
+        seq->loop_frame >= seq->frames || loop_offset >= size || chunk < CHUNK_MIN) {
+        return 0;
+    }
+
+    stream_open(s, dev, buf, chunk, addr + ANIM_IMAGE_HEADER, size, loop_offset);
+    return 1;
+}
+
+// Greedy RLE: runs of three or more become run tokens, the rest literals
+static uint16_t rle_encode(const uint8_t *prev, const uint8_t *cur, uint16_t size, uint8_t *out) {
+    uint16_t o = 0;
+    uint16_t i = 0;
+
+#define BYTE_AT(k) (prev ? (uint8_t)(prev[k] ^ cur[k]) : cur[k])
+    while (i < size) {
+        uint16_t run = 1;
+        while (i + run < size && run < RLE_MAX && BYTE_AT(i + run) == BYTE_AT(i)) run++;
+
+        if (run >= 3) {
+            out[o++] = ANIM_RUN(run);
+            out[o++] = BYTE_AT(i);
+            i += run;
+            continue;
+        }
+
+        // Literals up to the start of the next run of three
+        uint16_t start = i;
+        while (i < size && i - start < RLE_MAX) {
+            if (i + 2 < size && BYTE_AT(i) == BYTE_AT(i + 1) && BYTE_AT(i) == BYTE_AT(i + 2)) break;
+            i++;
+        }
+        out[o++] = ANIM_LITERALS(i - start);
+        for (uint16_t k = start; k < i; k++) {
+            out[o++] = BYTE_AT(k);
+        }
+    }
+#undef BYTE_AT
+    return o;
+}
+
+uint16_t anim_encode_frame(const uint8_t *prev, const uint8_t *cur, uint16_t size,
+                           uint16_t duration_ms, anim_transition_t transition,
+                           uint8_t *out) {
+    uint16_t len = rle_encode(0, cur, size, out + 3);
+    uint8_t type = ANIM_KEY;
+
+    // Try the delta behind the key body and keep it if it is smaller
+    if (prev) {
+        uint16_t delta = rle_encode(prev, cur, size, out + 3 + len);
+        if (delta < len) {
+            for (uint16_t i = 0; i < delta; i++) {
+                out[3 + i] = out[3 + len + i];
+            }
+            len = delta;
+            type = ANIM_DELTA;
+        }
+    }
+
+    out[0] = (uint8_t)(type | (transition << ANIM_TRANS_SHIFT));
+    out[1] = (uint8_t)duration_ms;
+    out[2] = (uint8_t)(duration_ms >> 8);
+    return 3 + len;
+}
+
+static uint8_t pixel(const uint8_t *frame, uint16_t x, uint8_t row) {
+    return (frame[(x / 8) * 8 + row] >> (7 - x % 8)) & 1;
+}
+
+// Build out for the current point of the transition
+static void compose(anim_player_t *p) {
+    uint16_t bytes = 8 * p->dec.seq->devices;
+    uint16_t width = 8 * p->dec.seq->devices;
+    uint16_t trans = p->info.duration_ms < ANIM_TRANSITION_MS ? p->info.duration_ms : ANIM_TRANSITION_MS;
+    anim_transition_t t = p->info.transition;
+
+    p->out_intensity = p->intensity;
+    if (t == ANIM_CUT || p->elapsed_ms >= trans) {
+        for (uint16_t i = 0; i < bytes; i++) p->out[i] = p->cur[i];
+        return;
+    }
+
+    if (t == ANIM_FADE) {
+        // Down on the old frame for the first half, up on the new one
+        uint16_t half = trans / 2;
+        const uint8_t *src = p->cur;
+        if (p->elapsed_ms < half) {
+            src = p->prev;
+            p->out_intensity = (uint8_t)(p->intensity * (half - p->elapsed_ms) / half);
+        } else {
+            p->out_intensity = (uint8_t)(p->intensity * (p->elapsed_ms - half) / (trans - half));
+        }
+        for (uint16_t i = 0; i < bytes; i++) p->out[i] = src[i];
+        return;
+    }
+
+    // Columns of the new frame shown so far
+    uint16_t cols = (uint16_t)((uint32_t)width * p->elapsed_ms / trans);
+    for (uint16_t i = 0; i < bytes; i++) p->out[i] = 0;
+    for (uint16_t x = 0; x < width; x++) {
+        for (uint8_t row = 0; row < 8; row++) {
+            uint8_t on;
+            if (t == ANIM_WIPE) {
+                on = x < cols ? pixel(p->cur, x, row) : pixel(p->prev, x, row);
+            } else {
+                on = x + cols < width ? pixel(p->prev, x + cols, row)
+                                      : pixel(p->cur, x + cols - width, row);
+            }
+            p->out[(x / 8) * 8 + row] |= (uint8_t)(on << (7 - x % 8));
+        }
+    }
+}
+
+// Decode the first frame once the decoder is set up
+static void start(anim_player_t *p, const anim_seq_t *seq, uint8_t intensity) {
+    for (uint16_t i = 0; i < ANIM_FRAME_BYTES; i++) {
+        p->prev[i] = 0;
+        p->cur[i] = 0;
+        p->out[i] = 0;
+    }
+    p->intensity = intensity;
+    p->elapsed_ms = 0;
+    p->stalls = 0;
+    p->ok = 0;
+    if (seq->frames == 0 || seq->devices > MAX7219_NUM_DEVICES) return;
+
+    uint8_t r = anim_decode_next(&p->dec, p->cur, &p->info);
+    if (r == ANIM_WAIT) {
+        // Blank until the first record arrives, the next tick retries
+        p->info.duration_ms = 1;
+        p->info.transition = ANIM_CUT;
+        p->elapsed_ms = 1;
+    }
+    p->ok = r != 0;
+    if (!p->ok) return;
+    if (p->info.duration_ms == 0) p->info.duration_ms = 1;
+    compose(p);
+}
+
+void anim_play(anim_player_t *p, const anim_seq_t *seq, uint8_t intensity) {
+    anim_decoder_start(&p->dec, seq);
+    start(p, seq, intensity);
+}
+
+void anim_play_stream(anim_player_t *p, const anim_seq_t *seq, stream_t *s, uint8_t intensity) {
+    anim_decoder_stream(&p->dec, seq, s);
+    start(p, seq, intensity);
+}
+
+uint8_t anim_tick(anim_player_t *p, uint16_t ms) {
+    if (!p->ok) return 0;
+
+    uint16_t bytes = 8 * p->dec.seq->devices;
+    uint8_t old_intensity = p->out_intensity;
+    uint8_t changed = 0;
+
+    p->elapsed_ms += ms;
+    while (p->elapsed_ms >= p->info.duration_ms) {
+        uint16_t shown = p->info.duration_ms;
+        for (uint16_t i = 0; i < bytes; i++) p->prev[i] = p->cur[i];
+        uint8_t r = anim_decode_next(&p->dec, p->cur, &p->info);
+        if (r == ANIM_WAIT) {
+            // Hold the frame at its end, the next tick tries again
+            p->elapsed_ms = shown;
+            p->stalls++;
+            break;
+        }
+        if (!r) {
+            p->ok = 0;
+            return 0;
+        }
+        p->elapsed_ms -= shown;
+        // A zero duration would never advance
+        if (p->info.duration_ms == 0) p->info.duration_ms = 1;
+    }
+
+    uint8_t before[ANIM_FRAME_BYTES];
+    for (uint16_t i = 0; i < bytes; i++) before[i] = p->out[i];
+    compose(p);
+    for (uint16_t i = 0; i < bytes; i++) {
+        if (before[i] != p->out[i]) changed = 1;
+    }
+    return changed || old_intensity != p->out_intensity;
+}
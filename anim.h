@@ -0,0 +1,146 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <stdint.h>
+#include "max7219.h"
+#include "stream.h"
+
+// Animation sequences stored compressed in flash and decoded one frame
+// at a time. A frame is 8 row bytes per device, device 0 first, the
+// layout of fb_set_row(). tests/test_anim.c and tools/flashsim.c run the
+// same decoder on a PC against encoded sequences and images.
+#define ANIM_FRAME_BYTES (8 * MAX7219_NUM_DEVICES)
+
+// Frame record: flags, duration_lo, duration_hi, then an RLE body that
+// covers the sequence's frame size. A key body holds the rows, a delta
+// body the XOR with the previous frame (unchanged rows become zero runs).
+#define ANIM_KEY        0x00
+#define ANIM_DELTA      0x01
+#define ANIM_TYPE_MASK  0x01
+#define ANIM_TRANS_SHIFT 1
+#define ANIM_TRANS_MASK (0x03 << ANIM_TRANS_SHIFT)
+
+// Transition from the previous frame into a frame
+typedef enum {
+    ANIM_CUT,
+    ANIM_WIPE,      // New columns replace old ones from the left
+    ANIM_SLIDE,     // New frame pushes the old one out to the left
+    ANIM_FADE       // Intensity down to 0 on the old frame, up on the new
+} anim_transition_t;
+
+// RLE tokens: a control byte n < 0x80 is followed by n + 1 literal
+// bytes, n >= 0x80 by one byte repeated (n & 0x7F) + 1 times
+#define ANIM_LITERALS(n) ((uint8_t)((n) - 1))
+#define ANIM_RUN(n)      ((uint8_t)(0x80 | ((n) - 1)))
+
+// Record header for hand-written sequences
+#define ANIM_FRAME(type, trans, ms) \
+    (uint8_t)((type) | ((trans) << ANIM_TRANS_SHIFT)), (uint8_t)(ms), (uint8_t)((ms) >> 8)
+
+// Time a transition takes, cut short by shorter frames
+#ifndef ANIM_TRANSITION_MS
+#define ANIM_TRANSITION_MS 200
+#endif
+
+typedef struct {
+    const uint8_t *data;
+    uint16_t frames;
+    uint16_t loop_frame;    // Frame playback returns to, must be a key frame
+    uint16_t loop_offset;   // Its byte offset in data
+    uint8_t devices;        // Frame width in modules, at most MAX7219_NUM_DEVICES
+} anim_seq_t;
+
+// Built-in sequence, a beating heart on one module
+extern const anim_seq_t anim_demo;
+
+// Longest record: header and a key body of literal blocks
+#define ANIM_RECORD_MAX (3 + ANIM_FRAME_BYTES + ANIM_FRAME_BYTES / 128 + 1)
+
+// Sequence image for external storage: a header, then every record
+// behind a 16-bit little-endian length. Header fields are little-endian:
+//   magic[4], frames[2], loop_frame[2], devices[1], reserved[3],
+//   loop_offset[4] (of the loop record, from the first record),
+//   size[4] (of all length-prefixed records)
+#define ANIM_IMAGE_MAGIC  0x31414D58u   // "XMA1"
+#define ANIM_IMAGE_HEADER 20
+
+// Read-ahead chunk of a streamed image, two of them per stream. Must be
+// larger than a record.
+#ifndef ANIM_STREAM_CHUNK
+#define ANIM_STREAM_CHUNK 256
+#endif
+
+// Streaming decoder state: the position in flash and nothing else, the
+// frame itself is updated in place. Sequences on external storage are
+// read through stream instead of pos.
+typedef struct {
+    const anim_seq_t *seq;
+    const uint8_t *pos;
+    uint16_t index;         // Frame that decodes next
+    stream_t *stream;       // NULL for sequences in memory
+} anim_decoder_t;
+
+// anim_decode_next() result when the next record is not in RAM yet
+#define ANIM_WAIT 2
+
+typedef struct {
+    uint16_t duration_ms;
+    anim_transition_t transition;
+} anim_frame_info_t;
+
+void anim_decoder_start(anim_decoder_t *d, const anim_seq_t *seq);
+
+// Decode records of seq (whose data is unused) from a stream opened by
+// anim_image_open()
+void anim_decoder_stream(anim_decoder_t *d, const anim_seq_t *seq, stream_t *s);
+
+// Decode the next frame into frame (which must hold the previous one for
+// deltas), wrapping to the loop point after the last. Returns 0 on a
+// malformed record, ANIM_WAIT when a stream has not read that far yet
+// (frame and info are left alone).
+uint8_t anim_decode_next(anim_decoder_t *d, uint8_t *frame, anim_frame_info_t *info);
+
+// Header for an image of seq, records being the size of what follows and
+// loop_offset the position of the loop record in it. Returns
+// ANIM_IMAGE_HEADER.
+uint16_t anim_image_header(const anim_seq_t *seq, uint32_t loop_offset, uint32_t size,
+                           uint8_t *out);
+
+// Read the image header at addr (blocking) and open s on its records,
+// looping like the sequence. buf holds 2 * chunk bytes, chunk is
+// normally ANIM_STREAM_CHUNK. Returns 0 when there is no valid image or
+// chunk is too small for its records.
+uint8_t anim_image_open(anim_seq_t *seq, stream_t *s, const storage_t *dev, uint8_t *buf,
+                        uint16_t chunk, uint32_t addr);
+
+// Encode one record for frame cur following prev (NULL for the first),
+// as a delta when that is smaller. Returns the record length; out needs
+// room for both candidates, 3 + 2 * (size + size / 128 + 1) bytes.
+uint16_t anim_encode_frame(const uint8_t *prev, const uint8_t *cur, uint16_t size,
+                           uint16_t duration_ms, anim_transition_t transition,
+                           uint8_t *out);
+
+// Player: decodes, times frames and composes transitions
+typedef struct {
+    anim_decoder_t dec;
+    anim_frame_info_t info;
+    uint8_t prev[ANIM_FRAME_BYTES];     // Frame being left
+    uint8_t cur[ANIM_FRAME_BYTES];      // Frame being entered
+    uint8_t out[ANIM_FRAME_BYTES];      // What to show now
+    uint8_t intensity;                  // Full intensity
+    uint8_t out_intensity;              // Intensity to show now
+    uint16_t elapsed_ms;
+    uint8_t ok;
+    uint32_t stalls;                    // Ticks a streamed frame was late
+} anim_player_t;
+
+void anim_play(anim_player_t *p, const anim_seq_t *seq, uint8_t intensity);
+
+// Play from a stream opened by anim_image_open(). A frame whose record
+// has not arrived stays on until it has.
+void anim_play_stream(anim_player_t *p, const anim_seq_t *seq, stream_t *s, uint8_t intensity);
+
+// Advance by ms, returns 1 when out or out_intensity changed
+uint8_t anim_tick(anim_player_t *p, uint16_t ms);
+
+#endif
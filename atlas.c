@@ -0,0 +1,88 @@
+#include "atlas.h"
+
+uint16_t atlas_index(const atlas_t *a, uint32_t codepoint) {
+    uint16_t lo = 0;
+    uint16_t hi = a->range_count;
+
+    while (lo < hi) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        const atlas_range_t *r = &a->ranges[mid];
+        if (codepoint < r->first) {
+            hi = mid;
+        } else if (codepoint - r->first >= r->count) {
+            lo = (uint16_t)(mid + 1);
+        } else {
+            return (uint16_t)(r->glyph + (codepoint - r->first));
+        }
+    }
+    return a->missing;
+}
+
+uint8_t atlas_left(const atlas_t *a, uint16_t glyph) {
+    if (glyph >= a->glyphs || !a->metrics) return 0;
+    return a->metrics[glyph] >> 4;
+}
+
+uint8_t atlas_width(const atlas_t *a, uint16_t glyph) {
+    if (glyph >= a->glyphs) return 0;
+    if (!a->metrics) return 8;
+    return a->metrics[glyph] & 0x0F;
+}
+
+// n <= 8 bits from bit position pos, MSB first. The padding byte keeps
+// the second read inside the table.
+static uint8_t read_bits(const uint8_t *bits, uint32_t pos, uint8_t n) {
+    const uint8_t *p = &bits[pos >> 3];
+    uint16_t pair = (uint16_t)((p[0] << 8) | p[1]);
+    return (uint8_t)((uint16_t)(pair << (pos & 7)) >> (16 - n));
+}
+
+static uint8_t popcount8(uint8_t v) {
+    v = (uint8_t)(v - ((v >> 1) & 0x55));
+    v = (uint8_t)((v & 0x33) + ((v >> 2) & 0x33));
+    return (uint8_t)((v + (v >> 4)) & 0x0F);
+}
+
+// Bits glyph g takes in the stream starting at pos
+static uint32_t glyph_bits(const atlas_t *a, uint16_t g, uint32_t pos) {
+    uint8_t width = a->metrics[g] & 0x0F;
+    if (width == 0) return 0;
+    if (!(a->flags & ATLAS_ROW_MASK)) return 8u * width;
+    return 8u + (uint32_t)popcount8(read_bits(a->bits, pos, 8)) * width;
+}
+
+void atlas_decode(const atlas_t *a, uint16_t glyph, uint8_t rows[8]) {
+    for (int r = 0; r < 8; r++) rows[r] = 0x00;
+    if (glyph >= a->glyphs) return;
+
+    if (!(a->flags & ATLAS_CROPPED)) {
+        for (int r = 0; r < 8; r++) {
+            rows[r] = a->bits[glyph * 8u + r];
+        }
+        return;
+    }
+
+    // Walk from the start of the group
+    uint16_t g = (uint16_t)(glyph - glyph % ATLAS_GROUP);
+    uint32_t pos = a->offsets[glyph / ATLAS_GROUP];
+    for (; g < glyph; g++) {
+        pos += glyph_bits(a, g, pos);
+    }
+
+    uint8_t left = a->metrics[glyph] >> 4;
+    uint8_t width = a->metrics[glyph] & 0x0F;
+    if (width == 0) return;
+
+    uint8_t mask = 0xFF;
+    if (a->flags & ATLAS_ROW_MASK) {
+        mask = read_bits(a->bits, pos, 8);
+        pos += 8;
+    }
+    for (int r = 0; r < 8; r++) {
+        if (!(mask & (0x80 >> r))) continue;
+        // Cropped bits back to their column: the first at bit 7 - left
+        uint8_t v = read_bits(a->bits, pos, width);
+        rows[r] = (uint8_t)((v << (8 - width)) >> left);
+        pos += width;
+    }
+}
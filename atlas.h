@@ -0,0 +1,67 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <stdint.h>
+
+// Compressed glyph atlases generated by tools/fontc from BDF or PSF
+// fonts. A glyph decodes to the same eight row bytes as font_glyphs
+// (bit 7 is the leftmost column), so atlas glyphs draw anywhere the
+// built-in font does. font.c remains the display path: the marquee,
+// canvas and clock face read font_glyphs, and atlas_builtin is the same
+// font compiled through fontc, kept to check the tool (tests/test_atlas.c)
+// and measure the decoder (bench.c). Larger fonts are what atlases are
+// for.
+//
+// Glyph bits are one MSB-first stream. Depending on flags a glyph is
+//   8 rows of 8 bits                        (no ATLAS_CROPPED)
+//   8 rows of width bits                    (ATLAS_CROPPED)
+//   a lit row mask, then width bits per lit row (ATLAS_ROW_MASK too)
+// where the cropped rows start at the glyph's left column. A glyph of
+// width 0 is blank and takes no bits.
+#define ATLAS_CROPPED  0x01
+#define ATLAS_ROW_MASK 0x02
+
+// offsets[] holds the bit position of every ATLAS_GROUP-th glyph, the
+// decoder skips over the others of its group
+#define ATLAS_GROUP 8
+
+// Returned for code points outside every range of an atlas without a
+// missing glyph
+#define ATLAS_NO_GLYPH 0xFFFF
+
+// Code points first .. first + count - 1 are glyphs glyph onwards
+typedef struct {
+    uint32_t first;
+    uint16_t count;
+    uint16_t glyph;
+} atlas_range_t;
+
+typedef struct {
+    const atlas_range_t *ranges;    // Sorted by code point
+    const uint8_t *metrics;         // Left column << 4 | width, NULL for 8x8 cells
+    const uint32_t *offsets;        // NULL without ATLAS_CROPPED
+    const uint8_t *bits;            // One padding byte past the last glyph
+    uint16_t range_count;
+    uint16_t glyphs;
+    uint16_t missing;               // Glyph for uncovered code points
+    uint8_t flags;
+} atlas_t;
+
+// The built-in font, compiled from fonts/builtin.bdf
+extern const atlas_t atlas_builtin;
+
+// Glyph for a code point by binary search of the ranges, the missing
+// glyph when none covers it
+uint16_t atlas_index(const atlas_t *a, uint32_t codepoint);
+
+// As font_left() and font_width(): the first lit column and the number
+// of columns from there to the last lit one. A blank glyph has width 0
+// (font_width() reports FONT_BLANK_WIDTH), an 8x8 cell atlas width 8.
+uint8_t atlas_left(const atlas_t *a, uint16_t glyph);
+uint8_t atlas_width(const atlas_t *a, uint16_t glyph);
+
+// Expand a glyph into eight row bytes. ATLAS_NO_GLYPH and out of range
+// indices decode blank.
+void atlas_decode(const atlas_t *a, uint16_t glyph, uint8_t rows[8]);
+
+#endif
@@ -0,0 +1,86 @@
+// Generated by tools/fontc from builtin.bdf, do not edit.
+// 82 glyphs in 15 ranges, 675 bytes of flash.
+#include "atlas.h"
+
+static const atlas_range_t atlas_builtin_ranges[] = {
+    { 0x0020, 2, 1 },
+    { 0x002C, 3, 3 },
+    { 0x0030, 11, 6 },
+    { 0x003F, 1, 17 },
+    { 0x0041, 26, 18 },
+    { 0x0061, 26, 44 },
+    { 0x00C7, 1, 70 },
+    { 0x00D6, 1, 71 },
+    { 0x00DC, 1, 72 },
+    { 0x00E7, 1, 73 },
+    { 0x00F6, 1, 74 },
+    { 0x00FC, 1, 75 },
+    { 0x011E, 2, 76 },
+    { 0x0130, 2, 78 },
+    { 0x015E, 2, 80 },
+};
+
+static const uint8_t atlas_builtin_metrics[] = {
+    0x08, 0x00, 0x32, 0x32, 0x16, 0x32, 0x16, 0x25, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x32, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x24, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16,
+    0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x16, 0x15, 0x15, 0x15, 0x15,
+    0x15, 0x15, 0x15, 0x15, 0x23, 0x15, 0x15, 0x23, 0x15, 0x15, 0x15, 0x15,
+    0x15, 0x15, 0x15, 0x24, 0x15, 0x15, 0x15, 0x15, 0x15, 0x15, 0x16, 0x16,
+    0x16, 0x15, 0x15, 0x15, 0x16, 0x15, 0x24, 0x23, 0x16, 0x15,
+};
+
+static const uint32_t atlas_builtin_offsets[] = {
+    0, 248, 632, 984, 1352, 1736, 2088, 2376,
+    2688, 3024, 3336,
+};
+
+static const uint8_t atlas_builtin_bits[] = {
+    0xFF, 0xC3, 0xA5, 0x99, 0x99, 0xA5, 0xC3, 0xFF, 0xFF, 0xCC, 0x00, 0x3E,
+    0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x7A, 0x18, 0x61, 0x86,
+    0x18, 0x5E, 0x23, 0x28, 0x42, 0x10, 0x9F, 0x7A, 0x10, 0x42, 0x10, 0x84,
+    0x3F, 0x7A, 0x10, 0x4E, 0x04, 0x18, 0x5E, 0x08, 0x62, 0x92, 0x8B, 0xF0,
+    0x82, 0xFE, 0x08, 0x3E, 0x04, 0x18, 0x5E, 0x7A, 0x18, 0x3E, 0x86, 0x18,
+    0x5E, 0xFC, 0x10, 0x84, 0x21, 0x04, 0x10, 0x7A, 0x18, 0x5E, 0x86, 0x18,
+    0x5E, 0x7A, 0x18, 0x61, 0x7C, 0x18, 0x5E, 0x3C, 0x3C, 0x7A, 0x10, 0x46,
+    0x20, 0x80, 0x08, 0x7A, 0x18, 0x61, 0xFE, 0x18, 0x61, 0xFA, 0x18, 0x7E,
+    0x86, 0x18, 0x7E, 0x7A, 0x18, 0x20, 0x82, 0x08, 0x5E, 0xF2, 0x28, 0x61,
+    0x86, 0x18, 0xBC, 0xFE, 0x08, 0x3E, 0x82, 0x08, 0x3F, 0xFE, 0x08, 0x3E,
+    0x82, 0x08, 0x20, 0x7A, 0x18, 0x20, 0x9E, 0x18, 0x5E, 0x86, 0x18, 0x7F,
+    0x86, 0x18, 0x61, 0xF2, 0x22, 0x22, 0x2F, 0x04, 0x10, 0x41, 0x06, 0x18,
+    0x5E, 0x86, 0x29, 0x28, 0xC2, 0x89, 0x22, 0x82, 0x08, 0x20, 0x82, 0x08,
+    0x3F, 0x87, 0x3B, 0x61, 0x86, 0x18, 0x61, 0x87, 0x1A, 0x65, 0x8E, 0x18,
+    0x61, 0x7A, 0x18, 0x61, 0x86, 0x18, 0x5E, 0xFA, 0x18, 0x7E, 0x82, 0x08,
+    0x20, 0x7A, 0x18, 0x61, 0x86, 0x58, 0x9D, 0xFA, 0x18, 0x7E, 0xC2, 0x89,
+    0x22, 0x7A, 0x18, 0x1C, 0x08, 0x18, 0x5E, 0xFC, 0x82, 0x08, 0x20, 0x82,
+    0x08, 0x86, 0x18, 0x61, 0x86, 0x18, 0x5E, 0x86, 0x18, 0x61, 0x85, 0x23,
+    0x00, 0x86, 0x18, 0x61, 0x86, 0xDC, 0xE1, 0x86, 0x14, 0x8C, 0x31, 0x28,
+    0x61, 0x86, 0x14, 0x8C, 0x20, 0x82, 0x08, 0xFC, 0x10, 0x84, 0x21, 0x08,
+    0x3F, 0x00, 0x1C, 0x17, 0xC6, 0x2F, 0x84, 0x3D, 0x18, 0xC6, 0x3E, 0x00,
+    0x1F, 0x08, 0x42, 0x0F, 0x08, 0x5F, 0x18, 0xC6, 0x2F, 0x00, 0x1D, 0x1F,
+    0xC2, 0x0F, 0x3A, 0x11, 0xE4, 0x21, 0x08, 0x00, 0x1F, 0x18, 0xBC, 0x2E,
+    0x84, 0x21, 0xE8, 0xC6, 0x31, 0x43, 0x24, 0x97, 0x08, 0x06, 0x10, 0x86,
+    0x2E, 0x84, 0x23, 0x2E, 0x4A, 0x31, 0xC9, 0x24, 0x97, 0x00, 0x35, 0x5A,
+    0xD6, 0xB5, 0x00, 0x3D, 0x18, 0xC6, 0x31, 0x00, 0x1D, 0x18, 0xC6, 0x2E,
+    0x00, 0x3D, 0x18, 0xFA, 0x10, 0x00, 0x1F, 0x18, 0xBC, 0x21, 0x00, 0x2F,
+    0x88, 0x42, 0x10, 0x00, 0x1F, 0x07, 0x04, 0x3E, 0x44, 0xE4, 0x44, 0x43,
+    0x00, 0x23, 0x18, 0xC6, 0x2F, 0x00, 0x23, 0x18, 0xC5, 0x44, 0x00, 0x23,
+    0x1A, 0xD6, 0xAA, 0x00, 0x22, 0xA2, 0x11, 0x51, 0x00, 0x23, 0x18, 0xBC,
+    0x2E, 0x00, 0x3E, 0x11, 0x11, 0x1F, 0x7A, 0x18, 0x20, 0x82, 0x17, 0x84,
+    0x48, 0x07, 0xA1, 0x86, 0x18, 0x5E, 0x48, 0x08, 0x61, 0x86, 0x18, 0x5E,
+    0x03, 0xE1, 0x08, 0x41, 0xE4, 0x50, 0x1D, 0x18, 0xC6, 0x2E, 0x50, 0x23,
+    0x18, 0xC6, 0x2F, 0x48, 0xC7, 0xA0, 0x9E, 0x18, 0x5E, 0x51, 0x1F, 0x18,
+    0xBC, 0x2E, 0x20, 0xF2, 0x22, 0x2F, 0x03, 0x24, 0x97, 0x7A, 0x18, 0x1E,
+    0x06, 0x17, 0x84, 0x03, 0xE0, 0xE0, 0x87, 0xC4, 0x00,
+};
+
+const atlas_t atlas_builtin = {
+    .ranges = atlas_builtin_ranges,
+    .metrics = atlas_builtin_metrics,
+    .offsets = atlas_builtin_offsets,
+    .bits = atlas_builtin_bits,
+    .range_count = 15,
+    .glyphs = 82,
+    .missing = 0,
+    .flags = ATLAS_CROPPED,
+};
@@ -0,0 +1,292 @@
+#include "stm32f4xx.h"
+#include "bench.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "font.h"
+#include "anim.h"
+#include "watchdog.h"
+#include "slice.h"
+#include "dlcache.h"
+#include "atlas.h"
+
+// Repetitions of the short benchmarks
+#define BENCH_REPEAT 64
+
+// Glyph sequences of the carousel texts
+typedef struct {
+    const char *name;
+    const char *text;
+} bench_sequence_t;
+
+static const bench_sequence_t sequences[] = {
+    { "digits",   "0123456789" },
+    { "capitals", "ABCÇDEFGĞHIİJKLMNOÖPRSŞTUÜVYZ" },
+    { "letters",  "abcçdefgğhıijklmnoöprsştuüvyz" },
+};
+
+static const char *transport_names[] = { "bitbang", "spi_dma", "gpio_dma" };
+
+void bench_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t bench_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+static void put_str(const char *s) {
+    while (*s) {
+        ITM_SendChar(*s++);
+    }
+}
+
+static void put_u32(uint32_t v) {
+    char buf[10];
+    int n = 0;
+    do {
+        buf[n++] = '0' + (v % 10);
+        v /= 10;
+    } while (v);
+    while (n) {
+        ITM_SendChar(buf[--n]);
+    }
+}
+
+// Print one result line, cycles and bytes are totals over count operations
+static void report(const char *bench, transport_t transport, const char *seq,
+                   uint32_t cycles, uint32_t bytes, uint32_t count) {
+    uint32_t per_op = cycles / count;
+    uint32_t fps = per_op ? SystemCoreClock / per_op : 0;
+    uint32_t bit_hz = cycles ? (uint32_t)((uint64_t)bytes * 8 * SystemCoreClock / cycles) : 0;
+
+    put_str(bench);
+    put_str(",");
+    put_str(transport_names[transport]);
+    put_str(",");
+    put_str(seq);
+    put_str(",");
+    put_u32(per_op);
+    put_str(",");
+    put_u32(bytes / count);
+    put_str(",");
+    put_u32(fps);
+    put_str(",");
+    put_u32(bit_hz);
+    put_str("\n");
+}
+
+// Let a DMA frame finish so its bus time is part of the measurement
+static void wait_idle(void) {
+    while (transport_busy());
+}
+
+static void bench_send_byte(void) {
+    transport_reset_stats();
+    uint32_t start = bench_cycles();
+    for (int i = 0; i < BENCH_REPEAT; i++) {
+        send_byte(0xA5);
+    }
+    report("send_byte", TRANSPORT_BITBANG, "-", bench_cycles() - start, BENCH_REPEAT, BENCH_REPEAT);
+}
+
+static void bench_send_cmd(transport_t transport) {
+    transport_reset_stats();
+    uint32_t start = bench_cycles();
+    for (int i = 0; i < BENCH_REPEAT; i++) {
+        send_cmd(REG_NOOP, 0x00);
+    }
+    report("send_cmd", transport, "-", bench_cycles() - start, transport_bytes_sent(), BENCH_REPEAT);
+}
+
+static void bench_init_max7219(transport_t transport) {
+    transport_reset_stats();
+    uint32_t start = bench_cycles();
+    init_max7219(0x0A);
+    report("init_max7219", transport, "-", bench_cycles() - start, transport_bytes_sent(), 1);
+}
+
+// Show every glyph of a sequence once; full = resend all rows each frame
+static void bench_frames(transport_t transport, const bench_sequence_t *seq, uint8_t full) {
+    const char *pos = seq->text;
+    uint32_t codepoint;
+    uint32_t frames = 0;
+    uint32_t cycles = 0;
+
+    fb_clear();
+    fb_invalidate();
+    fb_flush();
+    wait_idle();
+    transport_reset_stats();
+
+    while ((codepoint = utf8_next(&pos)) != 0) {
+        uint32_t start = bench_cycles();
+        const uint8_t *glyph = font_lookup(codepoint);
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            fb_draw_glyph(dev, glyph);
+        }
+        if (full) {
+            fb_invalidate();
+        }
+        fb_flush();
+        wait_idle();
+        cycles += bench_cycles() - start;
+        frames++;
+    }
+
+    report(full ? "frame_full" : "frame_diff", transport, seq->name,
+           cycles, transport_bytes_sent(), frames);
+}
+
+// CPU time of putting each glyph of a sequence on the display as a whole
+// frame, without the wait for the bus: encoded again every time, then
+// through the display-list cache once two passes have stored the frames
+static void bench_cached(transport_t transport, const bench_sequence_t *seq) {
+    for (uint8_t cached = 0; cached <= 1; cached++) {
+        uint32_t cycles = 0;
+        uint32_t frames = 0;
+
+        dlcache_reset();
+        fb_display_cache(cached);
+        for (int pass = cached ? 0 : 2; pass < 3; pass++) {
+            const char *pos = seq->text;
+            uint32_t codepoint;
+
+            transport_reset_stats();
+            while ((codepoint = utf8_next(&pos)) != 0) {
+                const uint8_t *glyph = font_lookup(codepoint);
+                for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                    fb_draw_glyph(dev, glyph);
+                }
+                fb_invalidate();
+                uint32_t start = bench_cycles();
+                fb_flush();
+                if (pass == 2) {
+                    cycles += bench_cycles() - start;
+                    frames++;
+                }
+                wait_idle();
+            }
+        }
+        report(cached ? "cpu_cached" : "cpu_full", transport, seq->name,
+               cycles, transport_bytes_sent(), frames);
+    }
+    fb_display_cache(0);
+}
+
+// Streaming decode of the built-in animation, CPU only (no bus traffic)
+static void bench_anim_decode(transport_t transport) {
+    uint8_t frame[ANIM_FRAME_BYTES] = { 0 };
+    anim_decoder_t dec;
+    anim_frame_info_t info;
+
+    anim_decoder_start(&dec, &anim_demo);
+    uint32_t start = bench_cycles();
+    for (int i = 0; i < BENCH_REPEAT; i++) {
+        anim_decode_next(&dec, frame, &info);
+    }
+    report("anim_decode", transport, "demo", bench_cycles() - start, 0, BENCH_REPEAT);
+}
+
+// Code point lookup and decode of every glyph of a sequence from the
+// compressed atlas of the built-in font, CPU only
+static void bench_atlas(transport_t transport, const bench_sequence_t *seq) {
+    uint8_t rows[8];
+    uint32_t glyphs = 0;
+    uint32_t cycles = 0;
+    const char *pos = seq->text;
+    uint32_t codepoint;
+
+    while ((codepoint = utf8_next(&pos)) != 0) {
+        uint32_t start = bench_cycles();
+        atlas_decode(&atlas_builtin, atlas_index(&atlas_builtin, codepoint), rows);
+        cycles += bench_cycles() - start;
+        glyphs++;
+    }
+    report("atlas_decode", transport, seq->name, cycles, 0, glyphs);
+}
+
+// One pass of the configuration refresh, register steps only: the row
+// resend is a normal full frame, measured by frame_full
+static void bench_watchdog(transport_t transport) {
+    uint32_t cycles = 0;
+
+    transport_reset_stats();
+    for (int i = 0; i < WATCHDOG_STEP_COUNT; i++) {
+        uint32_t start = bench_cycles();
+        watchdog_step_t step = watchdog_refresh_step();
+        uint32_t spent = bench_cycles() - start;
+        if (step != WATCHDOG_STEP_ROWS) {
+            cycles += spent;
+        }
+    }
+    wait_idle();
+    report("wdg_refresh", transport, "-", cycles, transport_bytes_sent(), 1);
+}
+
+// Full 8-latch frame on every bit-sliced chain at once. bytes counts all
+// chains, so bit_hz is the aggregate rate to compare with frame_full.
+static void bench_slice(void) {
+    static uint16_t frames[SLICE_NUM_CHAINS][MAX7219_FRAME_WORDS];
+    const uint16_t *chains[SLICE_NUM_CHAINS];
+
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        for (int row = 0; row < 8; row++) {
+            for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                frames[c][MAX7219_FRAME_INDEX(row, dev)] =
+                    MAX7219_WORD(REG_DIGIT0 + row, (uint8_t)(c * 31 + row * 7 + dev));
+            }
+        }
+        chains[c] = frames[c];
+    }
+
+    slice_init();
+    uint32_t bytes = slice_bytes_sent();
+    uint32_t start = bench_cycles();
+    for (int i = 0; i < BENCH_REPEAT; i++) {
+        slice_send_frame(chains, 8);
+    }
+    report("slice_frame", TRANSPORT_BITBANG, "chains", bench_cycles() - start,
+           slice_bytes_sent() - bytes, BENCH_REPEAT);
+
+    // Leave every chain blank
+    for (int row = 0; row < 8; row++) {
+        slice_send_cmd(REG_DIGIT0 + row, 0x00);
+    }
+}
+
+void bench_run(void) {
+    bench_init();
+    put_str("bench,transport,sequence,cycles,bytes,fps,bit_hz\n");
+
+    for (int t = TRANSPORT_BITBANG; t <= TRANSPORT_GPIO_DMA; t++) {
+        transport_t transport = (transport_t)t;
+        transport_init(transport);
+        fb_init();
+
+        if (transport == TRANSPORT_BITBANG) {
+            bench_send_byte();
+            bench_anim_decode(transport);
+            for (unsigned s = 0; s < sizeof(sequences) / sizeof(sequences[0]); s++) {
+                bench_atlas(transport, &sequences[s]);
+            }
+        }
+        bench_send_cmd(transport);
+        bench_init_max7219(transport);
+        bench_watchdog(transport);
+
+        for (unsigned s = 0; s < sizeof(sequences) / sizeof(sequences[0]); s++) {
+            bench_frames(transport, &sequences[s], 1);
+            bench_frames(transport, &sequences[s], 0);
+            bench_cached(transport, &sequences[s]);
+        }
+    }
+
+    bench_slice();
+
+    // Leave the default transport configured, the caller re-initializes
+    // the MAX7219 with its own settings
+    transport_init(MAX7219_DEFAULT_TRANSPORT);
+    fb_init();
+}
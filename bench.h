@@ -0,0 +1,22 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+// Cycle counter benchmarks of the display update path. Results go out on
+// ITM stimulus port 0 (SWO) as CSV, one line per measurement:
+//   bench,transport,sequence,cycles,bytes,fps,bit_hz
+// cycles and bytes are per operation, fps is operations per second at
+// the current SystemCoreClock and bit_hz the effective bit clock.
+
+// Enable the DWT cycle counter
+void bench_init(void);
+
+// Current CPU cycle count
+uint32_t bench_cycles(void);
+
+// Run every benchmark for every transport and print the results.
+// Leaves the display blank and the default transport selected.
+void bench_run(void);
+
+#endif
@@ -0,0 +1,83 @@
+#include "bitslice.h"
+
+void bitslice_init(bitslice_t *b, const uint8_t *din_pins, uint8_t chains, uint8_t clk_pin) {
+    if (chains > BITSLICE_MAX_CHAINS) chains = BITSLICE_MAX_CHAINS;
+    b->chains = chains;
+    b->clk_pin = clk_pin;
+
+    for (int group = 0; group < 2; group++) {
+        for (int v = 0; v < 256; v++) {
+            uint32_t word = group == 0 ? (1UL << (clk_pin + 16)) : 0;
+            for (int bit = 0; bit < 8; bit++) {
+                int c = group * 8 + bit;
+                if (c >= chains) break;
+                // Set in the low half, reset in the high half
+                word |= (v & (1 << bit)) ? (1UL << din_pins[c]) : (1UL << (din_pins[c] + 16));
+            }
+            b->lut[group][v] = word;
+        }
+    }
+}
+
+// 8x8 bit matrix transpose: byte r bit k moves to byte k bit r
+static uint64_t transpose8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+// Chains of one group of eight, byte k of each, as a matrix with chain
+// c in byte c
+static uint64_t gather(const uint8_t *const *src, uint8_t first, uint8_t count, uint16_t k) {
+    uint64_t x = 0;
+    for (uint8_t c = 0; c < count; c++) {
+        x |= (uint64_t)src[first + c][k] << (8 * c);
+    }
+    return x;
+}
+
+// The 8 words of byte k, MSB first, written every stride words
+static inline void encode_byte(const bitslice_t *b, const uint8_t *const *src, uint16_t k,
+                               uint32_t *out, uint8_t stride) {
+    uint8_t lo = b->chains < 8 ? b->chains : 8;
+    uint8_t hi = b->chains - lo;
+
+    // After the transpose byte i holds bit i of every chain
+    uint64_t t0 = transpose8(gather(src, 0, lo, k));
+    uint64_t t1 = hi ? transpose8(gather(src, 8, hi, k)) : 0;
+
+    for (int i = 7; i >= 0; i--) {
+        *out = b->lut[0][(uint8_t)(t0 >> (8 * i))] |
+               b->lut[1][(uint8_t)(t1 >> (8 * i))];
+        out += stride;
+    }
+}
+
+void bitslice_encode(const bitslice_t *b, const uint8_t *const *src, uint16_t len, uint32_t *out) {
+    for (uint16_t k = 0; k < len; k++) {
+        encode_byte(b, src, k, &out[8 * k], 1);
+    }
+}
+
+uint16_t bitslice_encode_latch(const bitslice_t *b, const uint8_t *const *src, uint16_t len,
+                               uint8_t cs_pin, uint32_t *out) {
+    uint32_t clk_high = 1UL << b->clk_pin;
+    uint16_t n = 0;
+
+    out[n++] = (1UL << (cs_pin + 16)) | (1UL << (b->clk_pin + 16));
+    for (uint16_t k = 0; k < len; k++) {
+        encode_byte(b, src, k, &out[n], 2);
+        for (int i = 0; i < 8; i++) {
+            out[n + 2 * i + 1] = clk_high;
+        }
+        n += 16;
+    }
+    // CLK back low with CS, the data stays valid through the latch
+    out[n++] = (1UL << cs_pin) | (1UL << (b->clk_pin + 16));
+    return n;
+}
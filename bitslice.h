@@ -0,0 +1,38 @@
+#ifndef BITSLICE_H
+#define BITSLICE_H
+
+#include <stdint.h>
+
+// Bit-slicing kernel for several MAX7219 chains that share CLK and CS on
+// one GPIO port but each have their own DIN pin. Every bit time is a
+// single BSRR word that sets or resets the DIN of every chain at once
+// and pulls CLK low; the caller raises CLK after each word.
+// tests/test_bitslice.c checks the words and bench_bitslice.c times them.
+#define BITSLICE_MAX_CHAINS 16
+
+typedef struct {
+    // BSRR bits for the DIN levels of chains 0-7 and 8-15, indexed by
+    // one bit per chain (bit c = chain c of the group)
+    uint32_t lut[2][256];
+    uint8_t chains;
+    uint8_t clk_pin;
+} bitslice_t;
+
+// Map chain c to port pin din_pins[c]; CLK low is folded into every word
+void bitslice_init(bitslice_t *b, const uint8_t *din_pins, uint8_t chains, uint8_t clk_pin);
+
+// Encode len bytes of every chain, src[c][0 .. len - 1], MSB first into
+// 8 * len BSRR words
+void bitslice_encode(const bitslice_t *b, const uint8_t *const *src, uint16_t len, uint32_t *out);
+
+// Words of a complete latch as written by bitslice_encode_latch()
+#define BITSLICE_LATCH_WORDS(len) (2 + 16 * (len))
+
+// Complete latch for a timed writer such as a DMA: CS low, then a data
+// word (CLK low) and a CLK high word per bit, then CS high. Every word
+// lasts one time slot, so CLK runs at half the slot rate. Returns the
+// number of words, BITSLICE_LATCH_WORDS(len).
+uint16_t bitslice_encode_latch(const bitslice_t *b, const uint8_t *const *src, uint16_t len,
+                               uint8_t cs_pin, uint32_t *out);
+
+#endif
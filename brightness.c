@@ -0,0 +1,88 @@
+#include "stm32f4xx.h"
+#include "brightness.h"
+#include "max7219.h"
+#include "framebuffer.h"
+
+brightness_t ambient_brightness;
+
+void brightness_init(brightness_t *b, uint8_t min_level, uint8_t max_level) {
+    b->filtered = 0;
+    b->min_level = min_level & 0x0F;
+    b->max_level = max_level & 0x0F;
+    if (b->max_level < b->min_level) {
+        b->max_level = b->min_level;
+    }
+    b->level = b->max_level;
+    b->primed = 0;
+}
+
+uint16_t brightness_filtered(const brightness_t *b) {
+    return (uint16_t)(b->filtered >> 16);
+}
+
+// ADC reading at the lower edge of a level's step
+static uint32_t step_start(const brightness_t *b, uint8_t level) {
+    uint32_t steps = b->max_level - b->min_level + 1;
+    return (uint32_t)(level - b->min_level) * (BRIGHTNESS_ADC_MAX + 1) / steps;
+}
+
+uint8_t brightness_update(brightness_t *b, uint16_t sample) {
+    uint32_t s = (uint32_t)sample << 16;
+
+    if (!b->primed) {
+        b->filtered = s;
+        b->primed = 1;
+    } else if (s >= b->filtered) {
+        b->filtered += (s - b->filtered) >> BRIGHTNESS_FILTER_SHIFT;
+    } else {
+        b->filtered -= (b->filtered - s) >> BRIGHTNESS_FILTER_SHIFT;
+    }
+
+    uint32_t light = brightness_filtered(b);
+
+    // Step up or down only when clearly inside the neighbouring step
+    if (b->level < b->max_level &&
+        light >= step_start(b, b->level + 1) + BRIGHTNESS_HYSTERESIS) {
+        b->level++;
+    } else if (b->level > b->min_level &&
+               light + BRIGHTNESS_HYSTERESIS < step_start(b, b->level)) {
+        b->level--;
+    }
+    return b->level;
+}
+
+void light_sensor_init(void) {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+    RCC->APB2ENR |= RCC_APB2ENR_ADC1EN;
+
+    // PA3 as analog input
+    GPIOA->MODER |= (3U << (LIGHT_SENSOR_PIN * 2));
+
+    // ADC clock PCLK2 / 4, 12-bit, one conversion of the sensor channel
+    ADC->CCR = (ADC->CCR & ~ADC_CCR_ADCPRE) | ADC_CCR_ADCPRE_0;
+    ADC1->CR1 = 0;
+    ADC1->CR2 = 0;
+    ADC1->SQR1 = 0;
+    ADC1->SQR3 = LIGHT_SENSOR_CHANNEL;
+
+    // 84 cycles sampling time for the high impedance divider
+    ADC1->SMPR2 = (ADC1->SMPR2 & ~(7U << (LIGHT_SENSOR_CHANNEL * 3))) |
+                  (4U << (LIGHT_SENSOR_CHANNEL * 3));
+    ADC1->CR2 = ADC_CR2_ADON;
+}
+
+uint16_t light_sensor_read(void) {
+    ADC1->CR2 |= ADC_CR2_SWSTART;
+    while (!(ADC1->SR & ADC_SR_EOC));
+    return (uint16_t)ADC1->DR;
+}
+
+void brightness_task(void) {
+    uint8_t level = brightness_update(&ambient_brightness, light_sensor_read());
+    if (level != max7219_get_intensity()) {
+        // Not while a vsync flip has the bus
+        fb_vsync_hold();
+        max7219_set_intensity(level);
+        fb_vsync_release();
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef BRIGHTNESS_H
+#define BRIGHTNESS_H
+
+#include <stdint.h>
+
+// Ambient light sensor on PA3 (ADC1_IN3), brighter light = higher reading
+#define LIGHT_SENSOR_PIN     3
+#define LIGHT_SENSOR_CHANNEL 3
+
+// Filter and control loop tuning
+#define BRIGHTNESS_FILTER_SHIFT 3    // EMA weight of a new sample: 1/8
+#define BRIGHTNESS_HYSTERESIS   64   // ADC counts past a step boundary
+#define BRIGHTNESS_ADC_MAX      4095
+
+// Control loop state, independent of the hardware so recorded sensor
+// traces can be replayed through brightness_update()
+typedef struct {
+    uint32_t filtered;      // EMA of the samples, 16.16 fixed point
+    uint8_t min_level;      // Intensity in the dark
+    uint8_t max_level;      // Intensity in full light
+    uint8_t level;          // Intensity currently applied
+    uint8_t primed;         // First sample seeds the filter
+} brightness_t;
+
+// Reset the loop, level starts at max_level until the first sample
+void brightness_init(brightness_t *b, uint8_t min_level, uint8_t max_level);
+
+// Feed one raw ADC sample, returns the intensity to apply. The level
+// only moves once the filtered reading is BRIGHTNESS_HYSTERESIS counts
+// into the neighbouring step, and then by one step per call.
+uint8_t brightness_update(brightness_t *b, uint16_t sample);
+
+// Filtered reading in ADC counts
+uint16_t brightness_filtered(const brightness_t *b);
+
+// Configure ADC1 for single conversions of the light sensor
+void light_sensor_init(void);
+
+// One blocking conversion (a few microseconds)
+uint16_t light_sensor_read(void);
+
+// Scheduler task: sample, filter and update REG_INTENSITY when it changed
+void brightness_task(void);
+
+// Loop used by brightness_task()
+extern brightness_t ambient_brightness;
+
+#endif
@@ -0,0 +1,177 @@
+#include "canvas.h"
+#include "font.h"
+
+void canvas_init(canvas_t *c, uint8_t *buf, uint16_t width, uint16_t height) {
+    c->buf = buf;
+    c->width = width;
+    c->height = height;
+    c->stride = (width + 7) / 8;
+    canvas_clear(c);
+}
+
+void canvas_clear(canvas_t *c) {
+    for (uint32_t i = 0; i < (uint32_t)c->stride * c->height; i++) {
+        c->buf[i] = 0x00;
+    }
+}
+
+void canvas_pixel(canvas_t *c, int16_t x, int16_t y, uint8_t on) {
+    if (x < 0 || y < 0 || x >= c->width || y >= c->height) return;
+
+    uint8_t *b = &c->buf[y * c->stride + x / 8];
+    uint8_t mask = 0x80 >> (x % 8);
+    *b = on ? (*b | mask) : (*b & ~mask);
+}
+
+uint8_t canvas_get(const canvas_t *c, int16_t x, int16_t y) {
+    if (x < 0 || y < 0 || x >= c->width || y >= c->height) return 0;
+    return (c->buf[y * c->stride + x / 8] >> (7 - x % 8)) & 1;
+}
+
+// Bresenham, all octants
+void canvas_line(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t on) {
+    int16_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int16_t dy = y1 > y0 ? y0 - y1 : y1 - y0;
+    int16_t sx = x0 < x1 ? 1 : -1;
+    int16_t sy = y0 < y1 ? 1 : -1;
+    int16_t err = dx + dy;
+
+    while (1) {
+        canvas_pixel(c, x0, y0, on);
+        if (x0 == x1 && y0 == y1) break;
+        int16_t e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void canvas_rect(canvas_t *c, int16_t x, int16_t y, uint16_t w, uint16_t h,
+                 uint8_t on, uint8_t fill) {
+    if (w == 0 || h == 0) return;
+
+    if (fill) {
+        for (int16_t row = y; row < y + h; row++) {
+            for (int16_t col = x; col < x + w; col++) {
+                canvas_pixel(c, col, row, on);
+            }
+        }
+        return;
+    }
+    canvas_line(c, x, y, x + w - 1, y, on);
+    canvas_line(c, x, y + h - 1, x + w - 1, y + h - 1, on);
+    canvas_line(c, x, y, x, y + h - 1, on);
+    canvas_line(c, x + w - 1, y, x + w - 1, y + h - 1, on);
+}
+
+void canvas_glyph(canvas_t *c, int16_t x, int16_t y, uint8_t index) {
+    if (index >= FONT_GLYPH_COUNT) index = FONT_GLYPH_MISSING;
+
+    for (int row = 0; row < 8; row++) {
+        uint8_t bits = font_glyphs[index][row];
+        for (int col = 0; col < 8; col++) {
+            if (bits & (0x80 >> col)) {
+                canvas_pixel(c, x + col, y + row, 1);
+            }
+        }
+    }
+}
+
+uint16_t canvas_text(canvas_t *c, int16_t x, int16_t y, const char *text) {
+    uint32_t codepoint;
+    int16_t start = x;
+
+    while ((codepoint = utf8_next(&text)) != 0) {
+        uint8_t index = font_index(codepoint);
+        uint8_t width = font_width(index);
+        if (width == 0) {
+            x += FONT_BLANK_WIDTH;
+            continue;
+        }
+        // Shift the glyph so its first lit column lands on x
+        canvas_glyph(c, x - font_left(index), y, index);
+        x += width + 1;
+    }
+    return (uint16_t)(x - start);
+}
+
+void layout_grid(layout_t *l, uint8_t cols, uint8_t rows, uint8_t serpentine, uint8_t orient) {
+    l->cols = cols;
+    l->rows = rows;
+
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        uint8_t row = dev / cols;
+        uint8_t col = dev % cols;
+        if (serpentine && (row & 1)) {
+            col = cols - 1 - col;
+        }
+        l->modules[dev].col = col;
+        l->modules[dev].row = row;
+        l->modules[dev].orient = orient;
+    }
+}
+
+// 8 canvas pixels from (x, y) to the right, bit 7 first
+static uint8_t canvas_byte(const canvas_t *c, int16_t x, int16_t y) {
+    if (y < 0 || y >= c->height || x <= -8 || x >= c->width) return 0x00;
+
+    const uint8_t *line = &c->buf[y * c->stride];
+    int16_t bx = x >= 0 ? x / 8 : -1;
+    uint8_t shift = (uint8_t)(x - bx * 8);
+    uint16_t pair = (uint16_t)(((bx >= 0 ? line[bx] : 0) << 8) |
+                               (bx + 1 < c->stride ? line[bx + 1] : 0));
+    uint8_t bits = (uint8_t)((pair << shift) >> 8);
+
+    // Mask off the padding bits past the right edge
+    if (x + 8 > c->width) {
+        bits &= (uint8_t)(0xFF << (x + 8 - c->width));
+    }
+    return bits;
+}
+
+static uint8_t reverse_bits(uint8_t b) {
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+    return b;
+}
+
+void viewport_render(const canvas_t *c, const layout_t *l, int16_t x, int16_t y,
+                     uint8_t rows[][8]) {
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        const module_place_t *m = &l->modules[dev];
+        int16_t ox = x + m->col * 8;
+        int16_t oy = y + m->row * 8;
+        uint8_t rot = m->orient & MODULE_ROT_MASK;
+
+        // Upright and upside down modules read whole canvas bytes
+        if (rot == MODULE_ROT_0 || rot == MODULE_ROT_180) {
+            uint8_t flip_x = (rot == MODULE_ROT_180) ^ !!(m->orient & MODULE_FLIP_X);
+            uint8_t flip_y = (rot == MODULE_ROT_180) ^ !!(m->orient & MODULE_FLIP_Y);
+            for (int r = 0; r < 8; r++) {
+                uint8_t bits = canvas_byte(c, ox, oy + (flip_y ? 7 - r : r));
+                rows[dev][r] = flip_x ? reverse_bits(bits) : bits;
+            }
+            continue;
+        }
+
+        // Sideways modules: device pixel (dx, dy) shows cell pixel
+        // (7 - dy, dx) at 90 degrees and (dy, 7 - dx) at 270
+        for (int dy = 0; dy < 8; dy++) {
+            uint8_t bits = 0;
+            for (int dx = 0; dx < 8; dx++) {
+                int mx = (m->orient & MODULE_FLIP_X) ? 7 - dx : dx;
+                int my = (m->orient & MODULE_FLIP_Y) ? 7 - dy : dy;
+                int cx = rot == MODULE_ROT_90 ? 7 - my : my;
+                int cy = rot == MODULE_ROT_90 ? mx : 7 - mx;
+                bits |= (uint8_t)(canvas_get(c, ox + cx, oy + cy) << (7 - dx));
+            }
+            rows[dev][dy] = bits;
+        }
+    }
+}
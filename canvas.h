@@ -0,0 +1,69 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <stdint.h>
+#include "max7219.h"
+
+// 1 bit per pixel drawing surface larger than the display, and a
+// viewport that maps part of it onto a 2D grid of modules. Row-major,
+// bit 7 of a byte is the leftmost of its 8 pixels. No hardware
+// dependencies: rendering produces digit register rows per device.
+typedef struct {
+    uint8_t *buf;           // stride * height bytes
+    uint16_t width;
+    uint16_t height;
+    uint16_t stride;        // Bytes per canvas row
+} canvas_t;
+
+// How a module is mounted, relative to reading its rows left to right,
+// top to bottom. Rotations are clockwise and applied after the flips.
+#define MODULE_ROT_0   0x00
+#define MODULE_ROT_90  0x01
+#define MODULE_ROT_180 0x02
+#define MODULE_ROT_270 0x03
+#define MODULE_ROT_MASK 0x03
+#define MODULE_FLIP_X  0x04     // Columns mirrored
+#define MODULE_FLIP_Y  0x08     // Rows mirrored
+
+// Grid cell and orientation of one device of the chain
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+    uint8_t orient;
+} module_place_t;
+
+// Module grid, modules[dev] for every device of the chain
+typedef struct {
+    uint8_t cols;
+    uint8_t rows;
+    module_place_t modules[MAX7219_NUM_DEVICES];
+} layout_t;
+
+// Attach a zeroed buffer of ((width + 7) / 8) * height bytes
+void canvas_init(canvas_t *c, uint8_t *buf, uint16_t width, uint16_t height);
+void canvas_clear(canvas_t *c);
+
+// Drawing primitives, clipped to the canvas. on = 0 clears.
+void canvas_pixel(canvas_t *c, int16_t x, int16_t y, uint8_t on);
+uint8_t canvas_get(const canvas_t *c, int16_t x, int16_t y);
+void canvas_line(canvas_t *c, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t on);
+void canvas_rect(canvas_t *c, int16_t x, int16_t y, uint16_t w, uint16_t h,
+                 uint8_t on, uint8_t fill);
+
+// Draw a glyph of the font with its top left corner at (x, y), lit
+// pixels only. canvas_text() draws UTF-8 proportionally and returns the
+// width drawn.
+void canvas_glyph(canvas_t *c, int16_t x, int16_t y, uint8_t index);
+uint16_t canvas_text(canvas_t *c, int16_t x, int16_t y, const char *text);
+
+// Chain laid out row by row from the top left. With serpentine, every
+// other grid row runs right to left (chain folded back at the end of a
+// row). All modules get orient.
+void layout_grid(layout_t *l, uint8_t cols, uint8_t rows, uint8_t serpentine, uint8_t orient);
+
+// Render the canvas region at (x, y) onto the chain, rows[dev][row] in
+// fb_set_row() order. Pixels outside the canvas are dark.
+void viewport_render(const canvas_t *c, const layout_t *l, int16_t x, int16_t y,
+                     uint8_t rows[][8]);
+
+#endif
@@ -0,0 +1,152 @@
+#include "stm32f4xx.h"
+#include "clock.h"
+#include "sched.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "gray.h"
+#include "uart.h"
+#include "spiflash.h"
+
+// The full-speed divider set, rejected at compile time if it breaks a limit
+_Static_assert(CLOCK_SYSCLK_HZ <= CLOCK_SYSCLK_MAX_HZ, "SYSCLK above the F401 maximum");
+_Static_assert(CLOCK_VCO_FOR(CLOCK_SYSCLK_HZ) >= CLOCK_VCO_MIN_HZ &&
+               CLOCK_VCO_FOR(CLOCK_SYSCLK_HZ) <= CLOCK_VCO_MAX_HZ, "VCO out of range");
+_Static_assert(CLOCK_VCO_FOR(CLOCK_SYSCLK_HZ) % CLOCK_VCO_IN_HZ == 0, "SYSCLK not reachable with a 1 MHz VCO input");
+_Static_assert(CLOCK_PLLN_FOR(CLOCK_SYSCLK_HZ) >= 192 && CLOCK_PLLN_FOR(CLOCK_SYSCLK_HZ) <= 432, "PLLN out of range");
+_Static_assert(CLOCK_PLLQ_FOR(CLOCK_SYSCLK_HZ) >= 2 && CLOCK_PLLQ_FOR(CLOCK_SYSCLK_HZ) <= 15, "PLLQ out of range");
+_Static_assert(CLOCK_LATENCY_FOR(CLOCK_SYSCLK_HZ) <= 2, "Too many flash wait states for the F401");
+
+const clock_pll_t clock_full_pll = {
+    .pllm = CLOCK_PLLM,
+    .plln = CLOCK_PLLN_FOR(CLOCK_SYSCLK_HZ),
+    .pllp = CLOCK_PLLP_FOR(CLOCK_SYSCLK_HZ),
+    .pllq = CLOCK_PLLQ_FOR(CLOCK_SYSCLK_HZ),
+    .latency = CLOCK_LATENCY_FOR(CLOCK_SYSCLK_HZ),
+    .apb1_div = CLOCK_PPRE1_DIV_FOR(CLOCK_SYSCLK_HZ),
+    .apb2_div = 1,
+};
+
+static clock_profile_t current_profile = CLOCK_LOW_POWER;
+
+uint8_t clock_pll_compute(uint32_t hz, clock_pll_t *pll) {
+    pll->pllm = CLOCK_PLLM;
+    pll->pllp = CLOCK_PLLP_FOR(hz);
+    pll->plln = CLOCK_PLLN_FOR(hz);
+    pll->pllq = CLOCK_PLLQ_FOR(hz);
+    pll->latency = CLOCK_LATENCY_FOR(hz);
+    pll->apb1_div = CLOCK_PPRE1_DIV_FOR(hz);
+    pll->apb2_div = 1;
+    return clock_pll_valid(pll) && clock_pll_sysclk(pll) == hz;
+}
+
+uint32_t clock_pll_sysclk(const clock_pll_t *pll) {
+    if (pll->pllm == 0 || pll->pllp == 0) return 0;
+    return CLOCK_HSI_HZ / pll->pllm * pll->plln / pll->pllp;
+}
+
+uint8_t clock_pll_valid(const clock_pll_t *pll) {
+    if (pll->pllm < 2 || pll->pllm > 63) return 0;
+    if (pll->plln < 192 || pll->plln > 432) return 0;
+    if (pll->pllp != 2 && pll->pllp != 4 && pll->pllp != 6 && pll->pllp != 8) return 0;
+    if (pll->pllq < 2 || pll->pllq > 15) return 0;
+
+    uint32_t vco_in = CLOCK_HSI_HZ / pll->pllm;
+    uint32_t vco = vco_in * pll->plln;
+    uint32_t sysclk = vco / pll->pllp;
+    if (vco_in < CLOCK_VCO_IN_MIN_HZ || vco_in > CLOCK_VCO_IN_MAX_HZ) return 0;
+    if (vco < CLOCK_VCO_MIN_HZ || vco > CLOCK_VCO_MAX_HZ) return 0;
+    if (vco / pll->pllq > CLOCK_USB_MAX_HZ) return 0;
+    if (sysclk > CLOCK_SYSCLK_MAX_HZ) return 0;
+    if (pll->latency < CLOCK_LATENCY_FOR(sysclk) || pll->latency > 7) return 0;
+    if (sysclk / pll->apb1_div > CLOCK_APB1_MAX_HZ) return 0;
+    if (sysclk / pll->apb2_div > CLOCK_APB2_MAX_HZ) return 0;
+    return 1;
+}
+
+// PPRE field value for a divider of 1, 2, 4, 8 or 16
+static uint32_t ppre_bits(uint32_t div) {
+    switch (div) {
+    case 2:  return 4;
+    case 4:  return 5;
+    case 8:  return 6;
+    case 16: return 7;
+    default: return 0;
+    }
+}
+
+static uint32_t ppre_div(uint32_t bits) {
+    return (bits & 4) ? 2U << (bits & 3) : 1;
+}
+
+// Run from HSI with the PLL off
+static void use_hsi(void) {
+    RCC->CR |= RCC_CR_HSION;
+    while (!(RCC->CR & RCC_CR_HSIRDY));
+
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_HSI;
+    while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI);
+
+    RCC->CR &= ~RCC_CR_PLLON;
+    while (RCC->CR & RCC_CR_PLLRDY);
+}
+
+static void set_flash_latency(uint32_t latency) {
+    FLASH->ACR = (latency << FLASH_ACR_LATENCY_Pos) | FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN;
+    while ((FLASH->ACR & FLASH_ACR_LATENCY) != (latency << FLASH_ACR_LATENCY_Pos));
+}
+
+void clock_set_profile(clock_profile_t profile) {
+    const clock_pll_t *pll = &clock_full_pll;
+
+    use_hsi();
+
+    if (profile == CLOCK_FULL) {
+        // Configure PLL (HSI / PLLM * PLLN / PLLP)
+        RCC->PLLCFGR = (pll->pllm << RCC_PLLCFGR_PLLM_Pos) |
+                       (pll->plln << RCC_PLLCFGR_PLLN_Pos) |
+                       ((pll->pllp / 2 - 1) << RCC_PLLCFGR_PLLP_Pos) |
+                       (pll->pllq << RCC_PLLCFGR_PLLQ_Pos) |
+                       RCC_PLLCFGR_PLLSRC_HSI;
+        RCC->CR |= RCC_CR_PLLON;
+        while (!(RCC->CR & RCC_CR_PLLRDY));
+
+        // Wait states and bus dividers before the clock goes up
+        set_flash_latency(pll->latency);
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) |
+                    (ppre_bits(pll->apb1_div) << RCC_CFGR_PPRE1_Pos) |
+                    (ppre_bits(pll->apb2_div) << RCC_CFGR_PPRE2_Pos);
+
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+        while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL);
+    } else {
+        // 16 MHz fits every bus and needs no wait state
+        RCC->CFGR &= ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2);
+        set_flash_latency(CLOCK_LATENCY_FOR(CLOCK_HSI_HZ));
+    }
+    current_profile = profile;
+
+    // Update SystemCoreClock variable and everything timed from it
+    SystemCoreClockUpdate();
+    sched_recalibrate();
+    transport_recalibrate();
+    fb_vsync_recalibrate();
+    gray_recalibrate();
+    uart_recalibrate();
+    spiflash_recalibrate();
+}
+
+clock_profile_t clock_get_profile(void) {
+    return current_profile;
+}
+
+void clock_restore(void) {
+    clock_set_profile(current_profile);
+}
+
+uint32_t clock_pclk1_hz(void) {
+    return SystemCoreClock / ppre_div((RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos);
+}
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock / ppre_div((RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos);
+}
@@ -0,0 +1,81 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+// Clock tree limits of the STM32F401 (RM0368), HSI as PLL source
+#define CLOCK_HSI_HZ        16000000UL
+#define CLOCK_SYSCLK_MAX_HZ 84000000UL
+#define CLOCK_APB1_MAX_HZ   42000000UL
+#define CLOCK_APB2_MAX_HZ   84000000UL
+#define CLOCK_VCO_IN_MIN_HZ 1000000UL
+#define CLOCK_VCO_IN_MAX_HZ 2000000UL
+#define CLOCK_VCO_MIN_HZ    192000000UL
+#define CLOCK_VCO_MAX_HZ    432000000UL
+#define CLOCK_USB_MAX_HZ    48000000UL
+#define CLOCK_HZ_PER_WS     30000000UL  // Flash wait state step at 2.7-3.6 V
+
+// Requested full-speed SYSCLK
+#ifndef CLOCK_SYSCLK_HZ
+#define CLOCK_SYSCLK_HZ 84000000UL
+#endif
+
+// PLL divider set for a SYSCLK, computed by the preprocessor.
+// VCO input is fixed at 1 MHz so every whole MHz has an integer PLLN
+// (84 MHz needs a 336 MHz VCO, 168 times a 2 MHz input is below the
+// PLLN minimum). PLLP is the smallest divider that lifts the VCO into
+// range and PLLQ keeps the 48 MHz domain at or below 48 MHz.
+#define CLOCK_PLLM (CLOCK_HSI_HZ / CLOCK_VCO_IN_MIN_HZ)
+#define CLOCK_VCO_IN_HZ (CLOCK_HSI_HZ / CLOCK_PLLM)
+#define CLOCK_PLLP_FOR(hz) \
+    ((hz) * 2 >= CLOCK_VCO_MIN_HZ ? 2 : (hz) * 4 >= CLOCK_VCO_MIN_HZ ? 4 : \
+     (hz) * 6 >= CLOCK_VCO_MIN_HZ ? 6 : 8)
+#define CLOCK_VCO_FOR(hz)     ((hz) * CLOCK_PLLP_FOR(hz))
+#define CLOCK_PLLN_FOR(hz)    (CLOCK_VCO_FOR(hz) / CLOCK_VCO_IN_HZ)
+#define CLOCK_PLLQ_FOR(hz)    ((CLOCK_VCO_FOR(hz) + CLOCK_USB_MAX_HZ - 1) / CLOCK_USB_MAX_HZ)
+#define CLOCK_LATENCY_FOR(hz) (((hz) - 1) / CLOCK_HZ_PER_WS)
+#define CLOCK_PPRE1_DIV_FOR(hz) ((hz) > CLOCK_APB1_MAX_HZ ? 2 : 1)
+
+// A divider set and the clocks it produces
+typedef struct {
+    uint32_t pllm;
+    uint32_t plln;
+    uint32_t pllp;
+    uint32_t pllq;
+    uint32_t latency;   // Flash wait states
+    uint32_t apb1_div;
+    uint32_t apb2_div;
+} clock_pll_t;
+
+typedef enum {
+    CLOCK_LOW_POWER,    // HSI 16 MHz straight, PLL off, 0 wait states
+    CLOCK_FULL          // PLL at CLOCK_SYSCLK_HZ
+} clock_profile_t;
+
+// Divider set of CLOCK_SYSCLK_HZ, checked at compile time in clock.c
+extern const clock_pll_t clock_full_pll;
+
+// Divider set for any SYSCLK, same rules as the macros.
+// Returns 0 if hz cannot be reached exactly within the limits.
+uint8_t clock_pll_compute(uint32_t hz, clock_pll_t *pll);
+
+// Check a divider set against every F4 constraint, returns 1 if valid
+uint8_t clock_pll_valid(const clock_pll_t *pll);
+
+// SYSCLK a divider set produces
+uint32_t clock_pll_sysclk(const clock_pll_t *pll);
+
+// Switch profile and retune everything derived from the clock: SysTick,
+// the SPI prescaler, the UART baud rate and the display timers
+void clock_set_profile(clock_profile_t profile);
+clock_profile_t clock_get_profile(void);
+
+// Re-apply the current profile, for the resume after STOP (which wakes
+// on HSI with the PLL off)
+void clock_restore(void);
+
+// Bus clocks of the current configuration
+uint32_t clock_pclk1_hz(void);
+uint32_t clock_pclk2_hz(void);
+
+#endif
@@ -0,0 +1,159 @@
+#include "dlcache.h"
+
+typedef struct {
+    uint32_t hash;
+    uint32_t last_used;     // Show count at the last use, 0 = free
+    uint8_t rows[8][MAX7219_NUM_DEVICES];
+} dlcache_entry_t;
+
+// Entry i owns pool[i * slot_words] onwards
+static uint32_t pool[DLCACHE_BUDGET_BYTES / sizeof(uint32_t)];
+static dlcache_entry_t entries[DLCACHE_MAX_ENTRIES];
+static uint32_t slot_words;
+static uint8_t capacity;
+static transport_t sized_for;
+static uint8_t ready;
+
+// Hashes of the latest misses that were not stored
+static uint32_t missed[DLCACHE_MAX_ENTRIES];
+static uint8_t missed_pos;
+
+static uint32_t shows;
+static int8_t on_wire = -1;     // Entry the DMA may still be reading
+static dlcache_stats_t stats;
+
+// FNV-1a over every row byte
+static uint32_t rows_hash(const uint8_t rows[8][MAX7219_NUM_DEVICES]) {
+    uint32_t h = 2166136261u;
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            h = (h ^ rows[row][dev]) * 16777619u;
+        }
+    }
+    return h;
+}
+
+static uint8_t rows_equal(const uint8_t a[8][MAX7219_NUM_DEVICES],
+                          const uint8_t b[8][MAX7219_NUM_DEVICES]) {
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            if (a[row][dev] != b[row][dev]) return 0;
+        }
+    }
+    return 1;
+}
+
+void dlcache_reset(void) {
+    // The DMA may still read an entry of the old layout
+    while (transport_busy());
+
+    uint32_t slot_bytes = transport_encoded_bytes(8);
+    uint32_t fit = DLCACHE_BUDGET_BYTES / slot_bytes;
+
+    capacity = fit < DLCACHE_MAX_ENTRIES ? (uint8_t)fit : DLCACHE_MAX_ENTRIES;
+    slot_words = slot_bytes / sizeof(uint32_t);
+    sized_for = transport_get();
+
+    // Bit-bang shifts a stored frame bit by bit on the CPU like any other,
+    // so there is nothing to save
+    if (sized_for == TRANSPORT_BITBANG) {
+        capacity = 0;
+    }
+    for (int i = 0; i < DLCACHE_MAX_ENTRIES; i++) {
+        entries[i].last_used = 0;
+        missed[i] = 0;
+    }
+    missed_pos = 0;
+    shows = 0;
+    on_wire = -1;
+    ready = 1;
+}
+
+static void kick(uint8_t i) {
+    entries[i].last_used = shows;
+    on_wire = (int8_t)i;
+    send_encoded_ref(&pool[i * slot_words], 8);
+}
+
+// Free entry, else the least recently shown one
+static uint8_t victim(void) {
+    uint8_t v = 0;
+    for (uint8_t i = 0; i < capacity; i++) {
+        if (entries[i].last_used == 0) return i;
+        if (entries[i].last_used < entries[v].last_used) v = i;
+    }
+    stats.evictions++;
+    return v;
+}
+
+uint8_t dlcache_show(const uint8_t rows[8][MAX7219_NUM_DEVICES]) {
+    if (!ready || sized_for != transport_get()) {
+        dlcache_reset();
+    }
+    if (capacity == 0) {
+        return 0;
+    }
+
+    uint32_t hash = rows_hash(rows);
+    shows++;
+
+    for (uint8_t i = 0; i < capacity; i++) {
+        if (entries[i].last_used && entries[i].hash == hash && rows_equal(entries[i].rows, rows)) {
+            stats.hits++;
+            kick(i);
+            return 1;
+        }
+    }
+    stats.misses++;
+
+    // First miss: remember it and let the caller send the frame
+    uint8_t seen = 0;
+    for (int k = 0; k < DLCACHE_MAX_ENTRIES; k++) {
+        if (missed[k] == hash) {
+            missed[k] = 0;
+            seen = 1;
+            break;
+        }
+    }
+    if (!seen) {
+        missed[missed_pos] = hash;
+        missed_pos = (uint8_t)((missed_pos + 1) % DLCACHE_MAX_ENTRIES);
+        return 0;
+    }
+
+    uint8_t v = victim();
+    if (v == on_wire) {
+        while (transport_busy());
+    }
+
+    uint16_t frame[MAX7219_FRAME_WORDS];
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            frame[MAX7219_FRAME_INDEX(row, dev)] = MAX7219_WORD(REG_DIGIT0 + row, rows[row][dev]);
+            entries[v].rows[row][dev] = rows[row][dev];
+        }
+    }
+    transport_encode(frame, 8, &pool[v * slot_words]);
+    entries[v].hash = hash;
+    stats.stores++;
+    kick(v);
+    return 1;
+}
+
+uint8_t dlcache_capacity(void) {
+    if (!ready || sized_for != transport_get()) {
+        dlcache_reset();
+    }
+    return capacity;
+}
+
+void dlcache_get_stats(dlcache_stats_t *out) {
+    *out = stats;
+}
+
+void dlcache_reset_stats(void) {
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.stores = 0;
+    stats.evictions = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef DLCACHE_H
+#define DLCACHE_H
+
+#include <stdint.h>
+#include "max7219.h"
+
+// Display-list cache: complete frames (all eight digit rows of every
+// device) kept in the wire form of the active transport, so showing one
+// again is a single DMA kick with no per-bit encoding. Frames are found
+// by an FNV-1a hash of their rows and confirmed against a copy of them.
+// A frame is only stored the second time it misses within the last
+// DLCACHE_MAX_ENTRIES misses, so one-off frames such as scroll steps do
+// not push out the ones that come back.
+
+// The cache holds nothing on the bit-bang transport, where a stored frame
+// costs the CPU as much as a fresh one, and the framebuffer only uses it
+// when all eight rows changed.
+
+// RAM for encoded streams. An entry takes transport_encoded_bytes(8):
+// 16 bytes per device on SPI, 64 + 1024 per device on GPIO DMA (eight
+// BITSLICE_LATCH_WORDS of 32 bits). The default budget holds seven GPIO
+// DMA entries for one device, one for up to seven and none for more.
+#ifndef DLCACHE_BUDGET_BYTES
+#define DLCACHE_BUDGET_BYTES 8192
+#endif
+
+// Most entries regardless of the budget (table and miss history size)
+#ifndef DLCACHE_MAX_ENTRIES
+#define DLCACHE_MAX_ENTRIES 32
+#endif
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t stores;
+    uint32_t evictions;
+} dlcache_stats_t;
+
+// Drop every entry and size the pool for the active transport. Switching
+// transports does the same on the next lookup.
+void dlcache_reset(void);
+
+// Send rows from the cache, storing them first when they have missed
+// recently. Returns 1 when the frame went out, 0 when the caller has to
+// send it itself. rows is in fb_set_row() order, rows[row][dev].
+uint8_t dlcache_show(const uint8_t rows[8][MAX7219_NUM_DEVICES]);
+
+// Entries the budget allows on the active transport
+uint8_t dlcache_capacity(void);
+
+void dlcache_get_stats(dlcache_stats_t *out);
+void dlcache_reset_stats(void);
+
+#endif
@@ -0,0 +1,114 @@
+#include "font.h"
+
+#define FONT_ROWS(r0, r1, r2, r3, r4, r5, r6, r7) { r0, r1, r2, r3, r4, r5, r6, r7 }
+
+// Column c (0 = leftmost) of a glyph given as rows, bit 0 is row 0
+#define FONT_COLUMN(c, r0, r1, r2, r3, r4, r5, r6, r7) (uint8_t)( \
+    ((((r0) >> (7 - (c))) & 1) << 0) | ((((r1) >> (7 - (c))) & 1) << 1) | \
+    ((((r2) >> (7 - (c))) & 1) << 2) | ((((r3) >> (7 - (c))) & 1) << 3) | \
+    ((((r4) >> (7 - (c))) & 1) << 4) | ((((r5) >> (7 - (c))) & 1) << 5) | \
+    ((((r6) >> (7 - (c))) & 1) << 6) | ((((r7) >> (7 - (c))) & 1) << 7))
+
+#define FONT_COLUMNS(...) { \
+    FONT_COLUMN(0, __VA_ARGS__), FONT_COLUMN(1, __VA_ARGS__), \
+    FONT_COLUMN(2, __VA_ARGS__), FONT_COLUMN(3, __VA_ARGS__), \
+    FONT_COLUMN(4, __VA_ARGS__), FONT_COLUMN(5, __VA_ARGS__), \
+    FONT_COLUMN(6, __VA_ARGS__), FONT_COLUMN(7, __VA_ARGS__) }
+
+// First and last lit column of the OR of all rows
+#define FONT_FIRST_COL(m) ((m) & 0x80 ? 0 : (m) & 0x40 ? 1 : (m) & 0x20 ? 2 : \
+    (m) & 0x10 ? 3 : (m) & 0x08 ? 4 : (m) & 0x04 ? 5 : (m) & 0x02 ? 6 : 7)
+#define FONT_LAST_COL(m) ((m) & 0x01 ? 7 : (m) & 0x02 ? 6 : (m) & 0x04 ? 5 : \
+    (m) & 0x08 ? 4 : (m) & 0x10 ? 3 : (m) & 0x20 ? 2 : (m) & 0x40 ? 1 : 0)
+
+// Left column in the high nibble, width in the low nibble
+#define FONT_METRICS(m) (uint8_t)((m) == 0 ? FONT_BLANK_WIDTH : \
+    (FONT_FIRST_COL(m) << 4) | (FONT_LAST_COL(m) - FONT_FIRST_COL(m) + 1))
+
+const uint8_t font_glyphs[FONT_GLYPH_COUNT][8] = {
+#define FONT_GLYPH(name, cp, ...) FONT_ROWS(__VA_ARGS__),
+#include "font_data.h"
+#undef FONT_GLYPH
+};
+
+const uint8_t font_columns[FONT_GLYPH_COUNT][8] = {
+#define FONT_GLYPH(name, cp, ...) FONT_COLUMNS(__VA_ARGS__),
+#include "font_data.h"
+#undef FONT_GLYPH
+};
+
+static const uint8_t font_metrics[FONT_GLYPH_COUNT] = {
+#define FONT_GLYPH(name, cp, r0, r1, r2, r3, r4, r5, r6, r7) \
+    FONT_METRICS((r0) | (r1) | (r2) | (r3) | (r4) | (r5) | (r6) | (r7)),
+#include "font_data.h"
+#undef FONT_GLYPH
+};
+
+// Code point to glyph index for U+0020..U+015F, 0 where there is no glyph.
+// Glyphs without a code point land in the spare slot at the end.
+#define FONT_MAP_SIZE (FONT_LAST_CODEPOINT - FONT_FIRST_CODEPOINT + 1)
+
+static const uint8_t font_map[FONT_MAP_SIZE + 1] = {
+#define FONT_GLYPH(name, cp, ...) \
+    [(cp) >= FONT_FIRST_CODEPOINT ? (cp) - FONT_FIRST_CODEPOINT : FONT_MAP_SIZE] = GLYPH_##name,
+#include "font_data.h"
+#undef FONT_GLYPH
+};
+
+uint8_t font_index(uint32_t codepoint) {
+    if (codepoint < FONT_FIRST_CODEPOINT || codepoint > FONT_LAST_CODEPOINT) {
+        return FONT_GLYPH_MISSING;
+    }
+    return font_map[codepoint - FONT_FIRST_CODEPOINT];
+}
+
+const uint8_t *font_lookup(uint32_t codepoint) {
+    return font_glyphs[font_index(codepoint)];
+}
+
+uint8_t font_left(uint8_t index) {
+    if (index >= FONT_GLYPH_COUNT) index = FONT_GLYPH_MISSING;
+    return font_metrics[index] >> 4;
+}
+
+uint8_t font_width(uint8_t index) {
+    if (index >= FONT_GLYPH_COUNT) index = FONT_GLYPH_MISSING;
+    return font_metrics[index] & 0x0F;
+}
+
+uint32_t utf8_next(const char **s) {
+    const uint8_t *p = (const uint8_t *)*s;
+    uint32_t cp;
+    int extra;
+
+    if (p[0] == 0) {
+        return 0;
+    } else if (p[0] < 0x80) {
+        cp = p[0];
+        extra = 0;
+    } else if ((p[0] & 0xE0) == 0xC0) {
+        cp = p[0] & 0x1F;
+        extra = 1;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        cp = p[0] & 0x0F;
+        extra = 2;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        cp = p[0] & 0x07;
+        extra = 3;
+    } else {
+        // Stray continuation byte, skip it
+        *s += 1;
+        return FONT_REPLACEMENT;
+    }
+
+    for (int i = 1; i <= extra; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            // Truncated sequence, resume at the offending byte
+            *s += i;
+            return FONT_REPLACEMENT;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *s += extra + 1;
+    return cp;
+}
@@ -0,0 +1,52 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+
+// Glyph indices, GLYPH_<name> for every entry of font_data.h
+enum {
+#define FONT_GLYPH(name, cp, r0, r1, r2, r3, r4, r5, r6, r7) GLYPH_##name,
+#include "font_data.h"
+#undef FONT_GLYPH
+    FONT_GLYPH_COUNT
+};
+
+// Glyph shown for code points the font does not cover
+#define FONT_GLYPH_MISSING GLYPH_MISSING
+
+// Range of code points covered by the lookup map
+#define FONT_FIRST_CODEPOINT 0x0020
+#define FONT_LAST_CODEPOINT  0x015F
+
+// Code point of glyphs that are not reachable through the map
+#define FONT_NO_CODEPOINT 0
+
+// Returned by utf8_next() for malformed input (U+FFFD)
+#define FONT_REPLACEMENT 0xFFFD
+
+// Advance of a glyph without any lit column (space)
+#define FONT_BLANK_WIDTH 3
+
+// Row-major glyphs: eight row bytes, bit 7 is the leftmost column
+extern const uint8_t font_glyphs[FONT_GLYPH_COUNT][8];
+
+// Column-major glyphs: eight column bytes from left to right,
+// bit 0 is the top row. Generated from the rows at compile time.
+extern const uint8_t font_columns[FONT_GLYPH_COUNT][8];
+
+// Glyph index for a Unicode code point, O(1)
+uint8_t font_index(uint32_t codepoint);
+
+// Rows of the glyph for a Unicode code point
+const uint8_t *font_lookup(uint32_t codepoint);
+
+// First lit column and number of columns from there to the last lit one.
+// Proportional text uses font_columns[index][left .. left + width - 1].
+uint8_t font_left(uint8_t index);
+uint8_t font_width(uint8_t index);
+
+// Decode the next UTF-8 code point and advance *s past it.
+// Returns 0 at the end of the string.
+uint32_t utf8_next(const char **s);
+
+#endif
@@ -0,0 +1,824 @@
+// Glyph list, expanded by font.h and font.c with their own FONT_GLYPH.
+// FONT_GLYPH(name, code point, row 0 .. row 7), bit 7 is the leftmost column.
+// The first entry is shown for code points the font does not cover.
+
+// Missing glyph - index 0
+FONT_GLYPH(MISSING, FONT_NO_CODEPOINT,
+    0b11111111,
+    0b11000011,
+    0b10100101,
+    0b10011001,
+    0b10011001,
+    0b10100101,
+    0b11000011,
+    0b11111111)
+// Space - index 1
+FONT_GLYPH(SPACE, ' ',
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000)
+// ! - index 2
+FONT_GLYPH(EXCLAM, '!',
+    0b00011000,
+    0b00011000,
+    0b00011000,
+    0b00011000,
+    0b00011000,
+    0b00000000,
+    0b00011000,
+    0b00000000)
+// , - index 3
+FONT_GLYPH(COMMA, ',',
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00011000,
+    0b00011000,
+    0b00010000)
+// - - index 4
+FONT_GLYPH(MINUS, '-',
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b01111110,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000)
+// . - index 5
+FONT_GLYPH(PERIOD, '.',
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00000000,
+    0b00011000,
+    0b00011000)
+// : - index 6
+FONT_GLYPH(COLON, ':',
+    0b00000000,
+    0b00011000,
+    0b00011000,
+    0b00000000,
+    0b00000000,
+    0b00011000,
+    0b00011000,
+    0b00000000)
+// ? - index 7
+FONT_GLYPH(QUESTION, '?',
+    0b00111100,
+    0b01000010,
+    0b00000010,
+    0b00001100,
+    0b00010000,
+    0b00010000,
+    0b00000000,
+    0b00010000)
+// 0 - index 8
+FONT_GLYPH(DIGIT_0, '0',
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// 1 - index 9
+FONT_GLYPH(DIGIT_1, '1',
+    0b00001000,
+    0b00011000,
+    0b00101000,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00111110)
+// 2 - index 10
+FONT_GLYPH(DIGIT_2, '2',
+    0b00111100,
+    0b01000010,
+    0b00000010,
+    0b00000100,
+    0b00001000,
+    0b00010000,
+    0b00100000,
+    0b01111110)
+// 3 - index 11
+FONT_GLYPH(DIGIT_3, '3',
+    0b00111100,
+    0b01000010,
+    0b00000010,
+    0b00011100,
+    0b00000010,
+    0b00000010,
+    0b01000010,
+    0b00111100)
+// 4 - index 12
+FONT_GLYPH(DIGIT_4, '4',
+    0b00000100,
+    0b00001100,
+    0b00010100,
+    0b00100100,
+    0b01000100,
+    0b01111110,
+    0b00000100,
+    0b00000100)
+// 5 - index 13
+FONT_GLYPH(DIGIT_5, '5',
+    0b01111110,
+    0b01000000,
+    0b01000000,
+    0b01111100,
+    0b00000010,
+    0b00000010,
+    0b01000010,
+    0b00111100)
+// 6 - index 14
+FONT_GLYPH(DIGIT_6, '6',
+    0b00111100,
+    0b01000010,
+    0b01000000,
+    0b01111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// 7 - index 15
+FONT_GLYPH(DIGIT_7, '7',
+    0b01111110,
+    0b00000010,
+    0b00000100,
+    0b00001000,
+    0b00010000,
+    0b00100000,
+    0b00100000,
+    0b00100000)
+// 8 - index 16
+FONT_GLYPH(DIGIT_8, '8',
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// 9 - index 17
+FONT_GLYPH(DIGIT_9, '9',
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111110,
+    0b00000010,
+    0b01000010,
+    0b00111100)
+// A - index 18
+FONT_GLYPH(A, 'A',
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01111110,
+    0b01000010,
+    0b01000010,
+    0b01000010)
+// B - index 19
+FONT_GLYPH(B, 'B',
+    0b01111100,
+    0b01000010,
+    0b01000010,
+    0b01111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01111100)
+// C - index 20
+FONT_GLYPH(C, 'C',
+    0b00111100,
+    0b01000010,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000010,
+    0b00111100)
+// D - index 21
+FONT_GLYPH(D, 'D',
+    0b01111000,
+    0b01000100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000100,
+    0b01111000)
+// E - index 22
+FONT_GLYPH(E, 'E',
+    0b01111110,
+    0b01000000,
+    0b01000000,
+    0b01111100,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01111110)
+// F - index 23
+FONT_GLYPH(F, 'F',
+    0b01111110,
+    0b01000000,
+    0b01000000,
+    0b01111100,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000)
+// G - index 24
+FONT_GLYPH(G, 'G',
+    0b00111100,
+    0b01000010,
+    0b01000000,
+    0b01000000,
+    0b01001110,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// H - index 25
+FONT_GLYPH(H, 'H',
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01111110,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010)
+// I - index 26
+FONT_GLYPH(I, 'I',
+    0b00111100,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00111100)
+// J - index 27
+FONT_GLYPH(J, 'J',
+    0b00000010,
+    0b00000010,
+    0b00000010,
+    0b00000010,
+    0b00000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// K - index 28
+FONT_GLYPH(K, 'K',
+    0b01000010,
+    0b01000100,
+    0b01001000,
+    0b01010000,
+    0b01100000,
+    0b01010000,
+    0b01001000,
+    0b01000100)
+// L - index 29
+FONT_GLYPH(L, 'L',
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01111110)
+// M - index 30
+FONT_GLYPH(M, 'M',
+    0b01000010,
+    0b01100110,
+    0b01011010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010)
+// N - index 31
+FONT_GLYPH(N, 'N',
+    0b01000010,
+    0b01100010,
+    0b01010010,
+    0b01001010,
+    0b01000110,
+    0b01000010,
+    0b01000010,
+    0b01000010)
+// O - index 32
+FONT_GLYPH(O, 'O',
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// P - index 33
+FONT_GLYPH(P, 'P',
+    0b01111100,
+    0b01000010,
+    0b01000010,
+    0b01111100,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000)
+// Q - index 34
+FONT_GLYPH(Q, 'Q',
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01001010,
+    0b01000100,
+    0b00111010)
+// R - index 35
+FONT_GLYPH(R, 'R',
+    0b01111100,
+    0b01000010,
+    0b01000010,
+    0b01111100,
+    0b01100000,
+    0b01010000,
+    0b01001000,
+    0b01000100)
+// S - index 36
+FONT_GLYPH(S, 'S',
+    0b00111100,
+    0b01000010,
+    0b01000000,
+    0b00111000,
+    0b00000100,
+    0b00000010,
+    0b01000010,
+    0b00111100)
+// T - index 37
+FONT_GLYPH(T, 'T',
+    0b01111110,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000)
+// U - index 38
+FONT_GLYPH(U, 'U',
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// V - index 39
+FONT_GLYPH(V, 'V',
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00100100,
+    0b00011000,
+    0b00000000)
+// W - index 40
+FONT_GLYPH(W, 'W',
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01011010,
+    0b01100110,
+    0b01000010)
+// X - index 41
+FONT_GLYPH(X, 'X',
+    0b01000010,
+    0b01000010,
+    0b00100100,
+    0b00011000,
+    0b00011000,
+    0b00100100,
+    0b01000010,
+    0b01000010)
+// Y - index 42
+FONT_GLYPH(Y, 'Y',
+    0b01000010,
+    0b01000010,
+    0b00100100,
+    0b00011000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000)
+// Z - index 43
+FONT_GLYPH(Z, 'Z',
+    0b01111110,
+    0b00000010,
+    0b00000100,
+    0b00001000,
+    0b00010000,
+    0b00100000,
+    0b01000000,
+    0b01111110)
+// Ç - index 44
+FONT_GLYPH(C_CEDILLA, 0x0C7,
+    0b00111100,
+    0b01000010,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000010,
+    0b00111100,
+    0b00001000)
+// Ğ - index 45
+FONT_GLYPH(G_BREVE, 0x11E,
+    0b00100100,
+    0b00011000,
+    0b00111100,
+    0b01000000,
+    0b01001110,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// İ - index 46
+FONT_GLYPH(I_DOT, 0x130,
+    0b00001000,
+    0b00000000,
+    0b00111100,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00001000,
+    0b00111100)
+// Ö - index 47
+FONT_GLYPH(O_DIAERESIS, 0x0D6,
+    0b00100100,
+    0b00000000,
+    0b00111100,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// Ş - index 48
+FONT_GLYPH(S_CEDILLA, 0x15E,
+    0b00111100,
+    0b01000010,
+    0b01000000,
+    0b00111100,
+    0b00000010,
+    0b01000010,
+    0b00111100,
+    0b00001000)
+// Ü - index 49
+FONT_GLYPH(U_DIAERESIS, 0x0DC,
+    0b00100100,
+    0b00000000,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b01000010,
+    0b00111100)
+// a - index 50
+FONT_GLYPH(a, 'a',
+    0b00000000,
+    0b00000000,
+    0b00111000,
+    0b00000100,
+    0b00111100,
+    0b01000100,
+    0b01000100,
+    0b00111100)
+// b - index 51
+FONT_GLYPH(b, 'b',
+    0b01000000,
+    0b01000000,
+    0b01111000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01111000)
+// c - index 52
+FONT_GLYPH(c, 'c',
+    0b00000000,
+    0b00000000,
+    0b00111100,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b00111100)
+// d - index 53
+FONT_GLYPH(d, 'd',
+    0b00000100,
+    0b00000100,
+    0b00111100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b00111100)
+// e - index 54
+FONT_GLYPH(e, 'e',
+    0b00000000,
+    0b00000000,
+    0b00111000,
+    0b01000100,
+    0b01111100,
+    0b01000000,
+    0b01000000,
+    0b00111100)
+// f - index 55
+FONT_GLYPH(f, 'f',
+    0b00011100,
+    0b00100000,
+    0b00100000,
+    0b01111000,
+    0b00100000,
+    0b00100000,
+    0b00100000,
+    0b00100000)
+// g - index 56
+FONT_GLYPH(g, 'g',
+    0b00000000,
+    0b00000000,
+    0b00111100,
+    0b01000100,
+    0b01000100,
+    0b00111100,
+    0b00000100,
+    0b00111000)
+// h - index 57
+FONT_GLYPH(h, 'h',
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01111000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100)
+// i - index 58
+FONT_GLYPH(i, 'i',
+    0b00010000,
+    0b00000000,
+    0b00110000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00111000)
+// j - index 59
+FONT_GLYPH(j, 'j',
+    0b00000100,
+    0b00000000,
+    0b00001100,
+    0b00000100,
+    0b00000100,
+    0b00000100,
+    0b01000100,
+    0b00111000)
+// k - index 60
+FONT_GLYPH(k, 'k',
+    0b01000000,
+    0b01000000,
+    0b01000100,
+    0b01001000,
+    0b01110000,
+    0b01001000,
+    0b01000100,
+    0b01000100)
+// l - index 61
+FONT_GLYPH(l, 'l',
+    0b00110000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00111000)
+// m - index 62
+FONT_GLYPH(m, 'm',
+    0b00000000,
+    0b00000000,
+    0b01101000,
+    0b01010100,
+    0b01010100,
+    0b01010100,
+    0b01010100,
+    0b01010100)
+// n - index 63
+FONT_GLYPH(n, 'n',
+    0b00000000,
+    0b00000000,
+    0b01111000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100)
+// o - index 64
+FONT_GLYPH(o, 'o',
+    0b00000000,
+    0b00000000,
+    0b00111000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b00111000)
+// p - index 65
+FONT_GLYPH(p, 'p',
+    0b00000000,
+    0b00000000,
+    0b01111000,
+    0b01000100,
+    0b01000100,
+    0b01111000,
+    0b01000000,
+    0b01000000)
+// q - index 66
+FONT_GLYPH(q, 'q',
+    0b00000000,
+    0b00000000,
+    0b00111100,
+    0b01000100,
+    0b01000100,
+    0b00111100,
+    0b00000100,
+    0b00000100)
+// r - index 67
+FONT_GLYPH(r, 'r',
+    0b00000000,
+    0b00000000,
+    0b01011100,
+    0b01100000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000)
+// s - index 68
+FONT_GLYPH(s, 's',
+    0b00000000,
+    0b00000000,
+    0b00111100,
+    0b01000000,
+    0b00111000,
+    0b00000100,
+    0b00000100,
+    0b01111000)
+// t - index 69
+FONT_GLYPH(t, 't',
+    0b00010000,
+    0b00010000,
+    0b00111000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00001100)
+// u - index 70
+FONT_GLYPH(u, 'u',
+    0b00000000,
+    0b00000000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b00111100)
+// v - index 71
+FONT_GLYPH(v, 'v',
+    0b00000000,
+    0b00000000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b00101000,
+    0b00010000)
+// w - index 72
+FONT_GLYPH(w, 'w',
+    0b00000000,
+    0b00000000,
+    0b01000100,
+    0b01000100,
+    0b01010100,
+    0b01010100,
+    0b01010100,
+    0b00101000)
+// x - index 73
+FONT_GLYPH(x, 'x',
+    0b00000000,
+    0b00000000,
+    0b01000100,
+    0b00101000,
+    0b00010000,
+    0b00010000,
+    0b00101000,
+    0b01000100)
+// y - index 74
+FONT_GLYPH(y, 'y',
+    0b00000000,
+    0b00000000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b00111100,
+    0b00000100,
+    0b00111000)
+// z - index 75
+FONT_GLYPH(z, 'z',
+    0b00000000,
+    0b00000000,
+    0b01111100,
+    0b00000100,
+    0b00001000,
+    0b00010000,
+    0b00100000,
+    0b01111100)
+// ç - index 76
+FONT_GLYPH(c_cedilla, 0x0E7,
+    0b00000000,
+    0b00111100,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b01000000,
+    0b00111100,
+    0b00010000)
+// ğ - index 77
+FONT_GLYPH(g_breve, 0x11F,
+    0b00101000,
+    0b00010000,
+    0b00111100,
+    0b01000100,
+    0b01000100,
+    0b00111100,
+    0b00000100,
+    0b00111000)
+// ı - index 78
+FONT_GLYPH(dotless_i, 0x131,
+    0b00000000,
+    0b00000000,
+    0b00110000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00010000,
+    0b00111000)
+// ö - index 79
+FONT_GLYPH(o_diaeresis, 0x0F6,
+    0b00101000,
+    0b00000000,
+    0b00111000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b00111000)
+// ş - index 80
+FONT_GLYPH(s_cedilla, 0x15F,
+    0b00000000,
+    0b00111100,
+    0b01000000,
+    0b00111000,
+    0b00000100,
+    0b00000100,
+    0b01111000,
+    0b00010000)
+// ü - index 81
+FONT_GLYPH(u_diaeresis, 0x0FC,
+    0b00101000,
+    0b00000000,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b01000100,
+    0b00111100)
@@ -0,0 +1,222 @@
+#include "stm32f4xx.h"
+#include "framebuffer.h"
+#include "dlcache.h"
+
+// What the application draws (back buffer), the last completed frame
+// waiting for vsync (front buffer) and what the MAX7219s are known to hold
+static uint8_t fb_rows[8][MAX7219_NUM_DEVICES];
+static uint8_t fb_front[8][MAX7219_NUM_DEVICES];
+static uint8_t fb_shadow[8][MAX7219_NUM_DEVICES];
+static volatile uint8_t fb_shadow_valid;
+static volatile uint8_t fb_flip_pending;
+static uint16_t vsync_hz;
+static uint8_t vsync_holds;
+static uint8_t fb_use_cache;
+
+void fb_init(void) {
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            fb_rows[row][dev] = 0x00;
+            fb_shadow[row][dev] = 0x00;
+        }
+    }
+    fb_shadow_valid = 1;
+}
+
+void fb_invalidate(void) {
+    fb_shadow_valid = 0;
+}
+
+void fb_clear(void) {
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            fb_rows[row][dev] = 0x00;
+        }
+    }
+}
+
+void fb_set_row(uint8_t dev, uint8_t row, uint8_t data) {
+    if (dev >= MAX7219_NUM_DEVICES || row >= 8) return;
+    fb_rows[row][dev] = data;
+}
+
+uint8_t fb_get_row(uint8_t dev, uint8_t row) {
+    if (dev >= MAX7219_NUM_DEVICES || row >= 8) return 0x00;
+    return fb_rows[row][dev];
+}
+
+void fb_draw_glyph(uint8_t dev, const uint8_t *glyph) {
+    if (dev >= MAX7219_NUM_DEVICES) return;
+    for (int row = 0; row < 8; row++) {
+        fb_rows[row][dev] = glyph[row];
+    }
+}
+
+void fb_shift_left(uint8_t column) {
+    for (int row = 0; row < 8; row++) {
+        uint8_t *r = fb_rows[row];
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES - 1; dev++) {
+            r[dev] = (uint8_t)((r[dev] << 1) | (r[dev + 1] >> 7));
+        }
+        r[MAX7219_NUM_DEVICES - 1] = (uint8_t)((r[MAX7219_NUM_DEVICES - 1] << 1) |
+                                               ((column >> row) & 1));
+    }
+}
+
+// Rows of buf the devices are not known to hold
+static uint8_t dirty_rows(uint8_t buf[8][MAX7219_NUM_DEVICES]) {
+    uint8_t dirty = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            if (!fb_shadow_valid || buf[row][dev] != fb_shadow[row][dev]) {
+                dirty++;
+                break;
+            }
+        }
+    }
+    return dirty;
+}
+
+// Send the rows of buf that differ from the shadow as one frame
+static uint8_t flush_rows(uint8_t buf[8][MAX7219_NUM_DEVICES]) {
+    uint16_t frame[MAX7219_FRAME_WORDS];
+    uint8_t latches = 0;
+
+    // A cached frame goes out whole, which leaves the devices holding buf.
+    // It only pays when every row changed, fewer rows are a shorter frame.
+    if (fb_use_cache && dirty_rows(buf) == 8 &&
+        dlcache_show((const uint8_t (*)[MAX7219_NUM_DEVICES])buf)) {
+        for (int row = 0; row < 8; row++) {
+            for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                fb_shadow[row][dev] = buf[row][dev];
+            }
+        }
+        fb_shadow_valid = 1;
+        return 8;
+    }
+
+    for (int row = 0; row < 8; row++) {
+        uint8_t dirty = 0;
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            if (!fb_shadow_valid || buf[row][dev] != fb_shadow[row][dev]) {
+                dirty = 1;
+                break;
+            }
+        }
+        if (!dirty) continue;
+
+        // Unchanged devices in a dirty row get NOOP so they are left alone
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            uint16_t word = MAX7219_WORD(REG_NOOP, 0x00);
+            if (!fb_shadow_valid || buf[row][dev] != fb_shadow[row][dev]) {
+                word = MAX7219_WORD(REG_DIGIT0 + row, buf[row][dev]);
+                fb_shadow[row][dev] = buf[row][dev];
+            }
+            frame[MAX7219_FRAME_INDEX(latches, dev)] = word;
+        }
+        latches++;
+    }
+
+    fb_shadow_valid = 1;
+    send_frame(frame, latches);
+    return latches;
+}
+
+void fb_display_cache(uint8_t on) {
+    fb_use_cache = on;
+}
+
+uint8_t fb_flush(void) {
+    return flush_rows(fb_rows);
+}
+
+// Let the vsync interrupt back in unless someone holds it off
+static void vsync_irq_restore(void) {
+    if (vsync_hz && vsync_holds == 0) {
+        NVIC_EnableIRQ(TIM2_IRQn);
+    }
+}
+
+void fb_swap(void) {
+    // Keep the vsync interrupt out while the front buffer is half copied
+    NVIC_DisableIRQ(TIM2_IRQn);
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            fb_front[row][dev] = fb_rows[row][dev];
+        }
+    }
+    fb_flip_pending = 1;
+    vsync_irq_restore();
+}
+
+uint8_t fb_flip_pending_get(void) {
+    return fb_flip_pending;
+}
+
+// TIM2 runs at HCLK whenever APB1 is divided by 1 or 2
+static uint32_t vsync_psc(void) {
+    return SystemCoreClock / FB_VSYNC_MAX_HZ - 1;
+}
+
+void fb_vsync_start(uint16_t hz) {
+    // One update per timer tick at most, and no divide by zero
+    if (hz == 0) hz = 1;
+    if (hz > FB_VSYNC_MAX_HZ) hz = FB_VSYNC_MAX_HZ;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+    vsync_hz = hz;
+
+    // 10 kHz timer clock, update event at hz
+    TIM2->CR1 = 0;
+    TIM2->PSC = vsync_psc();
+    TIM2->ARR = FB_VSYNC_MAX_HZ / hz - 1;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE;
+
+    // Below the SPI DMA interrupt, which has to latch while a flip waits
+    NVIC_SetPriority(TIM2_IRQn, 2);
+    vsync_irq_restore();
+    TIM2->CR1 = TIM_CR1_CEN;
+}
+
+void fb_vsync_hold(void) {
+    NVIC_DisableIRQ(TIM2_IRQn);
+    vsync_holds++;
+    // A frame the last flip started must be fully latched first
+    while (transport_busy());
+}
+
+void fb_vsync_release(void) {
+    if (vsync_holds > 0) {
+        vsync_holds--;
+    }
+    vsync_irq_restore();
+}
+
+void fb_vsync_recalibrate(void) {
+    if (vsync_hz == 0) {
+        return;
+    }
+
+    // PSC is preloaded, force an update so the new rate applies at once
+    TIM2->PSC = vsync_psc();
+    TIM2->DIER &= ~TIM_DIER_UIE;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->SR = ~TIM_SR_UIF;
+    TIM2->DIER |= TIM_DIER_UIE;
+}
+
+// Vsync: push the pending frame in one burst once the bus is free
+void TIM2_IRQHandler(void) {
+    if (!(TIM2->SR & TIM_SR_UIF)) {
+        return;
+    }
+    TIM2->SR = ~TIM_SR_UIF;
+
+    // A frame still on the wire is finished first, the flip waits a tick
+    if (fb_flip_pending && !transport_busy()) {
+        flush_rows(fb_front);
+        fb_flip_pending = 0;
+    }
+}
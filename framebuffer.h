@@ -0,0 +1,65 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdint.h>
+#include "max7219.h"
+
+// Shadow copy of the digit registers: one row byte per device, bit 7 is
+// the leftmost column and device 0 is the leftmost module. fb_flush()
+// only sends rows that differ from what the MAX7219s currently hold.
+
+// Reset both buffers to blank (matches the state after init_max7219)
+void fb_init(void);
+
+// Forget what the devices hold so the next flush resends every row
+void fb_invalidate(void);
+
+// Blank the drawing buffer
+void fb_clear(void);
+
+// Set or read one row of one device
+void fb_set_row(uint8_t dev, uint8_t row, uint8_t data);
+uint8_t fb_get_row(uint8_t dev, uint8_t row);
+
+// Copy an 8-row glyph onto one device
+void fb_draw_glyph(uint8_t dev, const uint8_t *glyph);
+
+// Shift the whole chain one pixel left, column enters at the right edge
+// (column-major: bit 0 is the top row)
+void fb_shift_left(uint8_t column);
+
+// Send the changed rows now, returns the number of latches sent.
+// Not to be mixed with fb_swap() once vsync is running.
+uint8_t fb_flush(void);
+
+// Send frames through the display-list cache (dlcache.h): a frame that
+// keeps coming back is encoded once and then resent whole by DMA instead
+// of being diffed and encoded again
+void fb_display_cache(uint8_t on);
+
+// Double buffering: the application draws into the back buffer and calls
+// fb_swap() when the frame is complete. The frame is copied to the front
+// buffer and the vsync interrupt (TIM2) sends its changed rows in a single
+// burst, so a partly drawn frame is never shown and drawing never blocks
+// on the bus. A newer swap replaces a frame that has not been sent yet.
+void fb_swap(void);
+
+// Non-zero while a swapped frame waits for vsync
+uint8_t fb_flip_pending_get(void);
+
+// Vsync timer clock, the highest frame rate fb_vsync_start() accepts
+#define FB_VSYNC_MAX_HZ 10000
+
+// Start the vsync timer at hz frames per second, clamped to 1 ..
+// FB_VSYNC_MAX_HZ
+void fb_vsync_start(uint16_t hz);
+
+// Keep the vsync flip off the bus while the caller sends its own
+// commands. Holds nest: the flip resumes after the last release.
+void fb_vsync_hold(void);
+void fb_vsync_release(void);
+
+// Reload the vsync prescaler after SystemCoreClock changed
+void fb_vsync_recalibrate(void);
+
+#endif
@@ -0,0 +1,167 @@
+#include "stm32f4xx.h"
+#include "gray.h"
+#include "framebuffer.h"
+
+// Bit planes as rows (bit 7 leftmost) and as ready-to-send frames
+static uint8_t planes[GRAY_MAX_BITS][8][MAX7219_NUM_DEVICES];
+static uint16_t plane_frames[GRAY_MAX_BITS][MAX7219_FRAME_WORDS];
+
+static uint8_t gray_bits = GRAY_MAX_BITS;
+static uint32_t gray_base_us;
+static volatile uint8_t current_plane;
+static volatile uint32_t overruns;
+static uint8_t gray_running;
+
+void gray_budget(uint8_t bits, uint32_t bus_bit_hz, uint32_t min_plane_us,
+                 gray_budget_t *budget) {
+    uint32_t frame_bits = 8UL * MAX7219_NUM_DEVICES * 16;
+
+    budget->transfer_us = bus_bit_hz ? (uint32_t)((uint64_t)frame_bits * 1000000 / bus_bit_hz) + 1 : 0;
+    budget->plane_us = min_plane_us > budget->transfer_us ? min_plane_us : budget->transfer_us;
+    budget->period_us = budget->plane_us * ((1UL << bits) - 1);
+    budget->refresh_hz = budget->period_us ? 1000000 / budget->period_us : 0;
+    budget->flicker_free = budget->refresh_hz >= GRAY_MIN_REFRESH_HZ;
+    budget->scan_aligned = budget->plane_us >= GRAY_SCAN_PERIOD_US;
+}
+
+uint32_t gray_plane_weight(uint8_t plane) {
+    return 1UL << plane;
+}
+
+void gray_init(uint8_t bits) {
+    if (bits < GRAY_MIN_BITS) bits = GRAY_MIN_BITS;
+    if (bits > GRAY_MAX_BITS) bits = GRAY_MAX_BITS;
+    gray_bits = bits;
+
+    for (int k = 0; k < GRAY_MAX_BITS; k++) {
+        for (int row = 0; row < 8; row++) {
+            for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                planes[k][row][dev] = 0x00;
+            }
+        }
+    }
+    gray_commit();
+}
+
+void gray_set_pixel(uint16_t x, uint8_t y, uint8_t level) {
+    if (x >= 8 * MAX7219_NUM_DEVICES || y >= 8) return;
+
+    uint8_t dev = x >> 3;
+    uint8_t mask = 0x80 >> (x & 7);
+    for (int k = 0; k < gray_bits; k++) {
+        if (level & (1 << k)) {
+            planes[k][y][dev] |= mask;
+        } else {
+            planes[k][y][dev] &= ~mask;
+        }
+    }
+}
+
+uint8_t gray_get_pixel(uint16_t x, uint8_t y) {
+    if (x >= 8 * MAX7219_NUM_DEVICES || y >= 8) return 0;
+
+    uint8_t dev = x >> 3;
+    uint8_t mask = 0x80 >> (x & 7);
+    uint8_t level = 0;
+    for (int k = 0; k < gray_bits; k++) {
+        if (planes[k][y][dev] & mask) {
+            level |= 1 << k;
+        }
+    }
+    return level;
+}
+
+void gray_commit(void) {
+    for (int k = 0; k < gray_bits; k++) {
+        // The DMA reads the frames in place, so wait for it to finish and
+        // keep the next plane slot out while this plane is rewritten
+        NVIC_DisableIRQ(TIM3_IRQn);
+        while (transport_busy());
+        for (int row = 0; row < 8; row++) {
+            for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                plane_frames[k][MAX7219_FRAME_INDEX(row, dev)] =
+                    MAX7219_WORD(REG_DIGIT0 + row, planes[k][row][dev]);
+            }
+        }
+        if (gray_running) {
+            NVIC_EnableIRQ(TIM3_IRQn);
+        }
+    }
+}
+
+void gray_start(uint32_t base_us) {
+    // The planes own the digit registers, a vsync flip would overwrite
+    // one mid-refresh
+    if (!gray_running) {
+        fb_vsync_hold();
+        gray_running = 1;
+    }
+    gray_base_us = base_us;
+    current_plane = 0;
+    overruns = 0;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+
+    // 1 MHz timer clock, ARR preloaded so each update sets the next plane time
+    TIM3->CR1 = 0;
+    TIM3->PSC = SystemCoreClock / 1000000 - 1;
+    TIM3->ARR = gray_base_us - 1;
+    TIM3->EGR = TIM_EGR_UG;
+    TIM3->SR = 0;
+    TIM3->CR1 = TIM_CR1_ARPE;
+    TIM3->DIER = TIM_DIER_UIE;
+
+    NVIC_SetPriority(TIM3_IRQn, 2);
+    NVIC_EnableIRQ(TIM3_IRQn);
+    TIM3->CR1 |= TIM_CR1_CEN;
+}
+
+void gray_stop(void) {
+    TIM3->CR1 &= ~TIM_CR1_CEN;
+    TIM3->DIER = 0;
+    NVIC_DisableIRQ(TIM3_IRQn);
+    if (!gray_running) {
+        return;
+    }
+    gray_running = 0;
+
+    // The devices hold the last plane, the next flip resends every row
+    while (transport_busy());
+    fb_invalidate();
+    fb_vsync_release();
+}
+
+void gray_recalibrate(void) {
+    // Preloaded, the new prescaler applies from the next plane slot
+    if (TIM3->CR1 & TIM_CR1_CEN) {
+        TIM3->PSC = SystemCoreClock / 1000000 - 1;
+    }
+}
+
+uint32_t gray_overruns(void) {
+    return overruns;
+}
+
+// Start of a plane slot: show plane current_plane, program the next length
+void TIM3_IRQHandler(void) {
+    if (!(TIM3->SR & TIM_SR_UIF)) {
+        return;
+    }
+    TIM3->SR = ~TIM_SR_UIF;
+
+    uint8_t plane = current_plane;
+    if (transport_busy()) {
+        // The previous plane is still shifting (the base time is too
+        // short) or a command latch holds the bus
+        overruns++;
+    } else {
+        send_frame_ref(plane_frames[plane], 8);
+    }
+
+    uint8_t next = plane + 1;
+    if (next >= gray_bits) next = 0;
+    current_plane = next;
+
+    // Takes effect at the next update, i.e. for the slot of plane next
+    TIM3->ARR = (gray_base_us << next) - 1;
+}
@@ -0,0 +1,65 @@
+#ifndef GRAY_H
+#define GRAY_H
+
+#include <stdint.h>
+#include "max7219.h"
+
+// Grayscale by binary code modulation: a level of GRAY_MAX_BITS bits is
+// split into bit planes and plane k is shown for base << k microseconds,
+// so a pixel is lit for level / (2^bits - 1) of every refresh. TIM3 paces
+// the planes and each plane goes out as one pre-encoded DMA frame.
+// REG_INTENSITY still sets the brightness of a fully lit pixel.
+
+// Up to 4 bits per pixel (16 levels)
+#define GRAY_MIN_BITS 2
+#define GRAY_MAX_BITS 4
+
+// Refresh rate below which flicker becomes visible
+#define GRAY_MIN_REFRESH_HZ 100
+
+// The MAX7219 multiplexes its 8 digits at about 800 Hz. Planes shorter
+// than one scan are only seen by some rows and beat against the scan.
+#define GRAY_SCAN_PERIOD_US 1250
+
+// Result of gray_budget()
+typedef struct {
+    uint32_t transfer_us;   // Time to shift one plane frame
+    uint32_t plane_us;      // Shortest plane (base time)
+    uint32_t period_us;     // One refresh: plane_us * (2^bits - 1)
+    uint32_t refresh_hz;
+    uint8_t flicker_free;   // refresh_hz >= GRAY_MIN_REFRESH_HZ
+    uint8_t scan_aligned;   // plane_us >= GRAY_SCAN_PERIOD_US
+} gray_budget_t;
+
+// Frame rate and flicker budget for a bit depth and bus speed. The base
+// plane time is the larger of min_plane_us and the plane transfer time.
+void gray_budget(uint8_t bits, uint32_t bus_bit_hz, uint32_t min_plane_us,
+                 gray_budget_t *budget);
+
+// Time plane k is shown for, in units of the base plane time
+uint32_t gray_plane_weight(uint8_t plane);
+
+// Select the bit depth (levels = 2^bits) and blank all pixels
+void gray_init(uint8_t bits);
+
+// Set the level of pixel (x, y), x runs across the chain from device 0
+void gray_set_pixel(uint16_t x, uint8_t y, uint8_t level);
+uint8_t gray_get_pixel(uint16_t x, uint8_t y);
+
+// Re-encode the plane frames after drawing. Planes pick up the new
+// frames at their next slot.
+void gray_commit(void);
+
+// Start and stop the plane timer, base_us is the shortest plane time.
+// The vsync flip is held while the planes run; fb_swap() still takes
+// frames and the latest one is shown in full after gray_stop().
+void gray_start(uint32_t base_us);
+void gray_stop(void);
+
+// Reload the plane timer prescaler after SystemCoreClock changed
+void gray_recalibrate(void);
+
+// Planes skipped because the previous one was still on the bus
+uint32_t gray_overruns(void);
+
+#endif
@@ -0,0 +1,377 @@
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include "max7219.h"
+#include "framebuffer.h"
+#include "sched.h"
+#include "font.h"
+#include "scroll.h"
+#include "bench.h"
+#include "brightness.h"
+#include "power.h"
+#include "clock.h"
+#include "uart.h"
+#include "proto.h"
+#include "anim.h"
+#include "canvas.h"
+#include "watch.h"
+#include "rtc.h"
+#include "watchdog.h"
+#include "spiflash.h"
+
+// Task period and frame rate of the vsync flip
+#define GLYPH_PERIOD_MS   1000
+#define VSYNC_HZ          50
+#define BRIGHTNESS_PERIOD_MS 100
+
+// Texts of the former single-font firmwares
+#define TEXT_DIGITS   "0123456789"
+#define TEXT_CAPITALS "ABCÇDEFGĞHIİJKLMNOÖPRSŞTUÜVYZ"
+#define TEXT_LETTERS  "abcçdefgğhıijklmnoöprsştuüvyz"
+
+// UTF-8 text shown one glyph at a time
+#ifndef CAROUSEL_TEXT
+#define CAROUSEL_TEXT TEXT_DIGITS
+#endif
+
+// Define SCROLL_TEXT to scroll a message across the chain instead of
+// showing the carousel, at SCROLL_SPEED_PPS pixels per second
+#ifndef SCROLL_SPEED_PPS
+#define SCROLL_SPEED_PPS 20
+#endif
+
+// Define SERIAL_PROTO to take text, frames, brightness (and the time with
+// WATCH) from a host on USART1 (see proto.h), polled every SERIAL_POLL_MS
+#ifndef SERIAL_POLL_MS
+#define SERIAL_POLL_MS 5
+#endif
+
+// Define ANIMATION to play the built-in animation (anim_demo) instead of
+// the carousel, stepped at the vsync rate
+#define ANIM_TICK_MS (1000 / VSYNC_HZ)
+
+// With ANIM_FLASH_ADDR as well, stream the animation image (anim.h) at
+// that address of the SPI flash, falling back to anim_demo when there is
+// none. The read-ahead is polled every ANIM_STREAM_POLL_MS.
+#define ANIM_STREAM_POLL_MS 2
+
+// Define GRID_COLS and GRID_ROWS (their product is MAX7219_NUM_DEVICES)
+// to lay the chain out as a serpentine module grid and pan a viewport
+// over CAROUSEL_TEXT drawn on a larger canvas
+#define GRID_CANVAS_WIDTH 256
+#ifndef GRID_ORIENT
+#define GRID_ORIENT MODULE_ROT_0
+#endif
+
+// Define WATCH to show the RTC time as HH:MM (HH:MM:SS with
+// WATCH_SECONDS), checked every WATCH_POLL_MS
+#define WATCH_POLL_MS 100
+#ifdef WATCH_SECONDS
+#define WATCH_SHOW_SECONDS 1
+#else
+#define WATCH_SHOW_SECONDS 0
+#endif
+
+// Define WATCHDOG to keep rewriting the MAX7219 configuration (one
+// register every WATCHDOG_PERIOD_MS) and run the IWDG on the MCU
+
+// Define DISPLAY_CACHE to resend recurring frames (the carousel glyphs)
+// from the display-list cache instead of encoding them again
+
+// Define LOW_POWER to idle in STOP mode (RTC wakeup) between tasks
+// instead of SLEEP
+
+// MAX7219 intensity (0x00 to 0x0F)
+#ifndef DISPLAY_INTENSITY
+#define DISPLAY_INTENSITY 0x0A
+#endif
+
+// Define AUTO_BRIGHTNESS to follow the light sensor on PA3 between
+// BRIGHTNESS_MIN and DISPLAY_INTENSITY instead of a fixed intensity
+#ifndef BRIGHTNESS_MIN
+#define BRIGHTNESS_MIN 0x01
+#endif
+
+// Draw the glyph of a code point on every module of the chain
+void display_char(uint32_t codepoint) {
+    const uint8_t *glyph = font_lookup(codepoint);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        fb_draw_glyph(dev, glyph);
+    }
+}
+
+// Next character of the carousel
+static const char *carousel_pos = CAROUSEL_TEXT;
+
+// Display the current character and move to the next one
+void advance_task(void) {
+    uint32_t codepoint = utf8_next(&carousel_pos);
+    if (codepoint == 0) {
+        // Wrap around to the start of the text
+        carousel_pos = CAROUSEL_TEXT;
+        codepoint = utf8_next(&carousel_pos);
+    }
+    display_char(codepoint);
+    fb_swap();
+}
+
+static scroller_t scroller;
+
+// Move the message one pixel to the left
+void scroll_task(void) {
+    scroller_step(&scroller);
+    fb_swap();
+}
+
+#ifdef ANIMATION
+static anim_player_t anim_player;
+
+#ifdef ANIM_FLASH_ADDR
+static anim_seq_t anim_flash_seq;
+static stream_t anim_stream;
+static uint8_t anim_stream_buf[2 * ANIM_STREAM_CHUNK];
+
+// Keep the read-ahead going between frames
+void anim_stream_task(void) {
+    stream_poll(&anim_stream);
+}
+#endif
+
+// Step the animation and flip when the picture or intensity changed
+void anim_task(void) {
+    if (!anim_tick(&anim_player, ANIM_TICK_MS)) return;
+
+    for (int dev = 0; dev < anim_player.dec.seq->devices; dev++) {
+        for (int row = 0; row < 8; row++) {
+            fb_set_row(dev, row, anim_player.out[dev * 8 + row]);
+        }
+    }
+    fb_swap();
+    if (anim_player.out_intensity != max7219_get_intensity()) {
+        fb_vsync_hold();
+        max7219_set_intensity(anim_player.out_intensity);
+        fb_vsync_release();
+    }
+}
+#endif
+
+#ifdef GRID_COLS
+static uint8_t grid_buf[(GRID_CANVAS_WIDTH / 8) * 8 * GRID_ROWS];
+static canvas_t grid_canvas;
+static layout_t grid_layout;
+static int16_t grid_x;
+static uint16_t grid_text_width;
+
+// Pan one pixel and push the modules whose rows changed
+void grid_task(void) {
+    uint8_t rows[MAX7219_NUM_DEVICES][8];
+
+    viewport_render(&grid_canvas, &grid_layout, grid_x, 0, rows);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            fb_set_row(dev, row, rows[dev][row]);
+        }
+    }
+    fb_swap();
+
+    // Enter from the right edge, leave on the left, start over
+    grid_x++;
+    if (grid_x > (int16_t)grid_text_width) {
+        grid_x = -8 * GRID_COLS;
+    }
+}
+#endif
+
+#ifdef WATCH
+static watch_t watch;
+
+// Push the digits that changed since the last second
+void watch_task(void) {
+    uint8_t rows[MAX7219_NUM_DEVICES][8];
+    watch_time_t now;
+
+    watch_time_from_bcd(rtc_get_tr(), &now);
+    if (!watch_update(&watch, &now, rows)) return;
+
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            fb_set_row(dev, row, rows[dev][row]);
+        }
+    }
+    fb_swap();
+}
+#endif
+
+#ifdef SERIAL_PROTO
+// What the display task shows, switched by host commands
+typedef enum {
+    SHOW_CAROUSEL,
+    SHOW_SCROLL,
+    SHOW_HOST_FRAMES,   // Frames come straight from the host
+    SHOW_WATCH
+} show_mode_t;
+
+static show_mode_t show_mode;
+static int8_t show_task_id;
+
+// Last text received, the scroller reads it in place
+static char serial_text[PROTO_MAX_PAYLOAD + 1];
+
+void show_task(void) {
+    if (show_mode == SHOW_SCROLL) {
+        scroll_task();
+    } else if (show_mode == SHOW_CAROUSEL) {
+        advance_task();
+    }
+#ifdef WATCH
+    else if (show_mode == SHOW_WATCH) {
+        watch_task();
+    }
+#endif
+}
+
+// Apply one command from the host
+static void serial_command(const proto_frame_t *frame) {
+    switch (frame->type) {
+    case PROTO_CMD_TEXT:
+        serial_text[proto_copy(frame, (uint8_t *)serial_text, PROTO_MAX_PAYLOAD)] = '\0';
+        scroller_start(&scroller, serial_text, 1);
+        show_mode = SHOW_SCROLL;
+        sched_set_period(show_task_id, scroller_period_ms(SCROLL_SPEED_PPS));
+        break;
+
+    case PROTO_CMD_FRAME:
+        for (uint16_t i = 0; i < frame->len && i < 8 * MAX7219_NUM_DEVICES; i++) {
+            fb_set_row(i / 8, i % 8, proto_byte(frame, i));
+        }
+        fb_swap();
+        show_mode = SHOW_HOST_FRAMES;
+        break;
+
+    case PROTO_CMD_BRIGHTNESS:
+        if (frame->len < 1) break;
+#ifdef AUTO_BRIGHTNESS
+        brightness_init(&ambient_brightness, BRIGHTNESS_MIN, proto_byte(frame, 0));
+#else
+        fb_vsync_hold();
+        max7219_set_intensity(proto_byte(frame, 0));
+        fb_vsync_release();
+#endif
+        break;
+
+#ifdef WATCH
+    case PROTO_CMD_TIME: {
+        if (frame->len < 3) break;
+        watch_time_t t = { proto_byte(frame, 0), proto_byte(frame, 1), proto_byte(frame, 2) };
+        if (t.hours < 24 && t.minutes < 60 && t.seconds < 60) {
+            rtc_set_tr(watch_time_to_bcd(&t));
+        }
+
+        // Back to the clock face, redrawn in full
+        watch_init(&watch, watch.show_seconds);
+        show_mode = SHOW_WATCH;
+        sched_set_period(show_task_id, WATCH_POLL_MS);
+        break;
+    }
+#endif
+
+    default:
+        break;
+    }
+}
+
+// Parse whatever the UART interrupts have published since the last poll.
+// This is the input-polling task: the board has no buttons, commands
+// arrive over the serial link (and the light sensor has its own task).
+void serial_task(void) {
+    proto_poll(&uart_rx, serial_command);
+}
+#endif
+
+int main(void) {
+    // Full speed system clock (CLOCK_SYSCLK_HZ, 84 MHz by default)
+    clock_set_profile(CLOCK_FULL);
+
+    // Configure the MAX7219 transport (pins and peripherals)
+    transport_init(MAX7219_DEFAULT_TRANSPORT);
+
+    // Initialize MAX7219
+    fb_init();
+    init_max7219(DISPLAY_INTENSITY);
+
+#ifdef BENCH_MODE
+    // Print the update path benchmarks on SWO before starting the display
+    bench_run();
+    init_max7219(DISPLAY_INTENSITY);
+#endif
+
+    // Frames are flipped onto the display by the vsync interrupt
+#ifdef DISPLAY_CACHE
+    fb_display_cache(1);
+#endif
+    fb_vsync_start(VSYNC_HZ);
+
+    // Glyph carousel (or marquee), the core sleeps in between
+    sched_init();
+#ifdef SERIAL_PROTO
+    // Start on the built-in content until the host sends something
+    uart_init();
+#if defined(WATCH)
+    rtc_init();
+    watch_init(&watch, WATCH_SHOW_SECONDS);
+    show_mode = SHOW_WATCH;
+    show_task_id = sched_add(show_task, WATCH_POLL_MS);
+#elif defined(SCROLL_TEXT)
+    scroller_start(&scroller, SCROLL_TEXT, 1);
+    show_mode = SHOW_SCROLL;
+    show_task_id = sched_add(show_task, scroller_period_ms(SCROLL_SPEED_PPS));
+#else
+    show_mode = SHOW_CAROUSEL;
+    show_task_id = sched_add(show_task, GLYPH_PERIOD_MS);
+#endif
+    sched_add(serial_task, SERIAL_POLL_MS);
+#elif defined(WATCH)
+    rtc_init();
+    watch_init(&watch, WATCH_SHOW_SECONDS);
+    sched_add(watch_task, WATCH_POLL_MS);
+#elif defined(GRID_COLS)
+    canvas_init(&grid_canvas, grid_buf, GRID_CANVAS_WIDTH, 8 * GRID_ROWS);
+    layout_grid(&grid_layout, GRID_COLS, GRID_ROWS, 1, GRID_ORIENT);
+    grid_text_width = canvas_text(&grid_canvas, 0, (8 * GRID_ROWS - 8) / 2, CAROUSEL_TEXT);
+    canvas_rect(&grid_canvas, 0, 0, grid_text_width, 8 * GRID_ROWS, 1, 0);
+    grid_x = -8 * GRID_COLS;
+    sched_add(grid_task, scroller_period_ms(SCROLL_SPEED_PPS));
+#elif defined(ANIMATION)
+#ifdef ANIM_FLASH_ADDR
+    spiflash_init();
+    if (anim_image_open(&anim_flash_seq, &anim_stream, &spiflash_storage, anim_stream_buf,
+                        ANIM_STREAM_CHUNK, ANIM_FLASH_ADDR)) {
+        anim_play_stream(&anim_player, &anim_flash_seq, &anim_stream, DISPLAY_INTENSITY);
+        sched_add(anim_stream_task, ANIM_STREAM_POLL_MS);
+    } else {
+        anim_play(&anim_player, &anim_demo, DISPLAY_INTENSITY);
+    }
+#else
+    anim_play(&anim_player, &anim_demo, DISPLAY_INTENSITY);
+#endif
+    sched_add(anim_task, ANIM_TICK_MS);
+#elif defined(SCROLL_TEXT)
+    scroller_start(&scroller, SCROLL_TEXT, 1);
+    sched_add(scroll_task, scroller_period_ms(SCROLL_SPEED_PPS));
+#else
+    sched_add(advance_task, GLYPH_PERIOD_MS);
+#endif
+#ifdef AUTO_BRIGHTNESS
+    light_sensor_init();
+    brightness_init(&ambient_brightness, BRIGHTNESS_MIN, DISPLAY_INTENSITY);
+    sched_add(brightness_task, BRIGHTNESS_PERIOD_MS);
+#endif
+#ifdef WATCHDOG
+    sched_add(watchdog_task, WATCHDOG_PERIOD_MS);
+    watchdog_iwdg_start(WATCHDOG_IWDG_MS);
+#endif
+#ifdef LOW_POWER
+    power_init(clock_restore);
+    sched_set_idle_hook(power_idle);
+#endif
+    sched_run();
+}
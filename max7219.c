@@ -0,0 +1,516 @@
+#include "stm32f4xx.h"
+#include "max7219.h"
+#include "clock.h"
+#include "bitslice.h"
+
+// With MAX7219_EMULATOR every pin write and SPI word is mirrored into the
+// software model in max7219_emu.c
+#ifdef MAX7219_EMULATOR
+#include "max7219_emu.h"
+#define PIN_WRITE(v) do { GPIOA->BSRR = (v); max7219_emu_bsrr(&max7219_emu, (v)); } while (0)
+#define SPI_SHADOW(word) max7219_emu_shift_word(&max7219_emu, (word))
+#else
+#define PIN_WRITE(v) (GPIOA->BSRR = (v))
+#define SPI_SHADOW(word) ((void)(word))
+#endif
+
+static volatile transport_t active_transport = TRANSPORT_BITBANG;
+
+// Frame being streamed by the DMA, one chain-wide latch per transfer.
+// frame_src is frame_buf or a caller buffer given to send_frame_ref().
+static uint16_t frame_buf[MAX7219_FRAME_WORDS];
+static const uint16_t *volatile frame_src = frame_buf;
+static volatile uint8_t frame_latches;
+static volatile uint8_t frame_pos;
+static volatile uint8_t frame_busy;
+
+// Encoded pin writes of the GPIO DMA transport, a whole frame of latches
+#define GPIO_LATCH_WORDS BITSLICE_LATCH_WORDS(2 * MAX7219_NUM_DEVICES)
+static uint32_t gpio_stream[8 * GPIO_LATCH_WORDS];
+static bitslice_t gpio_slicer;
+
+// Last value written to REG_INTENSITY
+static uint8_t current_intensity;
+
+// Bus traffic counter, two bytes per device per latch
+static volatile uint32_t bytes_sent;
+
+// Configure PA0 (DIN), PA1 (CS), PA2 (CLK) as outputs
+static void bitbang_init(void) {
+    GPIOA->MODER |= (GPIO_MODER_MODER0_0 | GPIO_MODER_MODER1_0 | GPIO_MODER_MODER2_0);
+    GPIOA->OSPEEDR |= (GPIO_OSPEEDER_OSPEEDR0_0 | GPIO_OSPEEDER_OSPEEDR1_0 | GPIO_OSPEEDER_OSPEEDR2_0);
+
+    // Initial state: CS high, CLK low, DIN low
+    PIN_WRITE(1 << CS_PIN);              // CS high
+    PIN_WRITE(1 << (CLK_PIN + 16));      // CLK low
+    PIN_WRITE(1 << (DIN_PIN + 16));      // DIN low
+}
+
+// Smallest SPI baud rate divider that keeps SCK within the MAX7219 limit
+static uint32_t spi_baud_bits(uint32_t pclk) {
+    uint32_t br = 0;
+    while (br < 7 && (pclk >> (br + 1)) > MAX7219_MAX_CLK_HZ) {
+        br++;
+    }
+    return br << SPI_CR1_BR_Pos;
+}
+
+// Configure SPI1 as a 16-bit master on PA5/PA7 and DMA2 Stream3 for TX
+static void spi_dma_init(void) {
+    RCC->APB2ENR |= RCC_APB2ENR_SPI1EN;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+    // PA1 (CS) as output, high
+    GPIOA->MODER = (GPIOA->MODER & ~GPIO_MODER_MODER1) | GPIO_MODER_MODER1_0;
+    GPIOA->OSPEEDR |= GPIO_OSPEEDER_OSPEEDR1_0;
+    PIN_WRITE(1 << CS_PIN);
+
+    // PA5 (SCK), PA7 (MOSI) as alternate function 5
+    GPIOA->MODER = (GPIOA->MODER & ~(GPIO_MODER_MODER5 | GPIO_MODER_MODER7)) |
+                   GPIO_MODER_MODER5_1 | GPIO_MODER_MODER7_1;
+    GPIOA->OSPEEDR |= (GPIO_OSPEEDER_OSPEEDR5 | GPIO_OSPEEDER_OSPEEDR7);
+    GPIOA->AFR[0] = (GPIOA->AFR[0] & ~((0xFU << (SPI_SCK_PIN * 4)) | (0xFU << (SPI_MOSI_PIN * 4)))) |
+                    (5U << (SPI_SCK_PIN * 4)) | (5U << (SPI_MOSI_PIN * 4));
+
+    // Mode 0, MSB first, 16-bit frames, software slave management
+    SPI1->CR1 = 0;
+    SPI1->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_DFF |
+                spi_baud_bits(clock_pclk2_hz());
+    SPI1->CR2 = SPI_CR2_TXDMAEN;
+    SPI1->CR1 |= SPI_CR1_SPE;
+
+    // SPI1_TX is DMA2 Stream3 Channel3, halfword memory to peripheral,
+    // stepping through the words of a latch
+    DMA2_Stream3->CR = 0;
+    while (DMA2_Stream3->CR & DMA_SxCR_EN);
+    DMA2_Stream3->PAR = (uint32_t)&SPI1->DR;
+    DMA2_Stream3->CR = (3U << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 |
+                       DMA_SxCR_MINC | DMA_SxCR_DIR_0 | DMA_SxCR_TCIE;
+
+    NVIC_SetPriority(DMA2_Stream3_IRQn, 1);
+    NVIC_EnableIRQ(DMA2_Stream3_IRQn);
+}
+
+// Wait until the last SPI word has fully left the shift register
+static void spi_wait_idle(void) {
+    while (!(SPI1->SR & SPI_SR_TXE));
+    while (SPI1->SR & SPI_SR_BSY);
+}
+
+// Start the DMA for the latch at frame_pos
+static void spi_dma_start_latch(void) {
+    PIN_WRITE(1 << (CS_PIN + 16)); // Reset CS
+    DMA2->LIFCR = DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 |
+                  DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3;
+    DMA2_Stream3->M0AR = (uint32_t)&frame_src[frame_pos * MAX7219_NUM_DEVICES];
+    DMA2_Stream3->NDTR = MAX7219_NUM_DEVICES;
+    for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+        SPI_SHADOW(frame_src[frame_pos * MAX7219_NUM_DEVICES + i]);
+    }
+    DMA2_Stream3->CR |= DMA_SxCR_EN;
+}
+
+// Latch the words that just finished and chain the next row
+void DMA2_Stream3_IRQHandler(void) {
+    if (!(DMA2->LISR & DMA_LISR_TCIF3)) {
+        return;
+    }
+    DMA2->LIFCR = DMA_LIFCR_CTCIF3;
+
+    spi_wait_idle();
+    PIN_WRITE(1 << CS_PIN); // Set CS, MAX7219 latches here
+
+    frame_pos++;
+    if (frame_pos < frame_latches) {
+        spi_dma_start_latch();
+    } else {
+        frame_busy = 0;
+    }
+}
+
+uint32_t gpio_dma_timing(uint32_t timer_hz, uint32_t bit_hz, uint32_t *slot_ticks) {
+    if (bit_hz > MAX7219_MAX_CLK_HZ) bit_hz = MAX7219_MAX_CLK_HZ;
+    if (bit_hz == 0) bit_hz = 1;
+
+    // Round the slot up so the bit rate never exceeds the request
+    uint32_t ticks = (timer_hz + 2 * bit_hz - 1) / (2 * bit_hz);
+
+    // Each slot is a CLK or CS pulse and must last tCH/tCL/tCSW
+    uint32_t min_pulse = (uint32_t)(((uint64_t)timer_hz * MAX7219_MIN_PULSE_NS + 999999999) / 1000000000);
+    if (ticks < min_pulse) ticks = min_pulse;
+    if (ticks < GPIO_DMA_MIN_SLOT_TICKS) ticks = GPIO_DMA_MIN_SLOT_TICKS;
+    if (ticks > 65536) ticks = 65536;
+
+    *slot_ticks = ticks;
+    return timer_hz / ticks / 2;
+}
+
+// TIM1 runs at PCLK2 when APB2 is not divided
+static void gpio_dma_pace(void) {
+    uint32_t ticks;
+    gpio_dma_timing(clock_pclk2_hz(), GPIO_DMA_BIT_HZ, &ticks);
+    TIM1->ARR = ticks - 1;
+}
+
+// PA0/PA1/PA2 as for the bit-bang transport, TIM1 CC1 events request
+// DMA2 Stream1 Channel6 which copies words into GPIOA->BSRR
+static void gpio_dma_init(void) {
+    static const uint8_t din[1] = { DIN_PIN };
+
+    bitbang_init();
+    bitslice_init(&gpio_slicer, din, 1, CLK_PIN);
+
+    RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+    // Compare at 0: one request at the start of every period
+    TIM1->CR1 = 0;
+    TIM1->PSC = 0;
+    gpio_dma_pace();
+    TIM1->CCR1 = 0;
+    TIM1->DIER = TIM_DIER_CC1DE;
+
+    DMA2_Stream1->CR = 0;
+    while (DMA2_Stream1->CR & DMA_SxCR_EN);
+    DMA2_Stream1->PAR = (uint32_t)&GPIOA->BSRR;
+    DMA2_Stream1->CR = (6U << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MSIZE_1 | DMA_SxCR_PSIZE_1 |
+                       DMA_SxCR_MINC | DMA_SxCR_DIR_0 | DMA_SxCR_TCIE;
+
+    NVIC_SetPriority(DMA2_Stream1_IRQn, 1);
+    NVIC_EnableIRQ(DMA2_Stream1_IRQn);
+}
+
+// Encode latches of a frame into out, returns the word count
+static uint32_t gpio_dma_encode(const uint16_t *words, uint8_t latches, uint32_t *out) {
+    uint8_t bytes[2 * MAX7219_NUM_DEVICES];
+    const uint8_t *src[1] = { bytes };
+    uint32_t n = 0;
+
+    for (uint8_t l = 0; l < latches; l++) {
+        for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+            bytes[2 * i] = words[l * MAX7219_NUM_DEVICES + i] >> 8;
+            bytes[2 * i + 1] = words[l * MAX7219_NUM_DEVICES + i] & 0xFF;
+        }
+        n += bitslice_encode_latch(&gpio_slicer, src, sizeof(bytes), CS_PIN, &out[n]);
+    }
+    return n;
+}
+
+// Stream n encoded words onto the pins, the bus stays claimed until the last one
+static void gpio_dma_start(const uint32_t *stream, uint32_t n) {
+#ifdef MAX7219_EMULATOR
+    for (uint32_t i = 0; i < n; i++) {
+        max7219_emu_bsrr(&max7219_emu, stream[i]);
+    }
+#endif
+    DMA2->LIFCR = DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 |
+                  DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1;
+    DMA2_Stream1->M0AR = (uint32_t)stream;
+    DMA2_Stream1->NDTR = n;
+    DMA2_Stream1->CR |= DMA_SxCR_EN;
+    TIM1->CNT = 0;
+    TIM1->CR1 = TIM_CR1_CEN;
+}
+
+// Last word written, stop pacing
+void DMA2_Stream1_IRQHandler(void) {
+    if (!(DMA2->LISR & DMA_LISR_TCIF1)) {
+        return;
+    }
+    DMA2->LIFCR = DMA_LIFCR_CTCIF1;
+    TIM1->CR1 = 0;
+    frame_busy = 0;
+}
+
+// Wait for the bus and mark it busy. Test and set cannot be split, or a
+// vsync or plane interrupt could start a frame in the middle of a latch
+static void bus_claim(void) {
+    for (;;) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (!frame_busy) {
+            frame_busy = 1;
+            __set_PRIMASK(primask);
+            return;
+        }
+        __set_PRIMASK(primask);
+    }
+}
+
+void transport_init(transport_t transport) {
+    // Enable clock for GPIOA
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+
+    active_transport = transport;
+#ifdef MAX7219_EMULATOR
+    max7219_emu_init(&max7219_emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+#endif
+    if (transport == TRANSPORT_SPI_DMA) {
+        spi_dma_init();
+    } else if (transport == TRANSPORT_GPIO_DMA) {
+        gpio_dma_init();
+    } else {
+        bitbang_init();
+    }
+}
+
+void transport_recalibrate(void) {
+    if (active_transport == TRANSPORT_GPIO_DMA) {
+        bus_claim();
+        gpio_dma_pace();
+        frame_busy = 0;
+        return;
+    }
+    if (active_transport != TRANSPORT_SPI_DMA) {
+        return;
+    }
+
+    // The baud rate can only change with the SPI idle and disabled
+    bus_claim();
+    spi_wait_idle();
+    SPI1->CR1 &= ~SPI_CR1_SPE;
+    SPI1->CR1 = (SPI1->CR1 & ~SPI_CR1_BR) | spi_baud_bits(clock_pclk2_hz());
+    SPI1->CR1 |= SPI_CR1_SPE;
+    frame_busy = 0;
+}
+
+transport_t transport_get(void) {
+    return active_transport;
+}
+
+uint8_t transport_busy(void) {
+    return frame_busy;
+}
+
+uint32_t transport_bytes_sent(void) {
+    return bytes_sent;
+}
+
+void transport_reset_stats(void) {
+    bytes_sent = 0;
+}
+
+// Send a byte to MAX7219
+void send_byte(uint8_t data) {
+    for (int i = 0; i < 8; i++) {
+        // Clear clock
+        PIN_WRITE(1 << (CLK_PIN + 16)); // Reset CLK
+
+        // Set data bit
+        if (data & 0x80)
+            PIN_WRITE(1 << DIN_PIN); // Set DIN
+        else
+            PIN_WRITE(1 << (DIN_PIN + 16)); // Reset DIN
+
+        // Toggle clock
+        PIN_WRITE(1 << CLK_PIN); // Set CLK
+
+        // Shift to next bit
+        data <<= 1;
+    }
+}
+
+// Shift one latch worth of words (shift order) and pulse CS. The bus is
+// held throughout, so the interrupt-driven flushes skip their turn
+static void send_latch(const uint16_t *words) {
+    bytes_sent += 2 * MAX7219_NUM_DEVICES;
+    bus_claim();
+
+    if (active_transport == TRANSPORT_SPI_DMA) {
+        // A single latch is cheaper to poll than to set up a DMA for
+        PIN_WRITE(1 << (CS_PIN + 16)); // Reset CS
+        for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+            while (!(SPI1->SR & SPI_SR_TXE));
+            SPI1->DR = words[i];
+            SPI_SHADOW(words[i]);
+        }
+        spi_wait_idle();
+        PIN_WRITE(1 << CS_PIN); // Set CS
+        frame_busy = 0;
+        return;
+    }
+
+    if (active_transport == TRANSPORT_GPIO_DMA) {
+        gpio_dma_start(gpio_stream, gpio_dma_encode(words, 1, gpio_stream));
+        while (frame_busy);
+        return;
+    }
+
+    // Select the chain (CS low)
+    PIN_WRITE(1 << (CS_PIN + 16)); // Reset CS
+
+    // Send register and data for every device
+    for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+        send_byte(words[i] >> 8);
+        send_byte(words[i] & 0xFF);
+    }
+
+    // Deselect the chain (CS high), all devices latch together
+    PIN_WRITE(1 << CS_PIN); // Set CS
+    frame_busy = 0;
+}
+
+// Send command to every MAX7219
+void send_cmd(uint8_t reg, uint8_t data) {
+    uint16_t words[MAX7219_NUM_DEVICES];
+    for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+        words[i] = MAX7219_WORD(reg, data);
+    }
+    send_latch(words);
+}
+
+void send_cmd_to(uint8_t dev, uint8_t reg, uint8_t data) {
+    if (dev >= MAX7219_NUM_DEVICES) return;
+
+    uint16_t words[MAX7219_NUM_DEVICES];
+    for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+        words[i] = MAX7219_WORD(REG_NOOP, 0x00);
+    }
+    words[MAX7219_FRAME_INDEX(0, dev)] = MAX7219_WORD(reg, data);
+    send_latch(words);
+}
+
+void send_row(uint8_t reg, const uint8_t *data) {
+    uint16_t words[MAX7219_NUM_DEVICES];
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        words[MAX7219_FRAME_INDEX(0, dev)] = MAX7219_WORD(reg, data[dev]);
+    }
+    send_latch(words);
+}
+
+void send_frame(const uint16_t *words, uint8_t latches) {
+    if (latches > 8) {
+        latches = 8;
+    }
+
+    if (active_transport == TRANSPORT_GPIO_DMA) {
+        if (latches == 0) {
+            return;
+        }
+        // The stream buffer is reused, the previous frame goes out first
+        bus_claim();
+        bytes_sent += 2 * MAX7219_NUM_DEVICES * latches;
+        gpio_dma_start(gpio_stream, gpio_dma_encode(words, latches, gpio_stream));
+        return;
+    }
+
+    if (active_transport != TRANSPORT_SPI_DMA) {
+        for (uint8_t i = 0; i < latches; i++) {
+            send_latch(&words[i * MAX7219_NUM_DEVICES]);
+        }
+        return;
+    }
+
+    if (latches == 0) {
+        return;
+    }
+
+    // The previous frame must be fully latched before its buffer is reused
+    bus_claim();
+    for (int i = 0; i < latches * MAX7219_NUM_DEVICES; i++) {
+        frame_buf[i] = words[i];
+    }
+    bytes_sent += 2 * MAX7219_NUM_DEVICES * latches;
+    frame_src = frame_buf;
+    frame_latches = latches;
+    frame_pos = 0;
+    spi_dma_start_latch();
+}
+
+void send_frame_ref(const uint16_t *words, uint8_t latches) {
+    if (latches > 8) {
+        latches = 8;
+    }
+
+    if (active_transport != TRANSPORT_SPI_DMA) {
+        send_frame(words, latches);
+        return;
+    }
+
+    if (latches == 0) {
+        return;
+    }
+
+    bus_claim();
+    bytes_sent += 2 * MAX7219_NUM_DEVICES * latches;
+    frame_src = words;
+    frame_latches = latches;
+    frame_pos = 0;
+    spi_dma_start_latch();
+}
+
+uint32_t transport_encoded_bytes(uint8_t latches) {
+    if (latches > 8) {
+        latches = 8;
+    }
+    if (active_transport == TRANSPORT_GPIO_DMA) {
+        return (uint32_t)latches * GPIO_LATCH_WORDS * sizeof(uint32_t);
+    }
+    return (uint32_t)latches * MAX7219_NUM_DEVICES * sizeof(uint16_t);
+}
+
+uint32_t transport_encode(const uint16_t *words, uint8_t latches, uint32_t *out) {
+    if (latches > 8) {
+        latches = 8;
+    }
+    if (active_transport == TRANSPORT_GPIO_DMA) {
+        gpio_dma_encode(words, latches, out);
+    } else {
+        uint16_t *dst = (uint16_t *)out;
+        for (int i = 0; i < latches * MAX7219_NUM_DEVICES; i++) {
+            dst[i] = words[i];
+        }
+    }
+    return transport_encoded_bytes(latches);
+}
+
+void send_encoded_ref(const uint32_t *stream, uint8_t latches) {
+    if (latches > 8) {
+        latches = 8;
+    }
+
+    if (active_transport != TRANSPORT_GPIO_DMA) {
+        send_frame_ref((const uint16_t *)stream, latches);
+        return;
+    }
+
+    if (latches == 0) {
+        return;
+    }
+
+    bus_claim();
+    bytes_sent += 2 * MAX7219_NUM_DEVICES * latches;
+    gpio_dma_start(stream, (uint32_t)latches * GPIO_LATCH_WORDS);
+}
+
+// Initialize MAX7219
+void init_max7219(uint8_t intensity) {
+    // Set decode mode: no decode for digits 0-7
+    send_cmd(REG_DECODE_MODE, 0x00);
+
+    // Set scan limit: all digits (0-7) enabled
+    send_cmd(REG_SCAN_LIMIT, 0x07);
+
+    // Set intensity (0x00 to 0x0F)
+    max7219_set_intensity(intensity);
+
+    // Exit shutdown mode
+    send_cmd(REG_SHUTDOWN, 0x01);
+
+    // Exit display test
+    send_cmd(REG_DISPLAY_TEST, 0x00);
+
+    // Clear display
+    for (int i = 1; i <= 8; i++) {
+        send_cmd(i, 0x00);
+    }
+}
+
+void max7219_set_intensity(uint8_t intensity) {
+    current_intensity = intensity & 0x0F;
+    send_cmd(REG_INTENSITY, current_intensity);
+}
+
+uint8_t max7219_get_intensity(void) {
+    return current_intensity;
+}
@@ -0,0 +1,135 @@
+#ifndef MAX7219_H
+#define MAX7219_H
+
+#include <stdint.h>
+
+// MAX7219 registers
+#define REG_NOOP        0x00
+#define REG_DIGIT0      0x01
+#define REG_DIGIT1      0x02
+#define REG_DIGIT2      0x03
+#define REG_DIGIT3      0x04
+#define REG_DIGIT4      0x05
+#define REG_DIGIT5      0x06
+#define REG_DIGIT6      0x07
+#define REG_DIGIT7      0x08
+#define REG_DECODE_MODE 0x09
+#define REG_INTENSITY   0x0A
+#define REG_SCAN_LIMIT  0x0B
+#define REG_SHUTDOWN    0x0C
+#define REG_DISPLAY_TEST 0x0F
+
+// Pin definitions based on the schematic (bit-bang transport)
+#define DIN_PIN     0  // PA0 connected to DIN
+#define CS_PIN      1  // PA1 connected to LOAD/CS
+#define CLK_PIN     2  // PA2 connected to CLK
+
+// Pin definitions for the SPI1 transport (CS stays on PA1)
+#define SPI_SCK_PIN     5  // PA5 (SPI1_SCK) connected to CLK
+#define SPI_MOSI_PIN    7  // PA7 (SPI1_MOSI) connected to DIN
+
+// Fastest serial clock the MAX7219 accepts
+#define MAX7219_MAX_CLK_HZ  10000000
+
+// Shortest CLK high, CLK low and CS high time (tCH, tCL, tCSW)
+#define MAX7219_MIN_PULSE_NS 50
+
+// Bit clock of the timer-paced GPIO DMA transport. Every BSRR word
+// lasts one TIM1 period and a bit takes two words.
+#ifndef GPIO_DMA_BIT_HZ
+#define GPIO_DMA_BIT_HZ 2000000
+#endif
+
+// Fewest timer ticks per word: DMA2 needs about this many AHB cycles to
+// fetch and write one word while other streams are active
+#define GPIO_DMA_MIN_SLOT_TICKS 12
+
+// Number of cascaded modules (DOUT of one feeds DIN of the next).
+// Device 0 is the module wired to the MCU.
+#ifndef MAX7219_NUM_DEVICES
+#define MAX7219_NUM_DEVICES 1
+#endif
+
+// A frame is up to eight latches of one word per device
+#define MAX7219_FRAME_WORDS (8 * MAX7219_NUM_DEVICES)
+
+// Position of (latch, device) in a frame. Words are stored in shift order:
+// the word for the last device in the chain goes out first.
+#define MAX7219_FRAME_INDEX(latch, dev) \
+    ((latch) * MAX7219_NUM_DEVICES + (MAX7219_NUM_DEVICES - 1 - (dev)))
+
+// Transport used when the firmware does not pick one
+#ifndef MAX7219_DEFAULT_TRANSPORT
+#define MAX7219_DEFAULT_TRANSPORT TRANSPORT_BITBANG
+#endif
+
+// Pack a register/data pair into the 16-bit word shifted out on the wire
+#define MAX7219_WORD(reg, data) ((uint16_t)(((reg) << 8) | (data)))
+
+typedef enum {
+    TRANSPORT_BITBANG,  // GPIO toggling on PA0/PA1/PA2
+    TRANSPORT_SPI_DMA,  // SPI1 on PA5/PA7, frames fed by DMA2 Stream3
+    TRANSPORT_GPIO_DMA  // PA0/PA1/PA2 written by DMA2 Stream1, paced by TIM1
+} transport_t;
+
+// Timer ticks per word for a GPIO DMA bit rate within the MAX7219 and
+// DMA limits, never faster than bit_hz. Returns the bit rate it gives.
+uint32_t gpio_dma_timing(uint32_t timer_hz, uint32_t bit_hz, uint32_t *slot_ticks);
+
+// Configure the pins and peripherals for the given transport
+void transport_init(transport_t transport);
+
+// Rescale the SPI clock or the GPIO DMA pacing after SystemCoreClock changed
+void transport_recalibrate(void);
+
+// Currently selected transport
+transport_t transport_get(void);
+
+// Non-zero while a DMA frame is still being shifted out
+uint8_t transport_busy(void);
+
+// Bytes shifted onto the bus since boot or the last reset
+uint32_t transport_bytes_sent(void);
+void transport_reset_stats(void);
+
+// Send a byte to MAX7219 (bit-bang only)
+void send_byte(uint8_t data);
+
+// Send the same command to every MAX7219 in the chain
+void send_cmd(uint8_t reg, uint8_t data);
+
+// Send a command to one device, the others receive REG_NOOP
+void send_cmd_to(uint8_t dev, uint8_t reg, uint8_t data);
+
+// Write register reg on every device in one latch, data[dev] per device
+void send_row(uint8_t reg, const uint8_t *data);
+
+// Send a frame of latches * MAX7219_NUM_DEVICES words laid out with
+// MAX7219_FRAME_INDEX. With the DMA transports this returns as soon as
+// the DMA is started.
+void send_frame(const uint16_t *words, uint8_t latches);
+
+// Same as send_frame() but the DMA reads straight from words, which must
+// stay unchanged until transport_busy() returns 0
+void send_frame_ref(const uint16_t *words, uint8_t latches);
+
+// Wire form of a frame for the active transport, what its DMA reads:
+// the frame words themselves for SPI and bit-bang, the BSRR pin writes
+// for GPIO DMA. transport_encode() writes transport_encoded_bytes() bytes
+// to out and returns that count. An encoding is only valid for the
+// transport that was active when it was made.
+uint32_t transport_encoded_bytes(uint8_t latches);
+uint32_t transport_encode(const uint16_t *words, uint8_t latches, uint32_t *out);
+
+// Send an encoded frame. The DMA transports read straight from stream,
+// which must stay unchanged until transport_busy() returns 0.
+void send_encoded_ref(const uint32_t *stream, uint8_t latches);
+
+// Initialize MAX7219
+void init_max7219(uint8_t intensity);
+
+// Change the brightness of every device (0x00 to 0x0F)
+void max7219_set_intensity(uint8_t intensity);
+uint8_t max7219_get_intensity(void);
+
+#endif
@@ -0,0 +1,130 @@
+#include "max7219_emu.h"
+
+max7219_emu_t max7219_emu;
+
+// Code B font of the decode mode: segments DP A B C D E F G in bits 7-0
+static const uint8_t code_b[16] = {
+    0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70,  // 0-7
+    0x7F, 0x7B, 0x01, 0x4F, 0x37, 0x0E, 0x67, 0x00   // 8, 9, -, E, H, L, P, blank
+};
+
+void max7219_emu_init(max7219_emu_t *emu, uint8_t din_pin, uint8_t clk_pin,
+                      uint8_t cs_pin, uint8_t num_devices) {
+    if (num_devices > MAX7219_EMU_MAX_DEVICES) {
+        num_devices = MAX7219_EMU_MAX_DEVICES;
+    }
+
+    emu->din_pin = din_pin;
+    emu->clk_pin = clk_pin;
+    emu->cs_pin = cs_pin;
+    emu->num_devices = num_devices;
+    emu->pins = (1U << cs_pin);
+    emu->clocks = 0;
+    emu->latches = 0;
+    emu->writes = 0;
+
+    for (int dev = 0; dev < MAX7219_EMU_MAX_DEVICES; dev++) {
+        max7219_regs_t *r = &emu->regs[dev];
+        emu->shift[dev] = 0;
+        for (int i = 0; i < 8; i++) {
+            r->digits[i] = 0x00;
+        }
+        r->decode_mode = 0x00;
+        r->intensity = 0x00;
+        r->scan_limit = 0x00;
+        r->shutdown = 0x00;
+        r->display_test = 0x00;
+    }
+}
+
+// One CLK rising edge: every register shifts left, the MSB of each one
+// feeds the next device (DOUT -> DIN)
+static void clock_in(max7219_emu_t *emu, uint8_t bit) {
+    for (int dev = 0; dev < emu->num_devices; dev++) {
+        uint8_t out = emu->shift[dev] >> 15;
+        emu->shift[dev] = (uint16_t)((emu->shift[dev] << 1) | bit);
+        bit = out;
+    }
+    emu->clocks++;
+}
+
+// CS rising edge: every device executes the word it holds
+static void latch(max7219_emu_t *emu) {
+    for (int dev = 0; dev < emu->num_devices; dev++) {
+        max7219_regs_t *r = &emu->regs[dev];
+        uint8_t addr = (emu->shift[dev] >> 8) & 0x0F;
+        uint8_t data = emu->shift[dev] & 0xFF;
+
+        switch (addr) {
+        case 0x00:
+            continue;
+        case 0x09:
+            r->decode_mode = data;
+            break;
+        case 0x0A:
+            r->intensity = data & 0x0F;
+            break;
+        case 0x0B:
+            r->scan_limit = data & 0x07;
+            break;
+        case 0x0C:
+            r->shutdown = data & 0x01;
+            break;
+        case 0x0F:
+            r->display_test = data & 0x01;
+            break;
+        default:
+            if (addr >= 0x01 && addr <= 0x08) {
+                r->digits[addr - 1] = data;
+            }
+            break;
+        }
+        emu->writes++;
+    }
+    emu->latches++;
+}
+
+void max7219_emu_bsrr(max7219_emu_t *emu, uint32_t bsrr) {
+    uint32_t old = emu->pins;
+    uint32_t pins = (old & ~(bsrr >> 16)) | (bsrr & 0xFFFF);
+    emu->pins = pins;
+
+    uint32_t clk = 1U << emu->clk_pin;
+    uint32_t cs = 1U << emu->cs_pin;
+
+    if (!(old & clk) && (pins & clk)) {
+        clock_in(emu, (pins >> emu->din_pin) & 1);
+    }
+    if (!(old & cs) && (pins & cs)) {
+        latch(emu);
+    }
+}
+
+void max7219_emu_shift_word(max7219_emu_t *emu, uint16_t word) {
+    for (int i = 15; i >= 0; i--) {
+        clock_in(emu, (word >> i) & 1);
+    }
+}
+
+uint8_t max7219_emu_row(const max7219_emu_t *emu, uint8_t dev, uint8_t row) {
+    if (dev >= emu->num_devices || row >= 8) return 0x00;
+
+    const max7219_regs_t *r = &emu->regs[dev];
+    if (r->display_test) return 0xFF;
+    if (!r->shutdown) return 0x00;
+    if (row > r->scan_limit) return 0x00;
+
+    uint8_t data = r->digits[row];
+    if (r->decode_mode & (1 << row)) {
+        data = (data & 0x80) | code_b[data & 0x0F];
+    }
+    return data;
+}
+
+void max7219_emu_capture(const max7219_emu_t *emu, uint8_t rows[][8]) {
+    for (int dev = 0; dev < emu->num_devices; dev++) {
+        for (int row = 0; row < 8; row++) {
+            rows[dev][row] = max7219_emu_row(emu, dev, row);
+        }
+    }
+}
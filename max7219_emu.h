@@ -0,0 +1,62 @@
+#ifndef MAX7219_EMU_H
+#define MAX7219_EMU_H
+
+#include <stdint.h>
+
+// Software model of a MAX7219 chain fed with the same GPIO writes the
+// driver makes. The host tests attach it to the register model of
+// tests/hw.c; with MAX7219_EMULATOR defined the driver also mirrors every
+// pin write and SPI word into max7219_emu.
+
+// Longest chain the model can hold
+#define MAX7219_EMU_MAX_DEVICES 16
+
+// Register file of one device
+typedef struct {
+    uint8_t digits[8];
+    uint8_t decode_mode;
+    uint8_t intensity;
+    uint8_t scan_limit;
+    uint8_t shutdown;       // 0 = shutdown, 1 = normal operation
+    uint8_t display_test;
+} max7219_regs_t;
+
+typedef struct {
+    uint8_t din_pin;
+    uint8_t clk_pin;
+    uint8_t cs_pin;
+    uint8_t num_devices;
+    uint32_t pins;          // Current level of the port pins
+
+    // 16-bit shift register of every device, device 0 is fed by DIN
+    uint16_t shift[MAX7219_EMU_MAX_DEVICES];
+    max7219_regs_t regs[MAX7219_EMU_MAX_DEVICES];
+
+    // Activity counters
+    uint32_t clocks;        // CLK rising edges
+    uint32_t latches;       // CS rising edges
+    uint32_t writes;        // Register writes that were not NOOP
+} max7219_emu_t;
+
+// Instance the driver mirrors into when built with MAX7219_EMULATOR
+extern max7219_emu_t max7219_emu;
+
+// Power-on state: shutdown, no decode, registers cleared
+void max7219_emu_init(max7219_emu_t *emu, uint8_t din_pin, uint8_t clk_pin,
+                      uint8_t cs_pin, uint8_t num_devices);
+
+// Apply a write to the port's BSRR register (set in bits 0-15,
+// reset in bits 16-31, set wins when both are given)
+void max7219_emu_bsrr(max7219_emu_t *emu, uint32_t bsrr);
+
+// Shift a whole 16-bit word in, MSB first, as the SPI peripheral does
+void max7219_emu_shift_word(max7219_emu_t *emu, uint16_t word);
+
+// Lit pixels of one row as the device shows it, after display test,
+// shutdown, scan limit and Code B decode. Bit 7 is the leftmost column.
+uint8_t max7219_emu_row(const max7219_emu_t *emu, uint8_t dev, uint8_t row);
+
+// Copy the visible rows of every device, rows[dev][row]
+void max7219_emu_capture(const max7219_emu_t *emu, uint8_t rows[][8]);
+
+#endif
@@ -0,0 +1,140 @@
+#include "stm32f4xx.h"
+#include "power.h"
+#include "rtc.h"
+#include "sched.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "spiflash.h"
+
+static power_resume_fn_t resume_clock;
+static power_stats_t stats;
+static uint64_t stats_start_us;
+
+// Devices currently blanked through REG_SHUTDOWN
+static uint8_t module_off[MAX7219_NUM_DEVICES];
+
+void power_init(power_resume_fn_t resume) {
+    resume_clock = resume;
+    rtc_init();
+
+    // Low-power regulator in STOP, wake into STOP (not STANDBY)
+    PWR->CR = (PWR->CR & ~PWR_CR_PDDS) | PWR_CR_LPDS | PWR_CR_FPDS;
+
+    power_reset_stats();
+}
+
+// Called with interrupts masked
+static void enter_sleep(void) {
+    uint64_t start = sched_time_us();
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    __WFI();
+    stats.us[POWER_SLEEP] += sched_time_us() - start;
+}
+
+static void enter_stop(uint32_t ms) {
+    // Wake a little early, the clock restart eats into the budget
+    uint32_t stop_ms = ms - 1;
+    if (stop_ms > RTC_WAKEUP_MAX_MS) stop_ms = RTC_WAKEUP_MAX_MS;
+
+    uint32_t start = rtc_ticks();
+    rtc_wakeup_start(stop_ms);
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    __WFI();
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    // Back on HSI: restore the PLL before anything depends on the clock
+    if (resume_clock) {
+        resume_clock();
+    }
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    // The wakeup timer means the whole period went by. Any other wakeup
+    // (a button, the UART) cut it short: the RTC says by how much.
+    uint32_t slept_ms = stop_ms;
+    if (!rtc_wakeup_fired()) {
+        slept_ms = rtc_elapsed_ms(start, rtc_ticks());
+        if (slept_ms > stop_ms) slept_ms = stop_ms;
+    }
+    sched_advance(slept_ms);
+    stats.us[POWER_STOP] += (uint64_t)slept_ms * 1000;
+    rtc_wakeup_stop();
+    rtc_wakeup_clear();
+    stats.stop_entries++;
+}
+
+void power_idle(uint32_t ms) {
+    // DMA stops in STOP, a frame or flash read in flight needs SLEEP
+    if (ms >= POWER_STOP_MIN_MS && !fb_flip_pending_get() && !transport_busy() &&
+        !spiflash_busy()) {
+        enter_stop(ms);
+    } else {
+        enter_sleep();
+    }
+}
+
+void power_module_enable(uint8_t dev, uint8_t on) {
+    if (dev >= MAX7219_NUM_DEVICES) return;
+    module_off[dev] = !on;
+    fb_vsync_hold();
+    send_cmd_to(dev, REG_SHUTDOWN, on ? 0x01 : 0x00);
+    fb_vsync_release();
+}
+
+void power_display_enable(uint8_t on) {
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        module_off[dev] = !on;
+    }
+    fb_vsync_hold();
+    send_cmd(REG_SHUTDOWN, on ? 0x01 : 0x00);
+    fb_vsync_release();
+}
+
+uint8_t power_modules_on(void) {
+    uint8_t on = 0;
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        if (!module_off[dev]) on++;
+    }
+    return on;
+}
+
+uint8_t power_module_is_on(uint8_t dev) {
+    return dev < MAX7219_NUM_DEVICES && !module_off[dev];
+}
+
+void power_get_stats(power_stats_t *out) {
+    uint64_t total = sched_time_us() - stats_start_us;
+    *out = stats;
+
+    // Run time is what is left. sched_advance() already put the STOP
+    // periods on the scheduler clock, so they come off as well.
+    uint64_t idle = stats.us[POWER_SLEEP] + stats.us[POWER_STOP];
+    out->us[POWER_RUN] = total > idle ? total - idle : 0;
+}
+
+void power_reset_stats(void) {
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        stats.us[i] = 0;
+    }
+    stats.stop_entries = 0;
+    stats_start_us = sched_time_us();
+}
+
+uint32_t power_model_current_ua(const power_stats_t *s, uint8_t modules_on,
+                                uint16_t lit_pixels, uint8_t intensity) {
+    uint64_t total = s->us[POWER_RUN] + s->us[POWER_SLEEP] + s->us[POWER_STOP];
+    if (total == 0) return 0;
+
+    uint64_t mcu = (s->us[POWER_RUN] * POWER_MCU_RUN_UA +
+                    s->us[POWER_SLEEP] * POWER_MCU_SLEEP_UA +
+                    s->us[POWER_STOP] * POWER_MCU_STOP_UA) / total;
+
+    // A lit LED gets the peak current for (2 * intensity + 1) / 32 of
+    // its digit slot, which is one of the 8 scanned digits
+    uint8_t modules_off = MAX7219_NUM_DEVICES - modules_on;
+    uint64_t leds = (uint64_t)lit_pixels * POWER_SEGMENT_PEAK_UA * (2 * (intensity & 0x0F) + 1) / (32 * 8);
+    uint64_t display = (uint64_t)modules_on * POWER_MAX7219_ON_UA +
+                       (uint64_t)modules_off * POWER_MAX7219_OFF_UA + leds;
+
+    return (uint32_t)(mcu + display);
+}
@@ -0,0 +1,63 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+// Power states of the MCU
+typedef enum {
+    POWER_RUN,
+    POWER_SLEEP,    // Core clock gated, peripherals and SysTick running
+    POWER_STOP,     // All clocks stopped until the RTC wakeup timer or an EXTI line
+    POWER_STATE_COUNT
+} power_state_t;
+
+// Idle periods shorter than this stay in SLEEP: STOP costs a clock
+// restart (PLL lock) on every wakeup
+#define POWER_STOP_MIN_MS 20
+
+// Typical supply currents of the energy model, in microamps.
+// MCU figures are STM32F401 at 84 MHz from the datasheet, MAX7219 ones
+// from its datasheet with RSET = 10k (about 40 mA peak segment current).
+#define POWER_MCU_RUN_UA        12000
+#define POWER_MCU_SLEEP_UA      5000
+#define POWER_MCU_STOP_UA       50
+#define POWER_MAX7219_ON_UA     8000    // Operating, all segments off
+#define POWER_MAX7219_OFF_UA    150     // REG_SHUTDOWN = 0
+#define POWER_SEGMENT_PEAK_UA   40000
+
+// Time spent in each state since power_init() or the last reset
+typedef struct {
+    uint64_t us[POWER_STATE_COUNT];
+    uint32_t stop_entries;
+} power_stats_t;
+
+// Clock restore after STOP (the MCU wakes on HSI with the PLL off)
+typedef void (*power_resume_fn_t)(void);
+
+// Set up the RTC wakeup and remember how to restore the clocks
+void power_init(power_resume_fn_t resume);
+
+// Scheduler idle hook: SLEEP, or STOP when the next task is far enough
+// away and no frame is waiting for the bus
+void power_idle(uint32_t ms);
+
+// Blank or wake one module through REG_SHUTDOWN, or the whole chain
+void power_module_enable(uint8_t dev, uint8_t on);
+void power_display_enable(uint8_t on);
+
+// Number of modules not blanked, and whether one module is
+uint8_t power_modules_on(void);
+uint8_t power_module_is_on(uint8_t dev);
+
+// Copy and clear the time accounting, run time includes everything
+// that was not SLEEP or STOP
+void power_get_stats(power_stats_t *stats);
+void power_reset_stats(void);
+
+// Energy model: average supply current in microamps for the time shares
+// in stats, with lit_pixels lit on average at intensity (0-15) on the
+// enabled modules
+uint32_t power_model_current_ua(const power_stats_t *stats, uint8_t modules_on,
+                                uint16_t lit_pixels, uint8_t intensity);
+
+#endif
@@ -0,0 +1,109 @@
+#include "proto.h"
+
+static proto_stats_t stats;
+
+// CRC-16/CCITT (0x1021) one nibble at a time, 32 bytes of table
+static const uint16_t crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t proto_crc16(uint16_t crc, uint8_t data) {
+    crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (data >> 4)]);
+    crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (data & 0x0F)]);
+    return crc;
+}
+
+uint8_t proto_poll(ring_t *ring, proto_handler_t handler) {
+    uint8_t handled = 0;
+
+    while (1) {
+        uint32_t avail = ring_count(ring);
+
+        // Resynchronize on the next sync byte
+        if (avail == 0) break;
+        if (ring_peek(ring, 0) != PROTO_SYNC) {
+            ring_consume(ring, 1);
+            stats.dropped++;
+            continue;
+        }
+        if (avail < PROTO_HEADER_LEN) break;
+
+        uint8_t type = ring_peek(ring, 1);
+        uint16_t len = ring_peek(ring, 2) | ((uint16_t)ring_peek(ring, 3) << 8);
+        uint16_t total = PROTO_HEADER_LEN + len + PROTO_CRC_LEN;
+
+        // An impossible length means this was not a real sync byte
+        if (len > PROTO_MAX_PAYLOAD || total > ring->mask) {
+            ring_consume(ring, 1);
+            stats.dropped++;
+            continue;
+        }
+        if (avail < total) break;
+
+        // Check the CRC in place
+        uint16_t crc = 0xFFFF;
+        for (uint16_t i = 1; i < PROTO_HEADER_LEN + len; i++) {
+            crc = proto_crc16(crc, ring_peek(ring, i));
+        }
+        uint16_t sent = ring_peek(ring, total - 2) | ((uint16_t)ring_peek(ring, total - 1) << 8);
+        if (crc != sent) {
+            ring_consume(ring, 1);
+            stats.crc_errors++;
+            continue;
+        }
+
+        proto_frame_t frame = {
+            .ring = ring,
+            .start = PROTO_HEADER_LEN,
+            .len = len,
+            .type = type,
+        };
+        stats.frames++;
+        handler(&frame);
+        handled++;
+
+        ring_consume(ring, total);
+    }
+    return handled;
+}
+
+uint8_t proto_byte(const proto_frame_t *frame, uint16_t i) {
+    return ring_peek(frame->ring, frame->start + i);
+}
+
+uint16_t proto_copy(const proto_frame_t *frame, uint8_t *dst, uint16_t max) {
+    uint16_t n = frame->len < max ? frame->len : max;
+    for (uint16_t i = 0; i < n; i++) {
+        dst[i] = proto_byte(frame, i);
+    }
+    return n;
+}
+
+uint16_t proto_encode(uint8_t type, const uint8_t *payload, uint16_t len, uint8_t *out) {
+    uint16_t crc = 0xFFFF;
+
+    out[0] = PROTO_SYNC;
+    out[1] = type;
+    out[2] = (uint8_t)len;
+    out[3] = (uint8_t)(len >> 8);
+    for (uint16_t i = 0; i < len; i++) {
+        out[PROTO_HEADER_LEN + i] = payload[i];
+    }
+    for (uint16_t i = 1; i < PROTO_HEADER_LEN + len; i++) {
+        crc = proto_crc16(crc, out[i]);
+    }
+    out[PROTO_HEADER_LEN + len] = (uint8_t)crc;
+    out[PROTO_HEADER_LEN + len + 1] = (uint8_t)(crc >> 8);
+    return PROTO_HEADER_LEN + len + PROTO_CRC_LEN;
+}
+
+void proto_get_stats(proto_stats_t *out) {
+    *out = stats;
+}
+
+void proto_reset_stats(void) {
+    stats.frames = 0;
+    stats.crc_errors = 0;
+    stats.dropped = 0;
+}
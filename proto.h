@@ -0,0 +1,61 @@
+#ifndef PROTO_H
+#define PROTO_H
+
+#include <stdint.h>
+#include "ring.h"
+
+// Binary command framing on the serial link, little endian:
+//   0xA5 type len_lo len_hi payload[len] crc_lo crc_hi
+// The CRC is CRC-16/CCITT-FALSE over type, length and payload.
+// tests/test_proto.c feeds the parser from a pty.
+#define PROTO_SYNC        0xA5
+#define PROTO_HEADER_LEN  4
+#define PROTO_CRC_LEN     2
+#define PROTO_MAX_PAYLOAD 256
+
+// Command types
+#define PROTO_CMD_TEXT       0x01   // UTF-8 message to scroll, no NUL
+#define PROTO_CMD_FRAME      0x02   // 8 row bytes per device, device 0 first
+#define PROTO_CMD_BRIGHTNESS 0x03   // One byte, intensity 0x00 to 0x0F
+#define PROTO_CMD_TIME       0x04   // Hours, minutes, seconds, one byte each
+
+// A complete frame, still in place in the ring. Only valid inside the
+// handler, the bytes are released when it returns.
+typedef struct {
+    const ring_t *ring;
+    uint16_t start;         // Offset of the first payload byte from the tail
+    uint16_t len;
+    uint8_t type;
+} proto_frame_t;
+
+typedef void (*proto_handler_t)(const proto_frame_t *frame);
+
+// Link statistics
+typedef struct {
+    uint32_t frames;
+    uint32_t crc_errors;
+    uint32_t dropped;       // Bytes skipped while looking for a sync byte
+} proto_stats_t;
+
+// Parse everything the producer has published, call handler for each
+// valid frame and leave a partial frame in the ring. The parser is the
+// ring's consumer. Returns frames handled.
+uint8_t proto_poll(ring_t *ring, proto_handler_t handler);
+
+// Payload byte i of a frame, wrapping around the end of the ring
+uint8_t proto_byte(const proto_frame_t *frame, uint16_t i);
+
+// Copy up to max payload bytes out, returns the number copied
+uint16_t proto_copy(const proto_frame_t *frame, uint8_t *dst, uint16_t max);
+
+// CRC-16/CCITT-FALSE, crc starts at 0xFFFF
+uint16_t proto_crc16(uint16_t crc, uint8_t data);
+
+// Build a frame into out (PROTO_HEADER_LEN + len + PROTO_CRC_LEN bytes),
+// for the host side and loopback tests. Returns the frame length.
+uint16_t proto_encode(uint8_t type, const uint8_t *payload, uint16_t len, uint8_t *out);
+
+void proto_get_stats(proto_stats_t *stats);
+void proto_reset_stats(void);
+
+#endif
@@ -0,0 +1,87 @@
+#include "ring.h"
+
+uint8_t ring_init(ring_t *r, uint8_t *buf, uint32_t size) {
+    if (size == 0 || (size & (size - 1)) != 0) return 0;
+
+    r->buf = buf;
+    r->mask = size - 1;
+    atomic_store_explicit(&r->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, 0, memory_order_relaxed);
+    return 1;
+}
+
+// The producer owns head, so it reads its own copy relaxed and only needs
+// acquire on tail to see the consumer's reads completed
+uint32_t ring_space(const ring_t *r) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return r->mask + 1 - (head - tail);
+}
+
+uint8_t ring_push(ring_t *r, uint8_t data) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail > r->mask) return 0;
+
+    r->buf[head & r->mask] = data;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return 1;
+}
+
+uint32_t ring_write(ring_t *r, const uint8_t *data, uint32_t len) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t space = r->mask + 1 - (head - tail);
+    if (len > space) len = space;
+
+    for (uint32_t i = 0; i < len; i++) {
+        r->buf[(head + i) & r->mask] = data[i];
+    }
+    // One release for the whole block
+    atomic_store_explicit(&r->head, head + len, memory_order_release);
+    return len;
+}
+
+void ring_produced(ring_t *r, uint32_t n) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + n, memory_order_release);
+}
+
+uint32_t ring_count(const ring_t *r) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    return head - tail;
+}
+
+uint8_t ring_pop(ring_t *r, uint8_t *data) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (head == tail) return 0;
+
+    *data = r->buf[tail & r->mask];
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+uint32_t ring_read(ring_t *r, uint8_t *dst, uint32_t max) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint32_t n = head - tail;
+    if (n > max) n = max;
+
+    for (uint32_t i = 0; i < n; i++) {
+        dst[i] = r->buf[(tail + i) & r->mask];
+    }
+    atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+    return n;
+}
+
+uint8_t ring_peek(const ring_t *r, uint32_t i) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    return r->buf[(tail + i) & r->mask];
+}
+
+void ring_consume(ring_t *r, uint32_t n) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+}
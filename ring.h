@@ -0,0 +1,41 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Lock-free single-producer/single-consumer byte ring. One side (an ISR
+// or a DMA completion handler) only moves head, the other (the main loop)
+// only moves tail, so no interrupt masking is needed. head and tail count
+// bytes forever and wrap at 2^32; the buffer index is count & mask.
+// Publishing uses release stores and observing uses acquire loads, which
+// on the Cortex-M4 become a DMB next to a plain 32-bit load or store.
+// tests/test_ring.c and bench_ring.c run it between real threads.
+typedef struct {
+    uint8_t *buf;
+    uint32_t mask;              // size - 1, size is a power of two
+    _Atomic uint32_t head;      // Written by the producer only
+    _Atomic uint32_t tail;      // Written by the consumer only
+} ring_t;
+
+// Attach a buffer, returns 0 if size is not a power of two
+uint8_t ring_init(ring_t *r, uint8_t *buf, uint32_t size);
+
+// Producer side
+uint32_t ring_space(const ring_t *r);
+uint8_t ring_push(ring_t *r, uint8_t data);     // 0 when full
+uint32_t ring_write(ring_t *r, const uint8_t *data, uint32_t len);
+
+// Publish n bytes already placed in the buffer by someone else (DMA)
+void ring_produced(ring_t *r, uint32_t n);
+
+// Consumer side
+uint32_t ring_count(const ring_t *r);
+uint8_t ring_pop(ring_t *r, uint8_t *data);     // 0 when empty
+uint32_t ring_read(ring_t *r, uint8_t *dst, uint32_t max);
+
+// Zero-copy access: byte i past the tail, and release n bytes
+uint8_t ring_peek(const ring_t *r, uint32_t i);
+void ring_consume(ring_t *r, uint32_t n);
+
+#endif
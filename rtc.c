@@ -0,0 +1,139 @@
+#include "stm32f4xx.h"
+#include "rtc.h"
+
+// Synchronous prescaler: the subsecond counter steps at RTC_TICK_HZ
+#define RTC_PREDIV_S (RTC_TICK_HZ - 1)
+#define RTC_TICKS_PER_DAY (86400UL * RTC_TICK_HZ)
+
+// Unlock or relock the RTC registers
+static void rtc_unlock(void) {
+    RTC->WPR = 0xCA;
+    RTC->WPR = 0x53;
+}
+
+static void rtc_lock(void) {
+    RTC->WPR = 0xFF;
+}
+
+void rtc_init(void) {
+    // Backup domain access
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    PWR->CR |= PWR_CR_DBP;
+
+    // LSE on, RTC clocked from it
+    RCC->BDCR |= RCC_BDCR_LSEON;
+    while (!(RCC->BDCR & RCC_BDCR_LSERDY));
+    if (!(RCC->BDCR & RCC_BDCR_RTCEN)) {
+        RCC->BDCR = (RCC->BDCR & ~RCC_BDCR_RTCSEL) | RCC_BDCR_RTCSEL_0 | RCC_BDCR_RTCEN;
+    }
+
+    // 32768 / (127 + 1) / (255 + 1) = 1 Hz calendar, only set on first boot
+    if (!(RTC->ISR & RTC_ISR_INITS)) {
+        rtc_unlock();
+        RTC->ISR |= RTC_ISR_INIT;
+        while (!(RTC->ISR & RTC_ISR_INITF));
+        RTC->PRER = (127U << 16) | RTC_PREDIV_S;
+        RTC->ISR &= ~RTC_ISR_INIT;
+        rtc_lock();
+    }
+
+    // Wakeup interrupt arrives through EXTI line 22, rising edge
+    EXTI->IMR |= (1U << 22);
+    EXTI->RTSR |= (1U << 22);
+    NVIC_EnableIRQ(RTC_WKUP_IRQn);
+}
+
+uint32_t rtc_get_tr(void) {
+    // Reading TR freezes the shadow registers until DR is read
+    uint32_t tr = RTC->TR;
+    (void)RTC->DR;
+    return tr & (RTC_TR_HT | RTC_TR_HU | RTC_TR_MNT | RTC_TR_MNU | RTC_TR_ST | RTC_TR_SU);
+}
+
+void rtc_set_tr(uint32_t tr) {
+    rtc_unlock();
+    RTC->ISR |= RTC_ISR_INIT;
+    while (!(RTC->ISR & RTC_ISR_INITF));
+    RTC->TR = tr;
+    if (!(RTC->ISR & RTC_ISR_INITS)) {
+        // Monday 2001-01-01, INITS needs a non-zero year
+        RTC->DR = (1U << RTC_DR_WDU_Pos) | (1U << RTC_DR_YU_Pos) |
+                  (1U << RTC_DR_MU_Pos) | (1U << RTC_DR_DU_Pos);
+    }
+    RTC->ISR &= ~RTC_ISR_INIT;
+
+    // Shadow registers catch up on the next RTCCLK edge
+    RTC->ISR &= ~RTC_ISR_RSF;
+    while (!(RTC->ISR & RTC_ISR_RSF));
+    rtc_lock();
+}
+
+// Two BCD digits in the low byte
+static uint32_t bcd_byte(uint32_t bcd) {
+    return ((bcd >> 4) & 0x0F) * 10 + (bcd & 0x0F);
+}
+
+uint32_t rtc_ticks(void) {
+    // The shadow registers are stale after STOP until the next resync
+    rtc_unlock();
+    RTC->ISR &= ~RTC_ISR_RSF;
+    rtc_lock();
+    while (!(RTC->ISR & RTC_ISR_RSF));
+
+    // Reading SSR freezes TR until DR is read. SSR counts down.
+    uint32_t ssr = RTC->SSR & RTC_SSR_SS;
+    uint32_t tr = RTC->TR;
+    (void)RTC->DR;
+
+    tr &= RTC_TR_HT | RTC_TR_HU | RTC_TR_MNT | RTC_TR_MNU | RTC_TR_ST | RTC_TR_SU;
+    uint32_t seconds = (bcd_byte(tr >> 16) * 60 + bcd_byte(tr >> 8)) * 60 + bcd_byte(tr);
+    if (ssr > RTC_PREDIV_S) ssr = RTC_PREDIV_S;
+
+    return seconds * RTC_TICK_HZ + (RTC_PREDIV_S - ssr);
+}
+
+uint32_t rtc_elapsed_ms(uint32_t start, uint32_t end) {
+    uint32_t ticks = end >= start ? end - start : end + RTC_TICKS_PER_DAY - start;
+    return (uint32_t)((uint64_t)ticks * 1000 / RTC_TICK_HZ);
+}
+
+void rtc_wakeup_start(uint32_t ms) {
+    if (ms > RTC_WAKEUP_MAX_MS) ms = RTC_WAKEUP_MAX_MS;
+    uint32_t count = ms * RTC_WAKEUP_HZ / 1000;
+    if (count == 0) count = 1;
+
+    rtc_unlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    while (!(RTC->ISR & RTC_ISR_WUTWF));
+
+    // WUCKSEL = 000: RTC/16
+    RTC->CR &= ~RTC_CR_WUCKSEL;
+    RTC->WUTR = count - 1;
+    RTC->ISR &= ~RTC_ISR_WUTF;
+    RTC->CR |= RTC_CR_WUTIE | RTC_CR_WUTE;
+    rtc_lock();
+
+    EXTI->PR = (1U << 22);
+}
+
+void rtc_wakeup_stop(void) {
+    rtc_unlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    rtc_lock();
+}
+
+uint8_t rtc_wakeup_fired(void) {
+    return (RTC->ISR & RTC_ISR_WUTF) ? 1 : 0;
+}
+
+void rtc_wakeup_clear(void) {
+    RTC->ISR &= ~RTC_ISR_WUTF;
+    EXTI->PR = (1U << 22);
+}
+
+// Wakeup timer: one-shot, the core is awake again. The power manager
+// reads WUTF before interrupts are unmasked to tell how long it slept.
+void RTC_WKUP_IRQHandler(void) {
+    rtc_wakeup_stop();
+    rtc_wakeup_clear();
+}
@@ -0,0 +1,40 @@
+#ifndef RTC_H
+#define RTC_H
+
+#include <stdint.h>
+
+// RTC clocked from the 32.768 kHz LSE crystal (PC14/PC15)
+#define RTC_LSE_HZ 32768
+
+// Wakeup timer runs from RTC/16, 2048 Hz, up to 32 s per period
+#define RTC_WAKEUP_HZ     2048
+#define RTC_WAKEUP_MAX_MS 32000
+
+// Start the LSE and the RTC. The calendar keeps running across resets
+// when the backup domain stays powered.
+void rtc_init(void);
+
+// Calendar time in the RTC_TR layout (BCD hours, minutes, seconds).
+// Setting the time also starts the calendar date when it was never set,
+// so the RTC counts as initialized across resets.
+uint32_t rtc_get_tr(void);
+void rtc_set_tr(uint32_t tr);
+
+// Time of day in 1/RTC_TICK_HZ s steps, read from the subsecond counter.
+// It keeps counting in STOP, where SysTick does not, so the time slept
+// can be measured whatever woke the core. Wraps at midnight.
+#define RTC_TICK_HZ 256
+uint32_t rtc_ticks(void);
+
+// Milliseconds from one rtc_ticks() reading to a later one
+uint32_t rtc_elapsed_ms(uint32_t start, uint32_t end);
+
+// Raise the wakeup interrupt (EXTI line 22) once after ms milliseconds
+void rtc_wakeup_start(uint32_t ms);
+void rtc_wakeup_stop(void);
+
+// Non-zero if the wakeup timer fired since the last clear
+uint8_t rtc_wakeup_fired(void);
+void rtc_wakeup_clear(void);
+
+#endif
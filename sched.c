@@ -0,0 +1,149 @@
+#include "stm32f4xx.h"
+#include "sched.h"
+
+typedef struct {
+    task_fn_t fn;
+    uint32_t period;
+    uint32_t next_due;
+    task_stats_t stats;
+} task_t;
+
+static task_t tasks[SCHED_MAX_TASKS];
+static uint8_t task_count;
+static volatile uint32_t ticks;
+static sched_idle_hook_t idle_hook;
+
+// 1 ms time base
+void SysTick_Handler(void) {
+    ticks++;
+}
+
+void sched_init(void) {
+    ticks = 0;
+    sched_recalibrate();
+}
+
+void sched_recalibrate(void) {
+    SysTick_Config(SystemCoreClock / SCHED_TICK_HZ);
+}
+
+int8_t sched_add(task_fn_t fn, uint32_t period_ms) {
+    if (task_count >= SCHED_MAX_TASKS || period_ms == 0) return -1;
+
+    task_t *t = &tasks[task_count];
+    t->fn = fn;
+    t->period = period_ms * SCHED_TICK_HZ / 1000;
+    t->next_due = ticks;
+    t->stats.runs = 0;
+    t->stats.max_latency = 0;
+    t->stats.total_latency = 0;
+    return (int8_t)task_count++;
+}
+
+void sched_set_period(int8_t id, uint32_t period_ms) {
+    if (id < 0 || id >= task_count || period_ms == 0) return;
+    tasks[id].period = period_ms * SCHED_TICK_HZ / 1000;
+}
+
+uint32_t sched_ticks(void) {
+    return ticks;
+}
+
+// Wrap-safe "now is at or past due"
+static uint8_t is_due(uint32_t now, uint32_t due) {
+    return (int32_t)(now - due) >= 0;
+}
+
+uint8_t sched_run_pending(void) {
+    uint8_t ran = 0;
+
+    for (uint8_t i = 0; i < task_count; i++) {
+        task_t *t = &tasks[i];
+        uint32_t now = ticks;
+        if (!is_due(now, t->next_due)) continue;
+
+        uint32_t latency = now - t->next_due;
+        t->stats.runs++;
+        t->stats.total_latency += latency;
+        if (latency > t->stats.max_latency) {
+            t->stats.max_latency = latency;
+        }
+
+        // Advance from the due time, not from now, so periods do not drift.
+        // A task that fell a whole period behind skips the missed runs.
+        t->next_due += t->period;
+        if (is_due(now, t->next_due)) {
+            t->next_due = now + t->period;
+        }
+
+        t->fn();
+        ran++;
+    }
+    return ran;
+}
+
+uint32_t sched_next_due_ms(void) {
+    uint32_t now = ticks;
+    uint32_t next = UINT32_MAX;
+
+    for (uint8_t i = 0; i < task_count; i++) {
+        if (is_due(now, tasks[i].next_due)) return 0;
+        uint32_t wait = tasks[i].next_due - now;
+        if (wait < next) next = wait;
+    }
+    return next == UINT32_MAX ? next : next * 1000 / SCHED_TICK_HZ;
+}
+
+void sched_set_idle_hook(sched_idle_hook_t hook) {
+    idle_hook = hook;
+}
+
+void sched_advance(uint32_t ms) {
+    ticks += ms * SCHED_TICK_HZ / 1000;
+}
+
+uint64_t sched_time_us(void) {
+    uint32_t t, val;
+
+    // Re-read if a tick came in between the two reads
+    do {
+        t = ticks;
+        val = SysTick->VAL;
+    } while (t != ticks);
+
+    uint32_t load = SysTick->LOAD + 1;
+    return (uint64_t)t * (1000000 / SCHED_TICK_HZ) +
+           (uint64_t)(load - val) * (1000000 / SCHED_TICK_HZ) / load;
+}
+
+void sched_run(void) {
+    while (1) {
+        sched_run_pending();
+
+        // Check and sleep with interrupts masked so a tick arriving in
+        // between still wakes the core
+        __disable_irq();
+        uint32_t idle_ms = sched_next_due_ms();
+        if (idle_ms > 0) {
+            if (idle_hook) {
+                idle_hook(idle_ms);
+            } else {
+                __WFI();
+            }
+        }
+        __enable_irq();
+    }
+}
+
+void sched_delay(uint32_t ms) {
+    uint32_t start = ticks;
+    uint32_t wait = ms * SCHED_TICK_HZ / 1000;
+    while ((ticks - start) < wait) {
+        __WFI();
+    }
+}
+
+void sched_get_stats(int8_t id, task_stats_t *stats) {
+    if (id < 0 || id >= task_count) return;
+    *stats = tasks[id].stats;
+}
@@ -0,0 +1,64 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+// SysTick rate and size of the task table
+#define SCHED_TICK_HZ   1000
+#define SCHED_MAX_TASKS 8
+
+typedef void (*task_fn_t)(void);
+
+// Called by sched_run() with interrupts masked when no task is due,
+// ms until the next one (UINT32_MAX without tasks). Must return on wakeup.
+typedef void (*sched_idle_hook_t)(uint32_t ms);
+
+// Timing statistics of one task, in ticks
+typedef struct {
+    uint32_t runs;
+    uint32_t max_latency;   // Worst delay between due time and start
+    uint32_t total_latency;
+} task_stats_t;
+
+// Start SysTick at SCHED_TICK_HZ from SystemCoreClock
+void sched_init(void);
+
+// Reload SysTick after SystemCoreClock changed
+void sched_recalibrate(void);
+
+// Register a periodic task, first run on the next pass.
+// Returns the task id or -1 when the table is full.
+int8_t sched_add(task_fn_t fn, uint32_t period_ms);
+
+// Change the period of a task, takes effect after its next run
+void sched_set_period(int8_t id, uint32_t period_ms);
+
+// Milliseconds since sched_init()
+uint32_t sched_ticks(void);
+
+// Run every task that is due, returns the number of tasks run
+uint8_t sched_run_pending(void);
+
+// Main loop: run due tasks and sleep with __WFI() (or the idle hook)
+// in between
+void sched_run(void);
+
+// Replace the default __WFI() idle, NULL restores it
+void sched_set_idle_hook(sched_idle_hook_t hook);
+
+// Milliseconds until the next task is due, 0 if one is due now
+uint32_t sched_next_due_ms(void);
+
+// Account for time spent with SysTick stopped (STOP mode)
+void sched_advance(uint32_t ms);
+
+// Microseconds since sched_init(), SysTick resolution
+uint64_t sched_time_us(void);
+
+// Sleep for ms milliseconds (tasks do not run meanwhile)
+void sched_delay(uint32_t ms);
+
+// Copy the statistics of a task
+void sched_get_stats(int8_t id, task_stats_t *stats);
+
+#endif
@@ -0,0 +1,69 @@
+#include "scroll.h"
+#include "font.h"
+#include "framebuffer.h"
+
+// Width of the whole chain in pixels
+#define SCROLL_DISPLAY_WIDTH (8 * MAX7219_NUM_DEVICES)
+
+// Load the next glyph of the message, 0 at the end of the text
+static uint8_t load_glyph(scroller_t *s) {
+    uint32_t codepoint = utf8_next(&s->pos);
+    if (codepoint == 0) return 0;
+
+    s->glyph = font_index(codepoint);
+    s->col = font_left(s->glyph);
+    s->cols_left = font_width(s->glyph);
+    s->gap_left = SCROLL_GLYPH_GAP;
+    return 1;
+}
+
+void scroller_start(scroller_t *s, const char *text, uint8_t loop) {
+    s->text = text;
+    s->pos = text;
+    s->cols_left = 0;
+    s->gap_left = 0;
+    s->tail_left = SCROLL_DISPLAY_WIDTH;
+    s->loop = loop;
+    s->done = 0;
+}
+
+uint8_t scroller_next_column(scroller_t *s) {
+    while (1) {
+        if (s->cols_left > 0) {
+            s->cols_left--;
+            return font_columns[s->glyph][s->col++];
+        }
+        if (s->gap_left > 0) {
+            s->gap_left--;
+            return 0x00;
+        }
+        if (load_glyph(s)) {
+            continue;
+        }
+
+        // End of text: blank columns until the last glyph has left
+        if (s->tail_left > 0) {
+            s->tail_left--;
+            return 0x00;
+        }
+        if (!s->loop) {
+            s->done = 1;
+            return 0x00;
+        }
+        scroller_start(s, s->text, s->loop);
+    }
+}
+
+uint8_t scroller_step(scroller_t *s) {
+    if (s->done) return 0;
+
+    fb_shift_left(scroller_next_column(s));
+    return !s->done;
+}
+
+uint32_t scroller_period_ms(uint16_t pixels_per_second) {
+    if (pixels_per_second == 0) return 0;
+
+    uint32_t period = 1000 / pixels_per_second;
+    return period > 0 ? period : 1;
+}
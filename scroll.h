@@ -0,0 +1,36 @@
+#ifndef SCROLL_H
+#define SCROLL_H
+
+#include <stdint.h>
+
+// Blank columns between two glyphs
+#define SCROLL_GLYPH_GAP 1
+
+// Marquee over the framebuffer. Each step shifts the whole chain one
+// pixel to the left and draws only the newly exposed column.
+typedef struct {
+    const char *text;   // UTF-8 message
+    const char *pos;    // Next code point of the message
+    uint8_t glyph;      // Glyph being fed in
+    uint8_t col;        // Next column of that glyph (absolute, 0-7)
+    uint8_t cols_left;  // Glyph columns still to feed
+    uint8_t gap_left;   // Blank columns still to feed after the glyph
+    uint16_t tail_left; // Blank columns that scroll the end off the display
+    uint8_t loop;       // Restart when the message has left the display
+    uint8_t done;
+} scroller_t;
+
+// Start scrolling text in from the right edge
+void scroller_start(scroller_t *s, const char *text, uint8_t loop);
+
+// Next column of the message, bit 0 is the top row
+uint8_t scroller_next_column(scroller_t *s);
+
+// Shift the framebuffer one pixel left and insert the next column.
+// Returns 0 once a non-looping message has scrolled off.
+uint8_t scroller_step(scroller_t *s);
+
+// Scheduler period for a scroll speed in pixels per second
+uint32_t scroller_period_ms(uint16_t pixels_per_second);
+
+#endif
@@ -0,0 +1,91 @@
+#include "stm32f4xx.h"
+#include "slice.h"
+#include "bitslice.h"
+
+#ifdef MAX7219_EMULATOR
+#include "max7219_emu.h"
+#define PIN_WRITE(v) do { GPIOA->BSRR = (v); max7219_emu_bsrr(&max7219_emu, (v)); } while (0)
+#else
+#define PIN_WRITE(v) (GPIOA->BSRR = (v))
+#endif
+
+// Bytes per chain in one latch
+#define LATCH_BYTES (2 * MAX7219_NUM_DEVICES)
+
+static const uint8_t din_pins[SLICE_NUM_CHAINS] = SLICE_DIN_PINS;
+static bitslice_t slicer;
+static uint32_t bytes_sent;
+
+void slice_init(void) {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+
+    uint32_t pins = (1U << CS_PIN) | (1U << CLK_PIN);
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        pins |= 1U << din_pins[c];
+    }
+    for (int pin = 0; pin < 16; pin++) {
+        if (!(pins & (1U << pin))) continue;
+        GPIOA->MODER = (GPIOA->MODER & ~(3U << (pin * 2))) | (1U << (pin * 2));
+        GPIOA->OSPEEDR |= 1U << (pin * 2);
+    }
+
+    bitslice_init(&slicer, din_pins, SLICE_NUM_CHAINS, CLK_PIN);
+    PIN_WRITE(1 << CS_PIN);              // CS high
+    PIN_WRITE(1 << (CLK_PIN + 16));      // CLK low
+}
+
+// Shift one latch of every chain, words[c] in shift order, and pulse CS
+static void send_latch(const uint16_t *const *words) {
+    uint8_t bytes[SLICE_NUM_CHAINS][LATCH_BYTES];
+    const uint8_t *src[SLICE_NUM_CHAINS];
+    uint32_t bsrr[8 * LATCH_BYTES];
+
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+            bytes[c][2 * i] = words[c][i] >> 8;
+            bytes[c][2 * i + 1] = words[c][i] & 0xFF;
+        }
+        src[c] = bytes[c];
+    }
+    bitslice_encode(&slicer, src, LATCH_BYTES, bsrr);
+
+    PIN_WRITE(1 << (CS_PIN + 16));       // Reset CS
+    for (int i = 0; i < 8 * LATCH_BYTES; i++) {
+        PIN_WRITE(bsrr[i]);              // Every DIN, CLK low
+        PIN_WRITE(1 << CLK_PIN);         // Set CLK
+    }
+    PIN_WRITE(1 << CS_PIN);              // Set CS, every chain latches
+
+    bytes_sent += SLICE_NUM_CHAINS * LATCH_BYTES;
+}
+
+void slice_send_cmd(uint8_t reg, uint8_t data) {
+    uint16_t words[MAX7219_NUM_DEVICES];
+    const uint16_t *chains[SLICE_NUM_CHAINS];
+
+    for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+        words[i] = MAX7219_WORD(reg, data);
+    }
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        chains[c] = words;
+    }
+    send_latch(chains);
+}
+
+void slice_send_frame(const uint16_t *const *frames, uint8_t latches) {
+    const uint16_t *chains[SLICE_NUM_CHAINS];
+
+    if (latches > 8) {
+        latches = 8;
+    }
+    for (uint8_t l = 0; l < latches; l++) {
+        for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+            chains[c] = &frames[c][l * MAX7219_NUM_DEVICES];
+        }
+        send_latch(chains);
+    }
+}
+
+uint32_t slice_bytes_sent(void) {
+    return bytes_sent;
+}
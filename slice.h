@@ -0,0 +1,35 @@
+#ifndef SLICE_H
+#define SLICE_H
+
+#include <stdint.h>
+#include "max7219.h"
+
+// Several MAX7219 chains on GPIOA sharing CLK (PA2) and CS (PA1), each
+// with its own DIN pin. One BSRR write puts a bit on every chain, so N
+// chains move N times the data of the bit-bang transport for about the
+// same CPU time. Chain 0 can stay on PA0, the bit-bang DIN. While the
+// chains are in use every write must go through slice_*: a single-chain
+// transfer would clock stale DIN levels into the other chains.
+#ifndef SLICE_NUM_CHAINS
+#define SLICE_NUM_CHAINS 4
+#endif
+
+// DIN pin of each chain, clear of SPI1, USART1, SWD and the light sensor
+#ifndef SLICE_DIN_PINS
+#define SLICE_DIN_PINS { 0, 4, 6, 8 }
+#endif
+
+// Configure the pins, CS high and CLK low
+void slice_init(void);
+
+// Same command to every device of every chain
+void slice_send_cmd(uint8_t reg, uint8_t data);
+
+// One frame per chain, frames[c] laid out with MAX7219_FRAME_INDEX,
+// latches latches each. All chains latch together.
+void slice_send_frame(const uint16_t *const *frames, uint8_t latches);
+
+// Bytes shifted into all chains together
+uint32_t slice_bytes_sent(void);
+
+#endif
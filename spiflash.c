@@ -0,0 +1,167 @@
+#include "stm32f4xx.h"
+#include "spiflash.h"
+#include "clock.h"
+
+#define CMD_READ         0x03
+#define CMD_JEDEC_ID     0x9F
+#define CMD_RELEASE_PD   0xAB
+
+// tRES1: release from power-down to the first command
+#define RELEASE_US 30
+
+const storage_t spiflash_storage = {
+    .read = spiflash_read,
+    .busy = spiflash_busy,
+};
+
+static volatile uint8_t read_busy;
+static uint8_t spiflash_running;
+
+// Shifted out while reading, MOSI is ignored by the flash
+static const uint8_t dummy = 0xFF;
+
+// Smallest divider that keeps SCK within SPIFLASH_MAX_CLK_HZ
+static uint32_t spiflash_baud_bits(void) {
+    uint32_t pclk = clock_pclk1_hz();
+    uint32_t br = 0;
+    while (br < 7 && (pclk >> (br + 1)) > SPIFLASH_MAX_CLK_HZ) {
+        br++;
+    }
+    return br << SPI_CR1_BR_Pos;
+}
+
+static void cs_low(void) {
+    GPIOB->BSRR = 1U << (SPIFLASH_CS_PIN + 16);
+}
+
+static void cs_high(void) {
+    // The last byte must be fully clocked before CS rises
+    while (SPI2->SR & SPI_SR_BSY);
+    GPIOB->BSRR = 1U << SPIFLASH_CS_PIN;
+}
+
+// Full-duplex byte, polled
+static uint8_t xfer(uint8_t out) {
+    while (!(SPI2->SR & SPI_SR_TXE));
+    SPI2->DR = out;
+    while (!(SPI2->SR & SPI_SR_RXNE));
+    return (uint8_t)SPI2->DR;
+}
+
+void spiflash_init(void) {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN | RCC_AHB1ENR_DMA1EN;
+    RCC->APB1ENR |= RCC_APB1ENR_SPI2EN;
+
+    // PB12 (CS) as output, high
+    GPIOB->BSRR = 1U << SPIFLASH_CS_PIN;
+    GPIOB->MODER = (GPIOB->MODER & ~GPIO_MODER_MODER12) | GPIO_MODER_MODER12_0;
+    GPIOB->OSPEEDR |= GPIO_OSPEEDER_OSPEEDR12_0;
+
+    // PB13 (SCK), PB14 (MISO), PB15 (MOSI) as alternate function 5
+    GPIOB->MODER = (GPIOB->MODER & ~(GPIO_MODER_MODER13 | GPIO_MODER_MODER14 | GPIO_MODER_MODER15)) |
+                   GPIO_MODER_MODER13_1 | GPIO_MODER_MODER14_1 | GPIO_MODER_MODER15_1;
+    GPIOB->OSPEEDR |= GPIO_OSPEEDER_OSPEEDR13 | GPIO_OSPEEDER_OSPEEDR15;
+    GPIOB->AFR[1] = (GPIOB->AFR[1] & ~((0xFU << ((SPIFLASH_SCK_PIN - 8) * 4)) |
+                                       (0xFU << ((SPIFLASH_MISO_PIN - 8) * 4)) |
+                                       (0xFU << ((SPIFLASH_MOSI_PIN - 8) * 4)))) |
+                    (5U << ((SPIFLASH_SCK_PIN - 8) * 4)) |
+                    (5U << ((SPIFLASH_MISO_PIN - 8) * 4)) |
+                    (5U << ((SPIFLASH_MOSI_PIN - 8) * 4));
+
+    // Mode 0, MSB first, 8-bit frames, software slave management
+    SPI2->CR1 = 0;
+    SPI2->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | spiflash_baud_bits();
+    SPI2->CR2 = 0;
+    SPI2->CR1 |= SPI_CR1_SPE;
+
+    // SPI2_RX is DMA1 Stream3 Channel0, SPI2_TX DMA1 Stream4 Channel0
+    DMA1_Stream3->CR = 0;
+    DMA1_Stream4->CR = 0;
+    while ((DMA1_Stream3->CR & DMA_SxCR_EN) || (DMA1_Stream4->CR & DMA_SxCR_EN));
+    DMA1_Stream3->PAR = (uint32_t)&SPI2->DR;
+    DMA1_Stream3->CR = DMA_SxCR_MINC | DMA_SxCR_TCIE;
+    DMA1_Stream4->PAR = (uint32_t)&SPI2->DR;
+    DMA1_Stream4->M0AR = (uint32_t)&dummy;
+    DMA1_Stream4->CR = DMA_SxCR_DIR_0;
+
+    NVIC_SetPriority(DMA1_Stream3_IRQn, 2);
+    NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+
+    // Parts left in deep power-down ignore everything else
+    cs_low();
+    xfer(CMD_RELEASE_PD);
+    cs_high();
+    for (volatile uint32_t i = 0; i < SystemCoreClock / 1000000 * RELEASE_US; i++);
+
+    spiflash_running = 1;
+}
+
+void spiflash_recalibrate(void) {
+    if (!spiflash_running) {
+        return;
+    }
+
+    // The divider can only change with the SPI idle and disabled
+    while (read_busy);
+    while (SPI2->SR & SPI_SR_BSY);
+    SPI2->CR1 &= ~SPI_CR1_SPE;
+    SPI2->CR1 = (SPI2->CR1 & ~SPI_CR1_BR) | spiflash_baud_bits();
+    SPI2->CR1 |= SPI_CR1_SPE;
+}
+
+uint32_t spiflash_read_id(void) {
+    while (read_busy);
+    cs_low();
+    xfer(CMD_JEDEC_ID);
+    uint32_t id = (uint32_t)xfer(0xFF) << 16;
+    id |= (uint32_t)xfer(0xFF) << 8;
+    id |= xfer(0xFF);
+    cs_high();
+    return id;
+}
+
+void spiflash_read(uint32_t addr, uint8_t *buf, uint16_t len) {
+    while (read_busy);
+    if (len == 0) {
+        return;
+    }
+
+    // Command and address polled, the data by DMA
+    cs_low();
+    xfer(CMD_READ);
+    xfer((uint8_t)(addr >> 16));
+    xfer((uint8_t)(addr >> 8));
+    xfer((uint8_t)addr);
+
+    read_busy = 1;
+    DMA1->LIFCR = DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 |
+                  DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3;
+    DMA1->HIFCR = DMA_HIFCR_CTCIF4 | DMA_HIFCR_CHTIF4 | DMA_HIFCR_CTEIF4 |
+                  DMA_HIFCR_CDMEIF4 | DMA_HIFCR_CFEIF4;
+    DMA1_Stream3->M0AR = (uint32_t)buf;
+    DMA1_Stream3->NDTR = len;
+    DMA1_Stream4->NDTR = len;
+
+    // Receive side first so no byte is missed
+    DMA1_Stream3->CR |= DMA_SxCR_EN;
+    SPI2->CR2 = SPI_CR2_RXDMAEN;
+    DMA1_Stream4->CR |= DMA_SxCR_EN;
+    SPI2->CR2 = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+}
+
+uint8_t spiflash_busy(void) {
+    return read_busy;
+}
+
+// Last byte received: end the read command
+void DMA1_Stream3_IRQHandler(void) {
+    if (!(DMA1->LISR & DMA_LISR_TCIF3)) {
+        return;
+    }
+    DMA1->LIFCR = DMA_LIFCR_CTCIF3;
+    DMA1->HIFCR = DMA_HIFCR_CTCIF4;
+
+    SPI2->CR2 = 0;
+    cs_high();
+    read_busy = 0;
+}
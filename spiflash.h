@@ -0,0 +1,37 @@
+#ifndef SPIFLASH_H
+#define SPIFLASH_H
+
+#include <stdint.h>
+#include "stream.h"
+
+// SPI NOR flash (W25Qxx and compatibles) on SPI2, clear of the MAX7219,
+// UART and light sensor pins
+#define SPIFLASH_CS_PIN   12  // PB12
+#define SPIFLASH_SCK_PIN  13  // PB13 (SPI2_SCK)
+#define SPIFLASH_MISO_PIN 14  // PB14 (SPI2_MISO)
+#define SPIFLASH_MOSI_PIN 15  // PB15 (SPI2_MOSI)
+
+// Fastest clock for the plain READ (0x03) command across common parts
+#ifndef SPIFLASH_MAX_CLK_HZ
+#define SPIFLASH_MAX_CLK_HZ 20000000
+#endif
+
+// Storage driver for stream.h: reads go out by DMA1 Stream4 (dummy
+// bytes) and come back by DMA1 Stream3
+extern const storage_t spiflash_storage;
+
+// Configure SPI2 and its DMA streams, wake the flash from power-down
+void spiflash_init(void);
+
+// Reload the SPI clock divider after SystemCoreClock changed
+void spiflash_recalibrate(void);
+
+// JEDEC manufacturer and device ID (0x9F), blocking. 0xFFFFFF or 0 when
+// no flash answers.
+uint32_t spiflash_read_id(void);
+
+// Start reading len bytes at addr into buf, spiflash_busy() until done
+void spiflash_read(uint32_t addr, uint8_t *buf, uint16_t len);
+uint8_t spiflash_busy(void);
+
+#endif
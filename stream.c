@@ -0,0 +1,101 @@
+#include "stream.h"
+
+#define BUF_EMPTY   0
+#define BUF_LOADING 1
+#define BUF_READY   2
+
+#define NO_BUF 2
+
+void stream_open(stream_t *s, const storage_t *dev, uint8_t *buf, uint16_t chunk,
+                 uint32_t addr, uint32_t size, uint32_t loop_offset) {
+    // A read of the previous stream may still write into buf
+    while (dev->busy());
+
+    s->dev = dev;
+    s->buf[0] = buf;
+    s->buf[1] = buf + chunk;
+    s->chunk = chunk;
+    for (int b = 0; b < 2; b++) {
+        s->len[b] = 0;
+        s->state[b] = BUF_EMPTY;
+    }
+    s->cur = 0;
+    s->loading = NO_BUF;
+    s->pos = 0;
+    s->start = addr;
+    s->end = addr + size;
+    s->loop = loop_offset == STREAM_NO_LOOP || loop_offset >= size ? STREAM_NO_LOOP : addr + loop_offset;
+    s->next = addr;
+    s->bytes_read = 0;
+    stream_poll(s);
+}
+
+void stream_poll(stream_t *s) {
+    if (s->loading != NO_BUF) {
+        if (s->dev->busy()) return;
+        s->state[s->loading] = BUF_READY;
+        s->loading = NO_BUF;
+    }
+
+    // The drained buffer is refilled first, it holds the oldest data
+    uint8_t b = NO_BUF;
+    if (s->state[s->cur] == BUF_EMPTY) {
+        b = s->cur;
+    } else if (s->state[!s->cur] == BUF_EMPTY) {
+        b = (uint8_t)!s->cur;
+    }
+    if (b == NO_BUF || s->next == s->end) return;
+
+    // A read never crosses the end, the next one starts at the loop point
+    uint32_t n = s->end - s->next;
+    if (n > s->chunk) n = s->chunk;
+    s->len[b] = (uint16_t)n;
+    s->state[b] = BUF_LOADING;
+    s->loading = b;
+    s->dev->read(s->next, s->buf[b], (uint16_t)n);
+    s->bytes_read += n;
+
+    s->next += n;
+    if (s->next == s->end && s->loop != STREAM_NO_LOOP) {
+        s->next = s->loop;
+    }
+}
+
+uint32_t stream_available(const stream_t *s) {
+    if (s->state[s->cur] != BUF_READY) return 0;
+
+    uint32_t n = s->len[s->cur] - s->pos;
+    if (s->state[!s->cur] == BUF_READY) {
+        n += s->len[!s->cur];
+    }
+    return n;
+}
+
+uint8_t stream_peek(const stream_t *s, uint32_t i) {
+    uint32_t left = s->len[s->cur] - s->pos;
+    if (i < left) {
+        return s->buf[s->cur][s->pos + i];
+    }
+    return s->buf[!s->cur][i - left];
+}
+
+void stream_read(stream_t *s, uint8_t *dst, uint32_t n) {
+    while (n > 0) {
+        uint32_t left = s->len[s->cur] - s->pos;
+        uint32_t take = n < left ? n : left;
+        if (dst) {
+            for (uint32_t i = 0; i < take; i++) {
+                *dst++ = s->buf[s->cur][s->pos + i];
+            }
+        }
+        s->pos = (uint16_t)(s->pos + take);
+        n -= take;
+
+        // Drained: hand it back for the next read, go on in the other
+        if (s->pos == s->len[s->cur]) {
+            s->state[s->cur] = BUF_EMPTY;
+            s->cur = (uint8_t)!s->cur;
+            s->pos = 0;
+        }
+    }
+}
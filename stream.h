@@ -0,0 +1,57 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+
+// Read-ahead over external storage: two chunk buffers, one being
+// consumed while the storage fills the other, so data is already in RAM
+// when the consumer needs it. The storage driver does the reads:
+// spiflash.c on the board, a file image in tools/flashsim.c.
+
+// Storage driver: read() starts a transfer of len bytes at addr into buf
+// and returns, busy() is non-zero until the bytes are in buf. One read at
+// a time.
+typedef struct {
+    void (*read)(uint32_t addr, uint8_t *buf, uint16_t len);
+    uint8_t (*busy)(void);
+} storage_t;
+
+// No wrap: the stream ends after size bytes
+#define STREAM_NO_LOOP 0xFFFFFFFFu
+
+typedef struct {
+    const storage_t *dev;
+    uint8_t *buf[2];
+    uint16_t chunk;         // Size of each buffer
+    uint16_t len[2];        // Bytes loaded into each buffer
+    uint8_t state[2];
+    uint8_t cur;            // Buffer being consumed
+    uint8_t loading;        // Buffer with a read in flight, 2 for none
+    uint16_t pos;           // Next byte of buf[cur]
+    uint32_t start;         // Region read, start .. end - 1
+    uint32_t end;
+    uint32_t loop;          // Where reading continues after end
+    uint32_t next;          // Next address to fetch
+    uint32_t bytes_read;
+} stream_t;
+
+// Stream size bytes from addr, continuing at addr + loop_offset after the
+// end (STREAM_NO_LOOP to stop). buf holds 2 * chunk bytes. Waits for a
+// read still in flight on the storage, then starts the first one.
+void stream_open(stream_t *s, const storage_t *dev, uint8_t *buf, uint16_t chunk,
+                 uint32_t addr, uint32_t size, uint32_t loop_offset);
+
+// Collect a finished read and start the next one into a free buffer.
+// Call often: the read-ahead only moves on when it is polled.
+void stream_poll(stream_t *s);
+
+// Bytes in RAM ready to be consumed, at most 2 * chunk
+uint32_t stream_available(const stream_t *s);
+
+// Byte i ahead of the read position, i < stream_available()
+uint8_t stream_peek(const stream_t *s, uint32_t i);
+
+// Consume n <= stream_available() bytes, dst may be NULL to skip them
+void stream_read(stream_t *s, uint8_t *dst, uint32_t n);
+
+#endif
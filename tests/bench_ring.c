@@ -0,0 +1,90 @@
+// Throughput of ring.c between two threads, per access path and block
+// size, to compare the byte-wise calls with the block ones. Host
+// benchmark, built from the repository root:
+//
+//   cc -O2 -I. -o bench_ring tests/bench_ring.c ring.c -lpthread
+//   ./bench_ring [megabytes]
+//
+// The figures are for the host; on the Cortex-M4 the same ratios show
+// how much the per-call barriers cost against the copies.
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ring.h"
+
+// <sched.h> is shadowed by the firmware's sched.h on the include path
+int sched_yield(void);
+
+#define RING_SIZE 1024
+
+static ring_t ring;
+static uint8_t ring_buf[RING_SIZE];
+static uint32_t total;
+static uint32_t block;
+
+static void *producer(void *arg) {
+    uint8_t data[RING_SIZE];
+    uint32_t sent = 0;
+    (void)arg;
+
+    for (uint32_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)i;
+    while (sent < total) {
+        uint32_t n;
+        if (block == 1) {
+            n = ring_push(&ring, (uint8_t)sent);
+        } else {
+            uint32_t len = total - sent < block ? total - sent : block;
+            n = ring_write(&ring, data, len);
+        }
+        // Full: give the consumer the core when there is only one
+        if (n == 0) sched_yield();
+        sent += n;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    uint8_t data[RING_SIZE];
+    uint32_t got = 0;
+    uint8_t b;
+    (void)arg;
+
+    while (got < total) {
+        uint32_t n = block == 1 ? ring_pop(&ring, &b) : ring_read(&ring, data, block);
+        if (n == 0) sched_yield();
+        got += n;
+    }
+    return NULL;
+}
+
+static double now_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+    static const uint32_t blocks[] = { 1, 4, 16, 64, 256, 1024 };
+    uint32_t mb = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+    total = mb << 20;
+
+    printf("%u MB through a %u byte ring\n", mb, RING_SIZE);
+    printf("%8s %10s %12s\n", "block", "MB/s", "ns/byte");
+    for (unsigned i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+        pthread_t p, c;
+
+        block = blocks[i];
+        ring_init(&ring, ring_buf, sizeof(ring_buf));
+
+        double start = now_s();
+        pthread_create(&c, NULL, consumer, NULL);
+        pthread_create(&p, NULL, producer, NULL);
+        pthread_join(p, NULL);
+        pthread_join(c, NULL);
+        double s = now_s() - start;
+
+        printf("%8u %10.1f %12.2f\n", block, mb / s, s * 1e9 / total);
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Bus time of the display update path per transport, from the MAX7219
+// model instead of the DWT counter: bench.c needs the core debug block
+// and SWO, this runs the same operations on the host and turns the
+// model's CLK edges and CS latches into core cycles at the bit rate each
+// transport was set up for. Prints the CSV of bench.h,
+//   bench,transport,sequence,cycles,bytes,fps,bit_hz
+// so the two can be put side by side. Host benchmark:
+//
+//   make -C tests bench && tests/bench_transport [cycles per pin write]
+//
+// SPI DMA shifts a bit per SCK period (SPI1 BR), GPIO DMA takes two TIM1
+// slots per bit and two per latch for CS. Bit-bang has no hardware pace:
+// it is charged per GPIOA->BSRR write, 3 core cycles unless given (a
+// store on AHB1 and the loop around it; check against frame_full of
+// bench.c on the board). Only bus time is counted, the CPU-only
+// benchmarks of bench.c (anim_decode, atlas_decode, cpu_*) have no
+// counterpart here.
+#include <stdio.h>
+#include <stdlib.h>
+#include "hw.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "font.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+#define BENCH_REPEAT 64
+
+static const struct {
+    const char *name;
+    const char *text;
+} sequences[] = {
+    { "digits",   "0123456789" },
+    { "capitals", "ABCÇDEFGĞHIİJKLMNOÖPRSŞTUÜVYZ" },
+    { "letters",  "abcçdefgğhıijklmnoöprsştuüvyz" },
+};
+
+static const char *transport_names[] = { "bitbang", "spi_dma", "gpio_dma" };
+
+static max7219_emu_t emu;
+static uint32_t pin_writes;
+static uint32_t cycles_per_write = 3;
+
+static void bus(hw_event_t event, uint32_t value) {
+    if (event == HW_PIN) {
+        pin_writes++;
+        max7219_emu_bsrr(&emu, value);
+    } else {
+        max7219_emu_shift_word(&emu, (uint16_t)value);
+    }
+}
+
+static void reset_counters(void) {
+    hw_sync();
+    transport_reset_stats();
+    emu.clocks = 0;
+    emu.latches = 0;
+    pin_writes = 0;
+}
+
+// Core cycles the bus was busy since reset_counters()
+static uint32_t bus_cycles(transport_t transport) {
+    hw_sync();
+    if (transport == TRANSPORT_SPI_DMA) {
+        uint32_t br = (SPI1->CR1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos;
+        uint64_t per_bit = (uint64_t)SystemCoreClock * (2u << br) / clock_pclk2_hz();
+        return (uint32_t)(emu.clocks * per_bit);
+    }
+    if (transport == TRANSPORT_GPIO_DMA) {
+        uint64_t slot = (uint64_t)SystemCoreClock * (TIM1->ARR + 1) / clock_pclk2_hz();
+        return (uint32_t)((2ull * emu.clocks + 2ull * emu.latches) * slot);
+    }
+    return pin_writes * cycles_per_write;
+}
+
+// One line of bench.h's CSV, cycles and bytes are totals over count
+static void report(const char *bench, transport_t transport, const char *seq, uint32_t cycles,
+                   uint32_t bytes, uint32_t count) {
+    uint32_t per_op = cycles / count;
+    uint32_t fps = per_op ? SystemCoreClock / per_op : 0;
+    uint32_t bit_hz = cycles ? (uint32_t)((uint64_t)bytes * 8 * SystemCoreClock / cycles) : 0;
+
+    printf("%s,%s,%s,%u,%u,%u,%u\n", bench, transport_names[transport], seq, per_op, bytes / count,
+           fps, bit_hz);
+}
+
+static void bench_send_cmd(transport_t transport) {
+    reset_counters();
+    for (int i = 0; i < BENCH_REPEAT; i++) {
+        send_cmd(REG_NOOP, 0x00);
+    }
+    report("send_cmd", transport, "-", bus_cycles(transport), transport_bytes_sent(),
+           BENCH_REPEAT);
+}
+
+static void bench_init_max7219(transport_t transport) {
+    reset_counters();
+    init_max7219(0x0A);
+    report("init_max7219", transport, "-", bus_cycles(transport), transport_bytes_sent(), 1);
+}
+
+// Every glyph of a sequence once; full = resend all rows each frame
+static void bench_frames(transport_t transport, const char *name, const char *text,
+                         uint8_t full) {
+    uint32_t codepoint;
+    uint32_t frames = 0;
+
+    fb_clear();
+    fb_invalidate();
+    fb_flush();
+    reset_counters();
+
+    while ((codepoint = utf8_next(&text)) != 0) {
+        const uint8_t *glyph = font_lookup(codepoint);
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            fb_draw_glyph((uint8_t)dev, glyph);
+        }
+        if (full) {
+            fb_invalidate();
+        }
+        fb_flush();
+        frames++;
+    }
+    uint32_t cycles = bus_cycles(transport);
+    if (emu.clocks != 8 * transport_bytes_sent()) {
+        fprintf(stderr, "%s on %s: %u clocks for %u bytes\n", name, transport_names[transport],
+                emu.clocks, transport_bytes_sent());
+    }
+    report(full ? "frame_full" : "frame_diff", transport, name, cycles, transport_bytes_sent(),
+           frames);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) cycles_per_write = (uint32_t)atoi(argv[1]);
+
+    printf("bench,transport,sequence,cycles,bytes,fps,bit_hz\n");
+    for (int t = TRANSPORT_BITBANG; t <= TRANSPORT_GPIO_DMA; t++) {
+        transport_t transport = (transport_t)t;
+
+        hw_reset();
+        max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+        hw_set_bus(bus);
+        transport_init(transport);
+        fb_init();
+
+        bench_send_cmd(transport);
+        bench_init_max7219(transport);
+        for (unsigned s = 0; s < sizeof(sequences) / sizeof(sequences[0]); s++) {
+            bench_frames(transport, sequences[s].name, sequences[s].text, 1);
+            bench_frames(transport, sequences[s].name, sequences[s].text, 0);
+        }
+        hw_set_bus(NULL);
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// Minimal test harness: CHECK() reports a failed condition and keeps
+// going, check_done() prints the tally and gives the exit status
+static int check_failures;
+static int check_count;
+
+#define CHECK(cond, ...) do {                                           \
+        check_count++;                                                  \
+        if (!(cond)) {                                                  \
+            check_failures++;                                           \
+            fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond);  \
+            fprintf(stderr, __VA_ARGS__);                               \
+            fputc('\n', stderr);                                        \
+        }                                                               \
+    } while (0)
+
+static inline int check_done(const char *name) {
+    printf("%s: %d checks, %d failed\n", name, check_count, check_failures);
+    return check_failures ? 1 : 0;
+}
+
+#endif
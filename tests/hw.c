@@ -0,0 +1,359 @@
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/time.h>
+#include "hw.h"
+
+// DMA timer period: how long a started frame takes to go out at most
+#define DMA_TICK_US 50
+
+// DR value meaning "nothing written since the last look"
+#define DR_IDLE 0xFFFFFFFFu
+
+GPIO_TypeDef hw_gpioa_regs;
+SPI_TypeDef hw_spi1_regs;
+DMA_TypeDef hw_dma2_regs;
+DMA_Stream_TypeDef hw_dma2_streams[8];
+TIM_TypeDef hw_tim1_regs, hw_tim2_regs, hw_tim3_regs;
+RCC_TypeDef hw_rcc_regs;
+FLASH_TypeDef hw_flash_regs;
+PWR_TypeDef hw_pwr_regs;
+ADC_TypeDef hw_adc1_regs;
+ADC_Common_TypeDef hw_adc_regs;
+SCB_Type hw_scb_regs;
+SysTick_Type hw_systick_regs;
+uint32_t SystemCoreClock = 84000000;
+
+void (*hw_wfi_hook)(void);
+
+// Handlers of the firmware objects a test links, if any
+void DMA2_Stream1_IRQHandler(void) __attribute__((weak));
+void DMA2_Stream3_IRQHandler(void) __attribute__((weak));
+
+static hw_bus_fn_t bus;
+static hw_wire_t *bus_wire;
+static max7219_emu_t *bus_emu;
+
+// Non-zero while the test is inside the model, the timer leaves it alone
+static volatile sig_atomic_t lock;
+static volatile uint8_t irq_masked;
+static uint8_t irq_enabled[HW_IRQ_COUNT];
+static uint8_t irq_pending[HW_IRQ_COUNT];
+
+static void emit(hw_event_t event, uint32_t value) {
+    if (event == HW_PIN) {
+        hw_gpioa_regs.ODR = (hw_gpioa_regs.ODR & ~(value >> 16)) | (value & 0xFFFF);
+    }
+    if (bus) {
+        bus(event, value);
+    }
+}
+
+// A write to BSRR or DR is seen at the next access to either port, so it
+// is always reported before whatever the code does next
+static void flush(void) {
+    uint32_t v = hw_gpioa_regs.BSRR;
+    if (v) {
+        hw_gpioa_regs.BSRR = 0;
+        emit(HW_PIN, v);
+    }
+    v = hw_spi1_regs.DR;
+    if (v != DR_IDLE) {
+        hw_spi1_regs.DR = DR_IDLE;
+        emit(HW_SPI, v & 0xFFFF);
+    }
+}
+
+GPIO_TypeDef *hw_gpioa(void) {
+    lock++;
+    flush();
+    lock--;
+    return &hw_gpioa_regs;
+}
+
+SPI_TypeDef *hw_spi1(void) {
+    lock++;
+    flush();
+    lock--;
+    return &hw_spi1_regs;
+}
+
+static void (*irq_handler(IRQn_Type irq))(void) {
+    switch (irq) {
+    case DMA2_Stream1_IRQn: return DMA2_Stream1_IRQHandler;
+    case DMA2_Stream3_IRQn: return DMA2_Stream3_IRQHandler;
+    default:                return NULL;
+    }
+}
+
+static void raise_irq(IRQn_Type irq) {
+    void (*fn)(void) = irq_handler(irq);
+    if (!irq_enabled[irq] || irq_masked || !fn) {
+        irq_pending[irq] = 1;
+        return;
+    }
+    irq_pending[irq] = 0;
+    fn();
+}
+
+// Stream finished: flag, interrupt, and the flag is assumed cleared by
+// the handler (LIFCR is write-only and not modelled)
+static void complete(DMA_Stream_TypeDef *s, uint32_t tcif, IRQn_Type irq) {
+    s->NDTR = 0;
+    s->CR &= ~DMA_SxCR_EN;
+    hw_dma2_regs.LISR |= tcif;
+    if (s->CR & DMA_SxCR_TCIE) {
+        raise_irq(irq);
+    }
+    if (!irq_pending[irq]) {
+        hw_dma2_regs.LISR &= ~tcif;
+    }
+}
+
+// Run one enabled stream whose peripheral is requesting, 1 if one ran
+static uint8_t run_stream(void) {
+    DMA_Stream_TypeDef *s = &hw_dma2_streams[3];
+    if ((s->CR & DMA_SxCR_EN) && (hw_spi1_regs.CR2 & SPI_CR2_TXDMAEN) &&
+        (hw_spi1_regs.CR1 & SPI_CR1_SPE)) {
+        const uint16_t *src = (const uint16_t *)(uintptr_t)s->M0AR;
+        uint32_t step = (s->CR & DMA_SxCR_MINC) ? 1 : 0;
+        for (uint32_t n = s->NDTR; n > 0; n--) {
+            emit(HW_SPI, *src);
+            src += step;
+        }
+        complete(s, DMA_LISR_TCIF3, DMA2_Stream3_IRQn);
+        return 1;
+    }
+
+    s = &hw_dma2_streams[1];
+    if ((s->CR & DMA_SxCR_EN) && (hw_tim1_regs.CR1 & TIM_CR1_CEN) &&
+        (hw_tim1_regs.DIER & TIM_DIER_CC1DE)) {
+        const uint32_t *src = (const uint32_t *)(uintptr_t)s->M0AR;
+        uint32_t step = (s->CR & DMA_SxCR_MINC) ? 1 : 0;
+        for (uint32_t n = s->NDTR; n > 0; n--) {
+            emit(HW_PIN, *src);
+            src += step;
+        }
+        complete(s, DMA_LISR_TCIF1, DMA2_Stream1_IRQn);
+        return 1;
+    }
+    return 0;
+}
+
+static void run_dma(void) {
+    flush();
+    while (run_stream()) {
+        flush();
+    }
+    flush();
+}
+
+static void on_tick(int sig) {
+    (void)sig;
+    if (lock || irq_masked) return;
+    lock = 1;
+    run_dma();
+    lock = 0;
+}
+
+void hw_reset(void) {
+    static uint8_t timer_started;
+
+    lock++;
+    memset(&hw_gpioa_regs, 0, sizeof(hw_gpioa_regs));
+    memset(&hw_spi1_regs, 0, sizeof(hw_spi1_regs));
+    memset(&hw_dma2_regs, 0, sizeof(hw_dma2_regs));
+    memset(hw_dma2_streams, 0, sizeof(hw_dma2_streams));
+    memset(&hw_tim1_regs, 0, sizeof(hw_tim1_regs));
+    memset(&hw_tim2_regs, 0, sizeof(hw_tim2_regs));
+    memset(&hw_tim3_regs, 0, sizeof(hw_tim3_regs));
+    memset(&hw_rcc_regs, 0, sizeof(hw_rcc_regs));
+    memset(&hw_flash_regs, 0, sizeof(hw_flash_regs));
+    memset(&hw_pwr_regs, 0, sizeof(hw_pwr_regs));
+    memset(&hw_adc1_regs, 0, sizeof(hw_adc1_regs));
+    memset(&hw_adc_regs, 0, sizeof(hw_adc_regs));
+    memset(&hw_scb_regs, 0, sizeof(hw_scb_regs));
+    memset(&hw_systick_regs, 0, sizeof(hw_systick_regs));
+    memset(irq_enabled, 0, sizeof(irq_enabled));
+    memset(irq_pending, 0, sizeof(irq_pending));
+    hw_spi1_regs.SR = SPI_SR_TXE;
+    hw_spi1_regs.DR = DR_IDLE;
+    SystemCoreClock = 84000000;
+    irq_masked = 0;
+    bus = NULL;
+    bus_wire = NULL;
+    bus_emu = NULL;
+    hw_wfi_hook = NULL;
+    lock--;
+
+    if (!timer_started) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_tick;
+        sa.sa_flags = SA_RESTART;
+        sigaction(SIGALRM, &sa, NULL);
+
+        struct itimerval it = { { 0, DMA_TICK_US }, { 0, DMA_TICK_US } };
+        setitimer(ITIMER_REAL, &it, NULL);
+        timer_started = 1;
+    }
+}
+
+void hw_set_bus(hw_bus_fn_t fn) {
+    lock++;
+    flush();
+    bus = fn;
+    lock--;
+}
+
+static void attached_bus(hw_event_t event, uint32_t value) {
+    if (bus_wire) {
+        hw_wire_event(bus_wire, event, value);
+    }
+    if (bus_emu) {
+        if (event == HW_PIN) {
+            max7219_emu_bsrr(bus_emu, value);
+        } else {
+            max7219_emu_shift_word(bus_emu, (uint16_t)value);
+        }
+    }
+}
+
+void hw_attach(hw_wire_t *wire, max7219_emu_t *emu) {
+    lock++;
+    flush();
+    bus_wire = wire;
+    bus_emu = emu;
+    bus = attached_bus;
+    lock--;
+}
+
+void hw_sync(void) {
+    lock++;
+    run_dma();
+    lock--;
+}
+
+uint8_t hw_irq_enabled(IRQn_Type irq) {
+    return irq_enabled[irq];
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+    irq_enabled[irq] = 1;
+    if (irq_pending[irq]) {
+        lock++;
+        raise_irq(irq);
+        lock--;
+    }
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+    irq_enabled[irq] = 0;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    (void)irq;
+    (void)priority;
+}
+
+void __disable_irq(void) {
+    irq_masked = 1;
+}
+
+void __enable_irq(void) {
+    irq_masked = 0;
+    lock++;
+    for (int irq = 0; irq < HW_IRQ_COUNT; irq++) {
+        if (irq_pending[irq] && irq_enabled[irq]) {
+            raise_irq((IRQn_Type)irq);
+        }
+    }
+    lock--;
+}
+
+uint32_t __get_PRIMASK(void) {
+    return irq_masked;
+}
+
+void __set_PRIMASK(uint32_t primask) {
+    if (primask) {
+        __disable_irq();
+    } else {
+        __enable_irq();
+    }
+}
+
+void __WFI(void) {
+    if (hw_wfi_hook) {
+        hw_wfi_hook();
+    } else {
+        hw_sync();
+    }
+}
+
+uint32_t SysTick_Config(uint32_t ticks) {
+    hw_systick_regs.LOAD = ticks - 1;
+    hw_systick_regs.VAL = 0;
+    hw_systick_regs.CTRL = 7;
+    return 0;
+}
+
+void SystemCoreClockUpdate(void) {
+}
+
+void hw_wire_init(hw_wire_t *w) {
+    memset(w, 0, sizeof(*w));
+    w->pins = 1U << 1;      // CS idles high
+}
+
+static void wire_bit(hw_wire_t *w, uint8_t bit) {
+    if (w->bits >= 8 * HW_WIRE_MAX_BYTES) {
+        w->overflow = 1;
+        return;
+    }
+    uint8_t *byte = &w->partial[w->bits / 8];
+    *byte = (uint8_t)((*byte << 1) | bit);
+    w->bits++;
+}
+
+void hw_wire_event(hw_wire_t *w, hw_event_t event, uint32_t value) {
+    const uint32_t din = 1U << 0, cs = 1U << 1, clk = 1U << 2;
+
+    if (event == HW_SPI) {
+        if (!(w->pins & cs)) {
+            for (int i = 15; i >= 0; i--) {
+                wire_bit(w, (value >> i) & 1);
+            }
+        }
+        return;
+    }
+
+    uint32_t old = w->pins;
+    uint32_t pins = (old & ~(value >> 16)) | (value & 0xFFFF);
+    w->pins = pins;
+
+    if ((old & cs) && !(pins & cs)) {
+        w->bits = 0;
+        memset(w->partial, 0, sizeof(w->partial));
+    }
+    if (!(pins & cs) && !(old & clk) && (pins & clk)) {
+        wire_bit(w, (pins & din) ? 1 : 0);
+    }
+    if (!(old & cs) && (pins & cs)) {
+        if (w->latches >= HW_WIRE_MAX_LATCHES || w->bits % 8) {
+            w->overflow = 1;
+            return;
+        }
+        w->len[w->latches] = w->bits / 8;
+        memcpy(w->data[w->latches], w->partial, w->bits / 8);
+        w->latches++;
+    }
+}
+
+uint8_t hw_wire_equal(const hw_wire_t *a, const hw_wire_t *b) {
+    if (a->overflow || b->overflow || a->latches != b->latches) return 0;
+    for (int l = 0; l < a->latches; l++) {
+        if (a->len[l] != b->len[l] || memcmp(a->data[l], b->data[l], a->len[l])) return 0;
+    }
+    return 1;
+}
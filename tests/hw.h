@@ -0,0 +1,68 @@
+#ifndef HW_H
+#define HW_H
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+#include "max7219_emu.h"
+
+// Peripheral model behind the host stm32f4xx.h. It reports what reaches
+// the MAX7219 pins: every GPIOA->BSRR write and every word the SPI1
+// shifts out, whether the CPU or a DMA stream wrote it.
+//
+// The DMA streams run from a SIGALRM timer, which interrupts the test
+// like a real interrupt would, so the driver's waits on a frame in
+// flight finish on their own. A stream moves NDTR items from M0AR when
+// enabled (MINC honoured) and then raises its transfer-complete IRQ.
+// DMA2 Stream3 feeds SPI1->DR, DMA2 Stream1 writes GPIOA->BSRR while
+// TIM1 runs. M0AR holds 32-bit addresses, so tests link with -no-pie and
+// give the DMA static buffers only.
+
+typedef enum {
+    HW_PIN,     // value is a BSRR write
+    HW_SPI      // value is a 16-bit SPI word
+} hw_event_t;
+
+typedef void (*hw_bus_fn_t)(hw_event_t event, uint32_t value);
+
+// Clear every register, detach the bus and start the DMA timer
+void hw_reset(void);
+
+// Receive bus events, NULL to stop
+void hw_set_bus(hw_bus_fn_t fn);
+
+// Pass bus events to a wire recorder and/or an emulator (either may be
+// NULL). SPI words shift straight into the emulator.
+typedef struct hw_wire hw_wire_t;
+void hw_attach(hw_wire_t *wire, max7219_emu_t *emu);
+
+// Deliver the last register write and run the DMA until it is idle
+void hw_sync(void);
+
+// Called by __WFI() instead of waiting for the timer, NULL for the default
+extern void (*hw_wfi_hook)(void);
+
+uint8_t hw_irq_enabled(IRQn_Type irq);
+
+// Wire recorder: the bits shifted between a CS falling and rising edge,
+// packed MSB first into bytes, one entry per latch. Bit-bang bits are
+// sampled on CLK rising edges with PA0 as DIN, PA1 as CS and PA2 as CLK.
+#define HW_WIRE_MAX_LATCHES 256
+#define HW_WIRE_MAX_BYTES   64
+
+struct hw_wire {
+    uint32_t pins;
+    uint16_t bits;                  // Bits of the latch being shifted
+    uint16_t latches;
+    uint8_t overflow;
+    uint16_t len[HW_WIRE_MAX_LATCHES];      // Bytes per latch
+    uint8_t data[HW_WIRE_MAX_LATCHES][HW_WIRE_MAX_BYTES];
+    uint8_t partial[HW_WIRE_MAX_BYTES];
+};
+
+void hw_wire_init(hw_wire_t *w);
+void hw_wire_event(hw_wire_t *w, hw_event_t event, uint32_t value);
+
+// 1 when both recorded the same latches with the same bytes
+uint8_t hw_wire_equal(const hw_wire_t *a, const hw_wire_t *b);
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef STM32F4XX_H
+#define STM32F4XX_H
+
+// Host stand-in for the CMSIS device header, for building the display
+// code on a PC (see hw.h). Only the registers and bits the firmware uses
+// are here; bit values match RM0368 so register dumps read the same.
+
+#include <stdint.h>
+
+#define __IO volatile
+
+typedef enum {
+    RTC_WKUP_IRQn      = 3,
+    DMA1_Stream3_IRQn  = 14,
+    TIM2_IRQn          = 28,
+    TIM3_IRQn          = 29,
+    USART1_IRQn        = 37,
+    DMA2_Stream1_IRQn  = 57,
+    DMA2_Stream2_IRQn  = 58,
+    DMA2_Stream3_IRQn  = 59,
+    HW_IRQ_COUNT       = 64
+} IRQn_Type;
+
+typedef struct {
+    __IO uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1, CR2, SR, DR, CRCPR, RXCRCR, TXCRCR, I2SCFGR, I2SPR;
+} SPI_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR;
+} DMA_Stream_TypeDef;
+
+typedef struct {
+    __IO uint32_t LISR, HISR, LIFCR, HIFCR;
+} DMA_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR;
+    __IO uint32_t CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR;
+} TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR, PLLCFGR, CFGR, CIR, AHB1RSTR, AHB2RSTR, APB1RSTR, APB2RSTR;
+    __IO uint32_t AHB1ENR, AHB2ENR, APB1ENR, APB2ENR, BDCR, CSR;
+} RCC_TypeDef;
+
+typedef struct {
+    __IO uint32_t ACR, KEYR, OPTKEYR, SR, CR, OPTCR;
+} FLASH_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR, CSR;
+} PWR_TypeDef;
+
+typedef struct {
+    __IO uint32_t SR, CR1, CR2, SMPR1, SMPR2, JOFR1, JOFR2, JOFR3, JOFR4, HTR, LTR;
+    __IO uint32_t SQR1, SQR2, SQR3, JSQR, JDR1, JDR2, JDR3, JDR4, DR;
+} ADC_TypeDef;
+
+typedef struct {
+    __IO uint32_t CSR, CCR, CDR;
+} ADC_Common_TypeDef;
+
+typedef struct {
+    __IO uint32_t CPUID, ICSR, VTOR, AIRCR, SCR, CCR;
+} SCB_Type;
+
+typedef struct {
+    __IO uint32_t CTRL, LOAD, VAL, CALIB;
+} SysTick_Type;
+
+// Register blocks, in hw.c. GPIOA and SPI1 go through an accessor so
+// the writes to BSRR and DR can be seen (hw.h).
+extern GPIO_TypeDef hw_gpioa_regs;
+extern SPI_TypeDef hw_spi1_regs;
+extern DMA_TypeDef hw_dma2_regs;
+extern DMA_Stream_TypeDef hw_dma2_streams[8];
+extern TIM_TypeDef hw_tim1_regs, hw_tim2_regs, hw_tim3_regs;
+extern RCC_TypeDef hw_rcc_regs;
+extern FLASH_TypeDef hw_flash_regs;
+extern PWR_TypeDef hw_pwr_regs;
+extern ADC_TypeDef hw_adc1_regs;
+extern ADC_Common_TypeDef hw_adc_regs;
+extern SCB_Type hw_scb_regs;
+extern SysTick_Type hw_systick_regs;
+
+GPIO_TypeDef *hw_gpioa(void);
+SPI_TypeDef *hw_spi1(void);
+
+#define GPIOA           (hw_gpioa())
+#define SPI1            (hw_spi1())
+#define DMA2            (&hw_dma2_regs)
+#define DMA2_Stream1    (&hw_dma2_streams[1])
+#define DMA2_Stream3    (&hw_dma2_streams[3])
+#define TIM1            (&hw_tim1_regs)
+#define TIM2            (&hw_tim2_regs)
+#define TIM3            (&hw_tim3_regs)
+#define RCC             (&hw_rcc_regs)
+#define FLASH           (&hw_flash_regs)
+#define PWR             (&hw_pwr_regs)
+#define ADC1            (&hw_adc1_regs)
+#define ADC             (&hw_adc_regs)
+#define SCB             (&hw_scb_regs)
+#define SysTick         (&hw_systick_regs)
+
+extern uint32_t SystemCoreClock;
+void SystemCoreClockUpdate(void);
+
+// Core functions
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __WFI(void);
+uint32_t SysTick_Config(uint32_t ticks);
+#define __NOP() ((void)0)
+
+// GPIO
+#define GPIO_MODER_MODER0_0         (1U << 0)
+#define GPIO_MODER_MODER1           (3U << 2)
+#define GPIO_MODER_MODER1_0         (1U << 2)
+#define GPIO_MODER_MODER2_0         (1U << 4)
+#define GPIO_MODER_MODER5           (3U << 10)
+#define GPIO_MODER_MODER5_1         (2U << 10)
+#define GPIO_MODER_MODER7           (3U << 14)
+#define GPIO_MODER_MODER7_1         (2U << 14)
+#define GPIO_OSPEEDER_OSPEEDR0_0    (1U << 0)
+#define GPIO_OSPEEDER_OSPEEDR1_0    (1U << 2)
+#define GPIO_OSPEEDER_OSPEEDR2_0    (1U << 4)
+#define GPIO_OSPEEDER_OSPEEDR5      (3U << 10)
+#define GPIO_OSPEEDER_OSPEEDR7      (3U << 14)
+
+// SPI
+#define SPI_CR1_MSTR        (1U << 2)
+#define SPI_CR1_BR_Pos      3
+#define SPI_CR1_BR          (7U << SPI_CR1_BR_Pos)
+#define SPI_CR1_SPE         (1U << 6)
+#define SPI_CR1_SSI         (1U << 8)
+#define SPI_CR1_SSM         (1U << 9)
+#define SPI_CR1_DFF         (1U << 11)
+#define SPI_CR2_RXDMAEN     (1U << 0)
+#define SPI_CR2_TXDMAEN     (1U << 1)
+#define SPI_SR_RXNE         (1U << 0)
+#define SPI_SR_TXE          (1U << 1)
+#define SPI_SR_BSY          (1U << 7)
+
+// DMA
+#define DMA_SxCR_EN         (1U << 0)
+#define DMA_SxCR_TCIE       (1U << 4)
+#define DMA_SxCR_DIR_0      (1U << 6)
+#define DMA_SxCR_MINC       (1U << 10)
+#define DMA_SxCR_PSIZE_0    (1U << 11)
+#define DMA_SxCR_PSIZE_1    (1U << 12)
+#define DMA_SxCR_MSIZE_0    (1U << 13)
+#define DMA_SxCR_MSIZE_1    (1U << 14)
+#define DMA_SxCR_CHSEL_Pos  25
+#define DMA_LISR_TCIF1      (1U << 11)
+#define DMA_LISR_TCIF3      (1U << 27)
+#define DMA_LIFCR_CFEIF1    (1U << 6)
+#define DMA_LIFCR_CDMEIF1   (1U << 8)
+#define DMA_LIFCR_CTEIF1    (1U << 9)
+#define DMA_LIFCR_CHTIF1    (1U << 10)
+#define DMA_LIFCR_CTCIF1    (1U << 11)
+#define DMA_LIFCR_CFEIF3    (1U << 22)
+#define DMA_LIFCR_CDMEIF3   (1U << 24)
+#define DMA_LIFCR_CTEIF3    (1U << 25)
+#define DMA_LIFCR_CHTIF3    (1U << 26)
+#define DMA_LIFCR_CTCIF3    (1U << 27)
+
+// Timers
+#define TIM_CR1_CEN         (1U << 0)
+#define TIM_CR1_ARPE        (1U << 7)
+#define TIM_DIER_UIE        (1U << 0)
+#define TIM_DIER_CC1DE      (1U << 9)
+#define TIM_SR_UIF          (1U << 0)
+#define TIM_EGR_UG          (1U << 0)
+
+// ADC
+#define ADC_SR_EOC          (1U << 1)
+#define ADC_CR2_ADON        (1U << 0)
+#define ADC_CR2_SWSTART     (1U << 30)
+#define ADC_CCR_ADCPRE      (3U << 16)
+#define ADC_CCR_ADCPRE_0    (1U << 16)
+
+// RCC
+#define RCC_CR_HSION            (1U << 0)
+#define RCC_CR_HSIRDY           (1U << 1)
+#define RCC_CR_PLLON            (1U << 24)
+#define RCC_CR_PLLRDY           (1U << 25)
+#define RCC_PLLCFGR_PLLM_Pos    0
+#define RCC_PLLCFGR_PLLN_Pos    6
+#define RCC_PLLCFGR_PLLP_Pos    16
+#define RCC_PLLCFGR_PLLSRC_HSI  0U
+#define RCC_PLLCFGR_PLLQ_Pos    24
+#define RCC_CFGR_SW             (3U << 0)
+#define RCC_CFGR_SW_HSI         (0U << 0)
+#define RCC_CFGR_SW_PLL         (2U << 0)
+#define RCC_CFGR_SWS            (3U << 2)
+#define RCC_CFGR_SWS_HSI        (0U << 2)
+#define RCC_CFGR_SWS_PLL        (2U << 2)
+#define RCC_CFGR_HPRE           (15U << 4)
+#define RCC_CFGR_PPRE1_Pos      10
+#define RCC_CFGR_PPRE1          (7U << RCC_CFGR_PPRE1_Pos)
+#define RCC_CFGR_PPRE2_Pos      13
+#define RCC_CFGR_PPRE2          (7U << RCC_CFGR_PPRE2_Pos)
+#define RCC_AHB1ENR_GPIOAEN     (1U << 0)
+#define RCC_AHB1ENR_GPIOBEN     (1U << 1)
+#define RCC_AHB1ENR_DMA1EN      (1U << 21)
+#define RCC_AHB1ENR_DMA2EN      (1U << 22)
+#define RCC_APB1ENR_TIM2EN      (1U << 0)
+#define RCC_APB1ENR_TIM3EN      (1U << 1)
+#define RCC_APB2ENR_TIM1EN      (1U << 0)
+#define RCC_APB2ENR_ADC1EN      (1U << 8)
+#define RCC_APB2ENR_SPI1EN      (1U << 12)
+#define RCC_CSR_RMVF            (1U << 24)
+#define RCC_CSR_IWDGRSTF        (1U << 29)
+
+// Flash, power and core
+#define FLASH_ACR_LATENCY_Pos   0
+#define FLASH_ACR_LATENCY       (15U << FLASH_ACR_LATENCY_Pos)
+#define FLASH_ACR_PRFTEN        (1U << 8)
+#define FLASH_ACR_ICEN          (1U << 9)
+#define FLASH_ACR_DCEN          (1U << 10)
+#define PWR_CR_LPDS             (1U << 0)
+#define PWR_CR_PDDS             (1U << 1)
+#define PWR_CR_FPDS             (1U << 9)
+#define SCB_SCR_SLEEPDEEP_Msk   (1U << 2)
+#define SysTick_CTRL_ENABLE_Msk (1U << 0)
+
+#endif
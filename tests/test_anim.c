@@ -0,0 +1,481 @@
+// Animation codec and player: random sequences go through
+// anim_encode_frame() and come back out of anim_decode_next(), from memory
+// and from an image streamed through stream.c, twice round the loop. The
+// WIPE, SLIDE and FADE compositions are checked millisecond by
+// millisecond against a column model, and zero-duration, malformed and
+// truncated records against what anim.h promises. Decode time per frame
+// is printed. With a file name argument the composed transition frames
+// are written there as one PBM, top to bottom:
+//
+//   ./test_anim frames.pbm
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "check.h"
+#include "anim.h"
+
+#define MAX_FRAMES 200
+#define RECORD_BUF (3 + 2 * (ANIM_FRAME_BYTES + ANIM_FRAME_BYTES / 128 + 1))
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// A sequence as written and as encoded
+typedef struct {
+    uint8_t devices;
+    uint16_t frames;
+    uint16_t loop_frame;
+    uint8_t frame[MAX_FRAMES][ANIM_FRAME_BYTES];
+    uint16_t ms[MAX_FRAMES];
+    anim_transition_t trans[MAX_FRAMES];
+    uint8_t data[MAX_FRAMES * RECORD_BUF];
+    uint32_t offset[MAX_FRAMES + 1];
+    uint32_t deltas;
+} seq_t;
+
+static seq_t seq;
+
+// Storage over an image in RAM, held busy while hold is set
+static uint8_t image[ANIM_IMAGE_HEADER + MAX_FRAMES * (2 + RECORD_BUF)];
+static uint32_t image_size;
+static uint8_t hold;
+
+static void ram_read(uint32_t addr, uint8_t *buf, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        buf[i] = addr + i < image_size ? image[addr + i] : 0xFF;
+    }
+}
+
+static uint8_t ram_busy(void) {
+    return hold;
+}
+
+static const storage_t ram = { ram_read, ram_busy };
+
+// Frames that move the way real content does: redrawn, nudged, blanked
+static void make_frames(uint8_t devices, uint16_t frames) {
+    uint16_t size = 8 * devices;
+
+    seq.devices = devices;
+    seq.frames = frames;
+    seq.loop_frame = (uint16_t)(rng() % frames);
+    for (uint16_t f = 0; f < frames; f++) {
+        uint8_t *cur = seq.frame[f];
+        if (f > 0) memcpy(cur, seq.frame[f - 1], size);
+        switch (f == 0 ? 0 : rng() % 4) {
+        case 0:
+            for (uint16_t i = 0; i < size; i++) cur[i] = (uint8_t)rng();
+            break;
+        case 1:
+            for (int k = 0; k < 3; k++) cur[rng() % size] ^= (uint8_t)(1 << rng() % 8);
+            break;
+        case 2:
+            memset(cur, rng() & 1 ? 0xFF : 0x00, size);
+            break;
+        default:
+            break;
+        }
+        seq.trans[f] = (anim_transition_t)(rng() % 4);
+        seq.ms[f] = rng() % 8 == 0 ? 0 : (uint16_t)(rng() % 1000);
+    }
+}
+
+// Records back to back; the loop frame is a key frame
+static void encode(void) {
+    uint16_t size = 8 * seq.devices;
+    uint8_t key[RECORD_BUF];
+    uint32_t o = 0;
+    int bad = 0;
+
+    seq.deltas = 0;
+    for (uint16_t f = 0; f < seq.frames; f++) {
+        const uint8_t *prev = f == 0 || f == seq.loop_frame ? NULL : seq.frame[f - 1];
+        seq.offset[f] = o;
+        uint16_t len = anim_encode_frame(prev, seq.frame[f], size, seq.ms[f], seq.trans[f],
+                                         &seq.data[o]);
+        uint16_t key_len = anim_encode_frame(NULL, seq.frame[f], size, seq.ms[f], seq.trans[f],
+                                             key);
+        uint8_t delta = (seq.data[o] & ANIM_TYPE_MASK) == ANIM_DELTA;
+        seq.deltas += delta;
+        if (len > key_len || (delta ? len == key_len : len != key_len) || len > ANIM_RECORD_MAX) {
+            bad++;
+        }
+        o += len;
+    }
+    seq.offset[seq.frames] = o;
+    CHECK(bad == 0, "%d records larger than needed or mistyped", bad);
+}
+
+// The sequence as an image: header, then length-prefixed records
+static void make_image(void) {
+    uint32_t o = ANIM_IMAGE_HEADER, loop = 0;
+
+    for (uint16_t f = 0; f < seq.frames; f++) {
+        uint32_t len = seq.offset[f + 1] - seq.offset[f];
+        if (f == seq.loop_frame) loop = o - ANIM_IMAGE_HEADER;
+        image[o++] = (uint8_t)len;
+        image[o++] = (uint8_t)(len >> 8);
+        memcpy(&image[o], &seq.data[seq.offset[f]], len);
+        o += len;
+    }
+    anim_seq_t s = { 0, seq.frames, seq.loop_frame, 0, seq.devices };
+    anim_image_header(&s, loop, o - ANIM_IMAGE_HEADER, image);
+    image_size = o;
+}
+
+// Frame k of playback, counting on through the loop
+static uint16_t played(uint32_t k) {
+    if (k < seq.frames) return (uint16_t)k;
+    return (uint16_t)(seq.loop_frame + (k - seq.frames) % (seq.frames - seq.loop_frame));
+}
+
+// Two times round: every frame, duration and transition as written
+static int check_decode(anim_decoder_t *d) {
+    uint8_t frame[ANIM_FRAME_BYTES] = { 0 };
+    anim_frame_info_t info;
+    uint32_t total = seq.frames + 2u * (seq.frames - seq.loop_frame);
+    int bad = 0;
+
+    for (uint32_t k = 0; k < total; k++) {
+        uint16_t f = played(k);
+        if (anim_decode_next(d, frame, &info) != 1) return -1;
+        if (memcmp(frame, seq.frame[f], 8u * seq.devices) != 0 || info.duration_ms != seq.ms[f] ||
+            info.transition != seq.trans[f]) {
+            bad++;
+        }
+    }
+    return bad;
+}
+
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// Fastest of several decodes of each frame, then mean and worst of those
+static void time_decode(void) {
+    static double best[MAX_FRAMES];
+    anim_seq_t s = { seq.data, seq.frames, seq.loop_frame, (uint16_t)seq.offset[seq.loop_frame],
+                     seq.devices };
+    uint8_t frame[ANIM_FRAME_BYTES];
+    anim_frame_info_t info;
+    anim_decoder_t d;
+
+    for (uint16_t f = 0; f < seq.frames; f++) best[f] = 1e18;
+    for (int round = 0; round < 50; round++) {
+        anim_decoder_start(&d, &s);
+        for (uint16_t f = 0; f < seq.frames; f++) {
+            double t0 = now_ns();
+            anim_decode_next(&d, frame, &info);
+            double t = now_ns() - t0;
+            if (t < best[f]) best[f] = t;
+        }
+    }
+    double sum = 0, worst = 0;
+    for (uint16_t f = 0; f < seq.frames; f++) {
+        sum += best[f];
+        if (best[f] > worst) worst = best[f];
+    }
+    printf("decode %u device(s): %u frames, %u deltas, %u bytes, %.0f ns/frame mean, %.0f max\n",
+           seq.devices, seq.frames, seq.deltas, seq.offset[seq.frames], sum / seq.frames, worst);
+}
+
+static void test_round_trip(void) {
+    static const uint16_t lengths[] = { 1, 2, 17, MAX_FRAMES };
+
+    for (uint8_t devices = 1; devices <= MAX7219_NUM_DEVICES; devices++) {
+        for (unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            make_frames(devices, lengths[l]);
+            encode();
+
+            anim_seq_t s = { seq.data, seq.frames, seq.loop_frame,
+                             (uint16_t)seq.offset[seq.loop_frame], devices };
+            anim_decoder_t d;
+            anim_decoder_start(&d, &s);
+            int bad = check_decode(&d);
+            CHECK(bad == 0, "%u device(s), %u frames, loop at %u: %d frames differ from memory",
+                  devices, seq.frames, seq.loop_frame, bad);
+
+            static uint8_t buf[2 * ANIM_STREAM_CHUNK];
+            anim_seq_t hs;
+            stream_t st;
+            make_image();
+            if (!anim_image_open(&hs, &st, &ram, buf, ANIM_STREAM_CHUNK, 0)) {
+                CHECK(0, "image of %u frames refused", seq.frames);
+                continue;
+            }
+            anim_decoder_stream(&d, &hs, &st);
+            bad = check_decode(&d);
+            CHECK(bad == 0, "%u device(s), %u frames, loop at %u: %d frames differ streamed",
+                  devices, seq.frames, seq.loop_frame, bad);
+
+            if (seq.frames == MAX_FRAMES) time_decode();
+        }
+    }
+}
+
+// Screen column x of a frame, bit 0 the top row
+static uint8_t column(const uint8_t *frame, uint16_t x) {
+    uint8_t col = 0;
+    for (int row = 0; row < 8; row++) {
+        if (frame[(x / 8) * 8 + row] & (0x80 >> (x % 8))) col |= 1 << row;
+    }
+    return col;
+}
+
+static void dump_frame(FILE *f, const uint8_t *frame, uint16_t width) {
+    for (int row = 0; row < 8; row++) {
+        for (uint16_t x = 0; x < width; x++) fputc(column(frame, x) >> row & 1 ? '1' : '0', f);
+        fputc('\n', f);
+    }
+}
+
+// Old frame A for 50 ms, then B entered with t over a frame of ms
+static void test_compose(anim_transition_t t, uint16_t ms, FILE *pbm) {
+    static const char *names[] = { "cut", "wipe", "slide", "fade" };
+    const uint16_t width = 8 * MAX7219_NUM_DEVICES;
+    uint8_t a[ANIM_FRAME_BYTES], b[ANIM_FRAME_BYTES];
+    uint8_t data[2 * RECORD_BUF];
+    anim_player_t p;
+    int bad = 0, flags_bad = 0;
+
+    for (int i = 0; i < ANIM_FRAME_BYTES; i++) {
+        a[i] = (uint8_t)rng();
+        b[i] = (uint8_t)rng();
+    }
+    uint16_t n = anim_encode_frame(NULL, a, ANIM_FRAME_BYTES, 50, ANIM_CUT, data);
+    anim_encode_frame(a, b, ANIM_FRAME_BYTES, ms, t, data + n);
+    anim_seq_t s = { data, 2, 0, 0, MAX7219_NUM_DEVICES };
+
+    anim_play(&p, &s, 12);
+    CHECK(p.ok && memcmp(p.out, a, sizeof(a)) == 0 && p.out_intensity == 12,
+          "%s: first frame not shown at once", names[t]);
+    anim_tick(&p, 50);
+
+    uint16_t trans = ms < ANIM_TRANSITION_MS ? ms : ANIM_TRANSITION_MS;
+    uint16_t half = trans / 2;
+    for (uint16_t e = 0; e < ms; e++) {
+        uint8_t want_intensity = 12;
+        uint16_t cols = (uint16_t)((uint32_t)width * e / trans);
+        for (uint16_t x = 0; x < width; x++) {
+            uint8_t col = column(b, x);
+            if (e < trans) {
+                if (t == ANIM_WIPE && x >= cols) col = column(a, x);
+                if (t == ANIM_SLIDE) col = x + cols < width ? column(a, x + cols)
+                                                            : column(b, x + cols - width);
+                if (t == ANIM_FADE && e < half) col = column(a, x);
+            }
+            if (column(p.out, x) != col) bad++;
+        }
+        if (t == ANIM_FADE && e < trans) {
+            want_intensity = e < half ? 12 * (half - e) / half : 12 * (e - half) / (trans - half);
+        }
+        if (p.out_intensity != want_intensity) bad++;
+        if (pbm) dump_frame(pbm, p.out, width);
+
+        uint8_t before[ANIM_FRAME_BYTES], before_intensity = p.out_intensity;
+        memcpy(before, p.out, sizeof(before));
+        uint8_t changed = anim_tick(&p, 1);
+        if (changed != (memcmp(before, p.out, sizeof(before)) != 0 ||
+                        before_intensity != p.out_intensity)) {
+            flags_bad++;
+        }
+    }
+    CHECK(bad == 0, "%s over %u ms: %d columns or intensities off the model", names[t], ms, bad);
+    CHECK(flags_bad == 0, "%s over %u ms: %d ticks misreport a change", names[t], ms, flags_bad);
+
+    // Back round to the first frame, which cuts in
+    CHECK(p.ok && memcmp(p.out, a, sizeof(a)) == 0 && p.out_intensity == 12,
+          "%s over %u ms: loop does not cut back to the first frame", names[t], ms);
+}
+
+// A zero duration is decoded as written and shown for one millisecond
+static void test_zero_duration(void) {
+    uint8_t frames[4][8] = { { 1 }, { 2 }, { 3 }, { 4 } };
+    uint8_t data[4 * RECORD_BUF];
+    uint16_t ms[4] = { 0, 0, 5, 0 };
+    uint16_t n = 0;
+    anim_player_t p;
+    anim_frame_info_t info;
+    anim_decoder_t d;
+    uint8_t frame[8];
+
+    for (int f = 0; f < 4; f++) {
+        n += anim_encode_frame(f ? frames[f - 1] : NULL, frames[f], 8, ms[f], ANIM_FADE, data + n);
+    }
+    anim_seq_t s = { data, 4, 0, 0, 1 };
+
+    anim_decoder_start(&d, &s);
+    CHECK(anim_decode_next(&d, frame, &info) == 1 && info.duration_ms == 0,
+          "zero duration decoded as %u", info.duration_ms);
+
+    // 0, 0, 5, 0 ms shown as 1, 1, 5, 1: the frame on at each millisecond
+    static const uint8_t want[] = { 1, 2, 3, 3, 3, 3, 3, 4, 1, 2, 3 };
+    int bad = 0;
+    anim_play(&p, &s, 8);
+    for (unsigned k = 0; k < sizeof(want); k++) {
+        if (p.cur[0] != want[k]) bad++;
+        anim_tick(&p, 1);
+    }
+    CHECK(bad == 0 && p.ok, "zero-duration frames: %d milliseconds on the wrong frame", bad);
+
+    // Nothing but zero durations: a long tick steps through, it does not hang
+    uint8_t zeros[4 * RECORD_BUF];
+    n = 0;
+    for (int f = 0; f < 4; f++) {
+        n += anim_encode_frame(NULL, frames[f], 8, 0, ANIM_CUT, zeros + n);
+    }
+    anim_seq_t z = { zeros, 4, 0, 0, 1 };
+    anim_play(&p, &z, 8);
+    anim_tick(&p, 1001);
+    CHECK(p.ok && p.cur[0] == frames[1001 % 4][0], "1001 ms of 1 ms frames end on frame %u",
+          p.cur[0] - 1);
+}
+
+// Bodies that cover more or less than the frame are refused
+static void test_malformed(void) {
+    static const uint8_t overrun_run[] = {
+        ANIM_FRAME(ANIM_KEY, ANIM_CUT, 10), ANIM_RUN(9), 0xFF,
+    };
+    static const uint8_t overrun_literals[] = {
+        ANIM_FRAME(ANIM_KEY, ANIM_CUT, 10), ANIM_LITERALS(6), 1, 2, 3, 4, 5, 6,
+        ANIM_LITERALS(3), 7, 8, 9,
+    };
+    static const uint8_t overrun_delta[] = {
+        ANIM_FRAME(ANIM_KEY, ANIM_CUT, 10), ANIM_RUN(8), 0x00,
+        ANIM_FRAME(ANIM_DELTA, ANIM_CUT, 10), ANIM_RUN(4), 0x01, ANIM_RUN(5), 0x02,
+    };
+    uint8_t frame[8] = { 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A };
+    anim_frame_info_t info;
+    anim_decoder_t d;
+    anim_player_t p;
+
+    anim_seq_t s = { overrun_run, 1, 0, 0, 1 };
+    anim_decoder_start(&d, &s);
+    CHECK(anim_decode_next(&d, frame, &info) == 0, "run past the frame decoded");
+    s.data = overrun_literals;
+    anim_decoder_start(&d, &s);
+    CHECK(anim_decode_next(&d, frame, &info) == 0, "literals past the frame decoded");
+
+    // A bad record stops the player for good
+    s.data = overrun_delta;
+    s.frames = 2;
+    anim_play(&p, &s, 5);
+    CHECK(p.ok, "good first frame refused");
+    uint8_t out[8];
+    memcpy(out, p.out, sizeof(out));
+    CHECK(anim_tick(&p, 10) == 0 && !p.ok, "player went on past a bad record");
+    CHECK(anim_tick(&p, 100) == 0 && memcmp(out, p.out, sizeof(out)) == 0,
+          "stopped player still changes its output");
+
+    anim_seq_t none = { overrun_run, 0, 0, 0, 1 };
+    anim_play(&p, &none, 5);
+    CHECK(!p.ok && anim_tick(&p, 10) == 0, "empty sequence plays");
+    anim_seq_t wide = { overrun_run, 1, 0, 0, MAX7219_NUM_DEVICES + 1 };
+    anim_play(&p, &wide, 5);
+    CHECK(!p.ok, "sequence wider than the chain plays");
+}
+
+// Streamed records whose length prefix disagrees with the body, lengths
+// out of range, bad headers, and records not in RAM yet
+static void test_truncated(void) {
+    static uint8_t buf[2 * ANIM_STREAM_CHUNK];
+    uint8_t frame[ANIM_FRAME_BYTES], before[ANIM_FRAME_BYTES];
+    anim_frame_info_t info;
+    anim_decoder_t d;
+    anim_seq_t hs;
+    stream_t st;
+
+    make_frames(MAX7219_NUM_DEVICES, 8);
+    seq.loop_frame = 0;
+    encode();
+
+    // Second record's length one short, one long, too short for a
+    // header and a byte, longer than any record
+    static const int32_t lengths[] = { -1, 1, 3, ANIM_RECORD_MAX + 1 };
+    for (unsigned c = 0; c < sizeof(lengths) / sizeof(lengths[0]); c++) {
+        make_image();
+        uint32_t at = ANIM_IMAGE_HEADER + 2 + (seq.offset[1] - seq.offset[0]);
+        uint32_t len = image[at] | (uint32_t)image[at + 1] << 8;
+        len = lengths[c] > 1 ? (uint32_t)lengths[c] : len + (uint32_t)lengths[c];
+        image[at] = (uint8_t)len;
+        image[at + 1] = (uint8_t)(len >> 8);
+
+        if (!anim_image_open(&hs, &st, &ram, buf, ANIM_STREAM_CHUNK, 0)) {
+            CHECK(0, "case %u: image refused", c);
+            continue;
+        }
+        anim_decoder_stream(&d, &hs, &st);
+        CHECK(anim_decode_next(&d, frame, &info) == 1, "case %u: first record lost", c);
+        CHECK(anim_decode_next(&d, frame, &info) == 0, "case %u: record of length %u decoded", c,
+              len);
+    }
+
+    // Nothing in RAM yet: wait, frame untouched
+    make_image();
+    if (anim_image_open(&hs, &st, &ram, buf, ANIM_STREAM_CHUNK, 0)) {
+        hold = 1;
+        anim_decoder_stream(&d, &hs, &st);
+        memset(frame, 0xA5, sizeof(frame));
+        memcpy(before, frame, sizeof(before));
+        CHECK(anim_decode_next(&d, frame, &info) == ANIM_WAIT &&
+              memcmp(frame, before, sizeof(frame)) == 0, "decoded before the read finished");
+        hold = 0;
+        CHECK(anim_decode_next(&d, frame, &info) == 1 &&
+              memcmp(frame, seq.frame[0], sizeof(frame)) == 0, "first record lost after a wait");
+    }
+
+    // Headers that must not open
+    static const struct {
+        uint8_t at, value;
+        const char *what;
+    } headers[] = {
+        { 0, 0x00, "bad magic" },
+        { 4, 0x00, "no frames" },           // frames is 8, low byte only
+        { 6, 0x08, "loop frame past the end" },
+        { 8, 0x00, "no devices" },
+        { 8, MAX7219_NUM_DEVICES + 1, "more devices than the chain" },
+        { 15, 0x7F, "loop offset past the end" },
+    };
+    for (unsigned c = 0; c < sizeof(headers) / sizeof(headers[0]); c++) {
+        make_image();
+        image[headers[c].at] = headers[c].value;
+        CHECK(!anim_image_open(&hs, &st, &ram, buf, ANIM_STREAM_CHUNK, 0), "%s opened",
+              headers[c].what);
+    }
+    make_image();
+    CHECK(!anim_image_open(&hs, &st, &ram, buf, ANIM_RECORD_MAX, 0),
+          "chunk of one record opened");
+    image_size = 0;
+    CHECK(!anim_image_open(&hs, &st, &ram, buf, ANIM_STREAM_CHUNK, 0), "erased flash opened");
+}
+
+int main(int argc, char **argv) {
+    FILE *pbm = NULL;
+    if (argc > 1 && !(pbm = fopen(argv[1], "w"))) {
+        perror(argv[1]);
+        return 1;
+    }
+    // Width, then 8 rows for every millisecond of the three transitions
+    if (pbm) fprintf(pbm, "P1\n%d %d\n", 8 * MAX7219_NUM_DEVICES, 8 * 3 * 300);
+
+    test_round_trip();
+    for (anim_transition_t t = ANIM_CUT; t <= ANIM_FADE; t++) {
+        test_compose(t, 300, t == ANIM_CUT ? NULL : pbm);
+        test_compose(t, 37, NULL);
+        test_compose(t, 1, NULL);
+    }
+    if (pbm) fclose(pbm);
+    test_zero_duration();
+    test_malformed();
+    test_truncated();
+    return check_done("test_anim");
+}
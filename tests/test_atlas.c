@@ -0,0 +1,178 @@
+// Glyph atlases: every glyph of atlas_builtin decodes to the rows and
+// metrics of the same code point in font.c, and so do the atlases fontc
+// writes from fonts/builtin.bdf in each of its -c modes (built into this
+// test by the Makefile). fontc is run again here to check that
+// atlas_builtin.c comes out of it byte for byte. Decode time per glyph is
+// printed for each mode. Run from tests/, as make does.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "check.h"
+#include "atlas.h"
+#include "font.h"
+
+#define FONTC "./fontc"
+#define FONT_SRC "../fonts/builtin.bdf"
+#define BUILTIN_SRC "../atlas_builtin.c"
+
+extern const atlas_t atlas_raw, atlas_crop, atlas_rows;
+
+static volatile uint8_t sink;
+
+static const struct {
+    const atlas_t *atlas;
+    const char *name;
+} atlases[] = {
+    { &atlas_builtin, "builtin" },
+    { &atlas_raw,     "raw" },
+    { &atlas_crop,    "crop" },
+    { &atlas_rows,    "rows" },
+};
+
+// Every code point of the font map against the atlas
+static void test_glyphs(const atlas_t *a, const char *name) {
+    int rows_bad = 0, metrics_bad = 0, covered = 0;
+    uint8_t rows[8];
+
+    for (uint32_t cp = FONT_FIRST_CODEPOINT; cp <= FONT_LAST_CODEPOINT; cp++) {
+        uint8_t g = font_index(cp);
+        uint16_t i = atlas_index(a, cp);
+        if (g == FONT_GLYPH_MISSING) {
+            if (i != a->missing && rows_bad++ < 2) {
+                CHECK(0, "%s: U+%04X has a glyph the font lacks", name, cp);
+            }
+            continue;
+        }
+        covered++;
+
+        atlas_decode(a, i, rows);
+        if (memcmp(rows, font_glyphs[g], 8) != 0 && rows_bad++ < 2) {
+            CHECK(0, "%s: U+%04X decodes differently from font_glyphs", name, cp);
+        }
+
+        // 8x8 cells carry no metrics; a blank glyph is width 0 here
+        uint8_t lit = 0;
+        for (int r = 0; r < 8; r++) lit |= font_glyphs[g][r];
+        uint8_t left = a->flags & ATLAS_CROPPED ? font_left(g) : 0;
+        uint8_t width = !(a->flags & ATLAS_CROPPED) ? 8 : lit ? font_width(g) : 0;
+        if ((atlas_left(a, i) != left || atlas_width(a, i) != width) && metrics_bad++ < 2) {
+            CHECK(0, "%s: U+%04X left %u width %u, font %u %u", name, cp, atlas_left(a, i),
+                  atlas_width(a, i), left, width);
+        }
+    }
+    CHECK(rows_bad == 0 && metrics_bad == 0, "%s: %d glyphs and %d metrics differ", name,
+          rows_bad, metrics_bad);
+    CHECK(covered + 1 == a->glyphs, "%s: %u glyphs, the font maps %d and a missing glyph", name,
+          a->glyphs, covered);
+
+    // The missing glyph, and indices that are none
+    atlas_decode(a, a->missing, rows);
+    CHECK(memcmp(rows, font_glyphs[FONT_GLYPH_MISSING], 8) == 0 &&
+          atlas_index(a, 0x1F600) == a->missing && atlas_index(a, 0x10) == a->missing,
+          "%s: missing glyph differs", name);
+    static const uint8_t blank[8];
+    atlas_decode(a, ATLAS_NO_GLYPH, rows);
+    CHECK(memcmp(rows, blank, 8) == 0, "%s: ATLAS_NO_GLYPH not blank", name);
+    atlas_decode(a, a->glyphs, rows);
+    CHECK(memcmp(rows, blank, 8) == 0 && atlas_width(a, a->glyphs) == 0,
+          "%s: index past the end not blank", name);
+}
+
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// Fastest of 200 decodes of each glyph; the walk from the start of its
+// group makes the last of a group the slowest
+static void time_decode(const atlas_t *a, const char *name) {
+    uint8_t rows[8];
+    double sum = 0, worst = 0;
+    uint16_t worst_glyph = 0;
+
+    for (uint16_t g = 0; g < a->glyphs; g++) {
+        double best = 1e18;
+        for (int k = 0; k < 200; k++) {
+            double t0 = now_ns();
+            atlas_decode(a, g, rows);
+            double t = now_ns() - t0;
+            sink = rows[7];
+            if (t < best) best = t;
+        }
+        sum += best;
+        if (best > worst) {
+            worst = best;
+            worst_glyph = g;
+        }
+    }
+    printf("decode %-7s: %u glyphs, %.0f ns/glyph mean, %.0f max (glyph %u)\n", name, a->glyphs,
+           sum / a->glyphs, worst, worst_glyph);
+}
+
+static long read_all(FILE *f, char *buf, long size) {
+    long n = 0;
+    size_t r;
+    while (n < size && (r = fread(buf + n, 1, (size_t)(size - n), f)) > 0) n += (long)r;
+    return n;
+}
+
+// What fontc writes for atlas_builtin with the given options
+static long fontc(const char *options, char *out, long size) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), FONTC " -n atlas_builtin %s " FONT_SRC " 2>/dev/null", options);
+    FILE *p = popen(cmd, "r");
+    if (!p) return -1;
+    long n = read_all(p, out, size);
+    return pclose(p) == 0 ? n : -1;
+}
+
+// atlas_builtin.c is what fontc picks by itself, and what -c crop forces
+static void test_regenerate(void) {
+    static char want[65536], got[65536];
+    static const struct {
+        const char *options;
+        const char *flags;
+        int same;
+    } modes[] = {
+        { "",        ".flags = ATLAS_CROPPED,", 1 },
+        { "-c crop", ".flags = ATLAS_CROPPED,", 1 },
+        { "-c raw",  ".flags = 0,", 0 },
+        { "-c rows", ".flags = ATLAS_CROPPED | ATLAS_ROW_MASK,", 0 },
+    };
+
+    FILE *f = fopen(BUILTIN_SRC, "r");
+    if (!f) {
+        CHECK(0, "cannot read " BUILTIN_SRC);
+        return;
+    }
+    long n = read_all(f, want, sizeof(want));
+    fclose(f);
+
+    for (unsigned m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        long len = fontc(modes[m].options, got, sizeof(got) - 1);
+        if (len < 0) {
+            CHECK(0, "fontc %s failed", modes[m].options);
+            continue;
+        }
+        got[len] = '\0';
+        if (modes[m].same) {
+            CHECK(len == n && memcmp(got, want, (size_t)n) == 0,
+                  "fontc %s does not regenerate " BUILTIN_SRC, modes[m].options);
+        } else {
+            CHECK(strstr(got, modes[m].flags) != NULL, "fontc %s wrote another mode",
+                  modes[m].options);
+        }
+    }
+}
+
+int main(void) {
+    for (unsigned i = 0; i < sizeof(atlases) / sizeof(atlases[0]); i++) {
+        test_glyphs(atlases[i].atlas, atlases[i].name);
+    }
+    test_regenerate();
+    for (unsigned i = 0; i < sizeof(atlases) / sizeof(atlases[0]); i++) {
+        time_decode(atlases[i].atlas, atlases[i].name);
+    }
+    return check_done("test_atlas");
+}
@@ -0,0 +1,163 @@
+// Bit-slicing kernel: the transposed encoding is compared with a plain
+// bit-by-bit reference for every chain count, then slice.c drives one
+// model per chain from the shared GPIOA writes and every chain must show
+// its own frame.
+#include <stdlib.h>
+#include "check.h"
+#include "hw.h"
+#include "bitslice.h"
+#include "slice.h"
+
+#define MAX_LEN 32
+
+// What the kernel is meant to compute, one bit of one chain at a time
+static void encode_ref(const uint8_t *din_pins, uint8_t chains, uint8_t clk_pin,
+                       const uint8_t *const *src, uint16_t len, uint32_t *out) {
+    for (uint16_t k = 0; k < len; k++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            uint32_t word = 1UL << (clk_pin + 16);
+            for (uint8_t c = 0; c < chains; c++) {
+                word |= (src[c][k] >> bit) & 1 ? 1UL << din_pins[c] : 1UL << (din_pins[c] + 16);
+            }
+            *out++ = word;
+        }
+    }
+}
+
+static void latch_ref(const uint8_t *din_pins, uint8_t chains, uint8_t clk_pin, uint8_t cs_pin,
+                      const uint8_t *const *src, uint16_t len, uint32_t *out) {
+    uint32_t data[8 * MAX_LEN];
+
+    encode_ref(din_pins, chains, clk_pin, src, len, data);
+    *out++ = 1UL << (cs_pin + 16) | 1UL << (clk_pin + 16);
+    for (int i = 0; i < 8 * len; i++) {
+        *out++ = data[i];
+        *out++ = 1UL << clk_pin;
+    }
+    *out = 1UL << cs_pin | 1UL << (clk_pin + 16);
+}
+
+static void test_encode(void) {
+    static uint8_t data[BITSLICE_MAX_CHAINS][MAX_LEN];
+    static uint32_t got[BITSLICE_LATCH_WORDS(MAX_LEN)], want[BITSLICE_LATCH_WORDS(MAX_LEN)];
+    const uint8_t *src[BITSLICE_MAX_CHAINS];
+    uint8_t pins[BITSLICE_MAX_CHAINS];
+    bitslice_t b;
+
+    srand(21);
+    for (uint8_t chains = 1; chains <= BITSLICE_MAX_CHAINS; chains++) {
+        // Distinct DIN pins other than CLK (2) and CS (1), shuffled; past
+        // fourteen chains the pins have to be shared
+        uint8_t free_pins[14] = { 0, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+        for (int i = 13; i > 0; i--) {
+            int j = rand() % (i + 1);
+            uint8_t t = free_pins[i];
+            free_pins[i] = free_pins[j];
+            free_pins[j] = t;
+        }
+        for (int c = 0; c < chains; c++) {
+            pins[c] = free_pins[c % 14];
+        }
+        bitslice_init(&b, pins, chains, 2);
+
+        for (int round = 0; round < 20; round++) {
+            uint16_t len = (uint16_t)(rand() % MAX_LEN + 1);
+            for (int c = 0; c < chains; c++) {
+                for (int k = 0; k < len; k++) {
+                    data[c][k] = (uint8_t)rand();
+                }
+                src[c] = data[c];
+            }
+
+            bitslice_encode(&b, src, len, got);
+            encode_ref(pins, chains, 2, src, len, want);
+            int bad = 0;
+            for (int i = 0; i < 8 * len; i++) {
+                bad += got[i] != want[i];
+            }
+            CHECK(bad == 0, "%u chains, %u bytes: %d words differ", chains, len, bad);
+
+            uint16_t n = bitslice_encode_latch(&b, src, len, 1, got);
+            latch_ref(pins, chains, 2, 1, src, len, want);
+            CHECK(n == BITSLICE_LATCH_WORDS(len), "%u chains: latch of %u words", chains, n);
+            bad = 0;
+            for (int i = 0; i < n; i++) {
+                bad += got[i] != want[i];
+            }
+            CHECK(bad == 0, "%u chains, %u bytes: %d latch words differ", chains, len, bad);
+        }
+    }
+}
+
+static const uint8_t slice_pins[SLICE_NUM_CHAINS] = SLICE_DIN_PINS;
+static max7219_emu_t chain_emu[SLICE_NUM_CHAINS];
+
+// Every chain sees the whole port and picks its own DIN
+static void chains_bus(hw_event_t event, uint32_t value) {
+    if (event != HW_PIN) return;
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        max7219_emu_bsrr(&chain_emu[c], value);
+    }
+}
+
+static void test_slice(void) {
+    static uint16_t frames[SLICE_NUM_CHAINS][MAX7219_FRAME_WORDS];
+    const uint16_t *chains[SLICE_NUM_CHAINS];
+
+    hw_reset();
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        max7219_emu_init(&chain_emu[c], slice_pins[c], CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    }
+    max7219_emu_init(&max7219_emu, slice_pins[0], CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_set_bus(chains_bus);
+
+    slice_init();
+    slice_send_cmd(REG_SCAN_LIMIT, 0x07);
+    slice_send_cmd(REG_SHUTDOWN, 0x01);
+    slice_send_cmd(REG_INTENSITY, 0x06);
+
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        for (int row = 0; row < 8; row++) {
+            for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                frames[c][MAX7219_FRAME_INDEX(row, dev)] =
+                    MAX7219_WORD(REG_DIGIT0 + row, c * 0x40 + row * 8 + dev);
+            }
+        }
+        chains[c] = frames[c];
+    }
+    slice_send_frame(chains, 8);
+    hw_set_bus(NULL);
+
+    for (int c = 0; c < SLICE_NUM_CHAINS; c++) {
+        CHECK(chain_emu[c].latches == 11, "chain %d latched %u times", c, chain_emu[c].latches);
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            CHECK(chain_emu[c].regs[dev].intensity == 0x06, "chain %d device %d intensity %u", c,
+                  dev, chain_emu[c].regs[dev].intensity);
+            for (int row = 0; row < 8; row++) {
+                uint8_t want = (uint8_t)(c * 0x40 + row * 8 + dev);
+                CHECK(max7219_emu_row(&chain_emu[c], dev, row) == want,
+                      "chain %d device %d row %d = %02X, not %02X", c, dev, row,
+                      max7219_emu_row(&chain_emu[c], dev, row), want);
+            }
+        }
+    }
+    CHECK(slice_bytes_sent() == 11UL * SLICE_NUM_CHAINS * 2 * MAX7219_NUM_DEVICES,
+          "%u bytes counted", slice_bytes_sent());
+
+#ifdef MAX7219_EMULATOR
+    // The driver's own mirror is chain 0 on PA0
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            CHECK(max7219_emu_row(&max7219_emu, dev, row) ==
+                  max7219_emu_row(&chain_emu[0], dev, row), "mirror device %d row %d differs", dev,
+                  row);
+        }
+    }
+#endif
+}
+
+int main(void) {
+    test_encode();
+    test_slice();
+    return check_done("test_bitslice");
+}
@@ -0,0 +1,247 @@
+// Ambient brightness loop: sensor traces (a light switched on, dusk, a
+// flickering lamp, noise on a step boundary) are replayed through
+// brightness_update() and checked against a floating point model of the
+// filter and the step rules. brightness_task() is run against the ADC
+// registers with the display side stubbed.
+#include <math.h>
+#include <stdlib.h>
+#include "check.h"
+#include "hw.h"
+#include "brightness.h"
+#include "max7219.h"
+#include "framebuffer.h"
+
+#define H BRIGHTNESS_HYSTERESIS
+
+static uint8_t intensity, holds;
+static uint32_t writes, unheld_writes;
+
+uint8_t max7219_get_intensity(void) { return intensity; }
+void fb_vsync_hold(void) { holds++; }
+void fb_vsync_release(void) { holds--; }
+
+void max7219_set_intensity(uint8_t level) {
+    intensity = level;
+    writes++;
+    if (!holds) unheld_writes++;
+}
+
+// Lower edge of a level's step, as brightness.c splits the ADC range
+static uint32_t step_start(uint8_t min, uint8_t max, uint8_t level) {
+    return (uint32_t)(level - min) * (BRIGHTNESS_ADC_MAX + 1) / (max - min + 1);
+}
+
+static uint16_t clamp_adc(int v) {
+    return (uint16_t)(v < 0 ? 0 : v > BRIGHTNESS_ADC_MAX ? BRIGHTNESS_ADC_MAX : v);
+}
+
+static int noise(int amplitude) {
+    return rand() % (2 * amplitude + 1) - amplitude;
+}
+
+#define TRACE_LEN 2000
+
+typedef struct {
+    const char *name;
+    uint16_t s[TRACE_LEN];
+    int n;
+} trace_t;
+
+static trace_t traces[4];
+
+static void make_traces(void) {
+    srand(12);
+
+    // Room light switched on, then off again
+    trace_t *t = &traces[0];
+    t->name = "switch";
+    for (t->n = 0; t->n < 600; t->n++) {
+        int on = t->n >= 200 && t->n < 400;
+        t->s[t->n] = clamp_adc((on ? 3900 : 80) + noise(20));
+    }
+
+    // Dusk: full daylight to dark
+    t = &traces[1];
+    t->name = "dusk";
+    for (t->n = 0; t->n < TRACE_LEN; t->n++) {
+        t->s[t->n] = clamp_adc(3800 - 3700 * t->n / TRACE_LEN + noise(30));
+    }
+
+    // Mains ripple under a lamp, aliased by the slow sampling
+    t = &traces[2];
+    t->name = "flicker";
+    for (t->n = 0; t->n < TRACE_LEN; t->n++) {
+        t->s[t->n] = clamp_adc(2000 + (int)(400 * sin(2 * M_PI * 0.37 * t->n)) + noise(40));
+    }
+
+    // Dithering across the boundary between the two lowest steps
+    t = &traces[3];
+    t->name = "boundary";
+    for (t->n = 0; t->n < TRACE_LEN; t->n++) {
+        uint32_t edge = step_start(1, 15, 2);
+        t->s[t->n] = clamp_adc((int)edge + ((t->n / 7) & 1 ? H - 1 : -(H - 1)));
+    }
+}
+
+// Filter against the model, one step per call, levels inside min..max and
+// only past the hysteresis band
+static void test_traces(void) {
+    for (int i = 0; i < 4; i++) {
+        const trace_t *t = &traces[i];
+        brightness_t b;
+        double model = 0;
+        int filter_off = 0, jumps = 0, range = 0, early = 0;
+
+        brightness_init(&b, 1, 15);
+        uint8_t last = b.level;
+        for (int k = 0; k < t->n; k++) {
+            uint8_t level = brightness_update(&b, t->s[k]);
+            model = k == 0 ? t->s[k] : model + (t->s[k] - model) / (1 << BRIGHTNESS_FILTER_SHIFT);
+            uint16_t light = brightness_filtered(&b);
+
+            if (fabs(light - model) > 1) filter_off++;
+            if (abs(level - last) > 1) jumps++;
+            if (level < 1 || level > 15) range++;
+            if (level > last && light < (int)step_start(1, 15, level) + H) early++;
+            if (level < last && light + H >= (int)step_start(1, 15, last)) early++;
+            last = level;
+        }
+        CHECK(filter_off == 0, "%s: filter off the EMA model %d times", t->name, filter_off);
+        CHECK(jumps == 0, "%s: %d changes of more than one step", t->name, jumps);
+        CHECK(range == 0, "%s: level out of range %d times", t->name, range);
+        CHECK(early == 0, "%s: %d steps inside the hysteresis band", t->name, early);
+    }
+
+    // The boundary trace never leaves the step the loop settled in
+    brightness_t b;
+    brightness_init(&b, 1, 15);
+    for (int k = 0; k < 64; k++) brightness_update(&b, traces[3].s[0]);
+    uint8_t settled = b.level;
+    int changes = 0;
+    for (int k = 0; k < traces[3].n; k++) {
+        changes += brightness_update(&b, traces[3].s[k]) != settled;
+    }
+    CHECK(changes == 0, "boundary noise changed the level %d times", changes);
+}
+
+// Samples until a step of the input is within the hysteresis band
+static void test_settling(void) {
+    brightness_t b;
+    double model = 0;
+    int want = -1, got = -1;
+
+    brightness_init(&b, 0, 15);
+    brightness_update(&b, 0);
+    for (int k = 1; k < 200 && (want < 0 || got < 0); k++) {
+        brightness_update(&b, BRIGHTNESS_ADC_MAX);
+        model += (BRIGHTNESS_ADC_MAX - model) / (1 << BRIGHTNESS_FILTER_SHIFT);
+        if (want < 0 && BRIGHTNESS_ADC_MAX - model <= H) want = k;
+        if (got < 0 && BRIGHTNESS_ADC_MAX - brightness_filtered(&b) <= H) got = k;
+    }
+    CHECK(want == 32 && abs(got - want) <= 1, "dark to full light settles in %d samples, not %d",
+          got, want);
+
+    // The level follows one step per sample behind the filter: dark to
+    // full light takes the 15 steps at least
+    brightness_init(&b, 0, 15);
+    for (int k = 0; k < 100; k++) brightness_update(&b, 0);
+    CHECK(b.level == 0, "dark settles at level %u", b.level);
+    int k = 0;
+    while (b.level < 15 && k < 200) {
+        brightness_update(&b, BRIGHTNESS_ADC_MAX);
+        k++;
+    }
+    CHECK(k >= 15 && k <= want + 15, "dark to full light in %d samples", k);
+}
+
+// Inside [start(L) - H, start(L + 1) + H) the level stays at L
+static void test_hysteresis(void) {
+    int bad = 0;
+
+    srand(7);
+    for (uint8_t level = 0; level < 15; level++) {
+        brightness_t b;
+        uint32_t lo = step_start(0, 15, level), hi = step_start(0, 15, level + 1);
+        uint32_t centre = (lo + hi) / 2;
+
+        brightness_init(&b, 0, 15);
+        for (int k = 0; k < 100; k++) brightness_update(&b, (uint16_t)centre);
+        if (b.level != level) {
+            CHECK(0, "centre of step %u settles at %u", level, b.level);
+            continue;
+        }
+
+        int band_lo = level == 0 ? 0 : (int)lo - H;
+        int band_hi = (int)hi + H - 1;
+        for (int k = 0; k < 500; k++) {
+            uint16_t s = (uint16_t)(band_lo + rand() % (band_hi - band_lo + 1));
+            if (brightness_update(&b, s) != level) bad++;
+        }
+        for (int k = 0; k < 200; k++) brightness_update(&b, (uint16_t)band_hi);
+        if (b.level != level) bad++;
+
+        // Past the band it steps up. The filter creeps up on a constant
+        // reading from below and its integer part stops one count short.
+        for (int k = 0; k < 200 && b.level == level; k++) {
+            brightness_update(&b, (uint16_t)(hi + H + 1));
+        }
+        CHECK(b.level == level + 1, "step %u: %u counts in, level %u", level, H + 1, b.level);
+    }
+    CHECK(bad == 0, "%d changes inside the hysteresis band", bad);
+}
+
+static void test_clamp(void) {
+    brightness_t b;
+
+    brightness_init(&b, 2, 9);
+    CHECK(b.level == 9, "starts at level %u, not the maximum", b.level);
+    for (int k = 0; k < 200; k++) brightness_update(&b, 0);
+    CHECK(b.level == 2, "dark gives level %u, not 2", b.level);
+    for (int k = 0; k < 200; k++) brightness_update(&b, BRIGHTNESS_ADC_MAX);
+    CHECK(b.level == 9, "full light gives level %u, not 9", b.level);
+
+    // Maximum below the minimum, and levels past the 4-bit register
+    brightness_init(&b, 12, 3);
+    for (int k = 0; k < 50; k++) brightness_update(&b, (uint16_t)(k & 1 ? 0 : 4095));
+    CHECK(b.min_level == 12 && b.max_level == 12 && b.level == 12, "12..3 gives %u..%u at %u",
+          b.min_level, b.max_level, b.level);
+    brightness_init(&b, 0x10, 0x1F);
+    CHECK(b.min_level == 0 && b.max_level == 15, "0x10..0x1F gives %u..%u", b.min_level,
+          b.max_level);
+}
+
+// The task reads the ADC and writes the intensity only when it changes
+static void test_task(void) {
+    const trace_t *t = &traces[0];
+    uint32_t changes = 0;
+
+    hw_reset();
+    light_sensor_init();
+    CHECK(ADC1->SQR3 == LIGHT_SENSOR_CHANNEL && (ADC1->CR2 & ADC_CR2_ADON), "ADC not set up");
+
+    brightness_init(&ambient_brightness, 1, 15);
+    intensity = 15;
+    writes = unheld_writes = 0;
+    uint8_t last = intensity;
+    for (int k = 0; k < t->n; k++) {
+        ADC1->DR = t->s[k];
+        ADC1->SR = ADC_SR_EOC;
+        brightness_task();
+        changes += intensity != last;
+        last = intensity;
+    }
+    CHECK(writes == changes && changes > 0, "%u intensity writes for %u changes", writes,
+          changes);
+    CHECK(unheld_writes == 0 && holds == 0, "%u writes outside a vsync hold", unheld_writes);
+    CHECK(intensity == 1, "switch trace ends at intensity %u", intensity);
+}
+
+int main(void) {
+    make_traces();
+    test_traces();
+    test_settling();
+    test_hysteresis();
+    test_clamp();
+    test_task();
+    return check_done("test_brightness");
+}
@@ -0,0 +1,164 @@
+// Canvas viewport: a random canvas is rendered onto a serpentine 4x2 grid
+// in all 16 rotate and flip mountings, sent with fb_flush() to the model
+// of the chain, and every pixel of the physical 32x16 panel is compared
+// with canvas_get(). The panel-to-device mapping is worked out here from
+// the mounting rules in canvas.h (flip, then turn clockwise), the other
+// way round from viewport_render(). Viewports run off every edge of the
+// canvas and past it.
+#include <stdlib.h>
+#include "check.h"
+#include "hw.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "canvas.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+#define GRID_COLS 4
+#define GRID_ROWS 2
+#define PANEL_W   (8 * GRID_COLS)
+#define PANEL_H   (8 * GRID_ROWS)
+
+// Not a multiple of 8, so rows end inside a byte
+#define CANVAS_WIDTH  45
+#define CANVAS_HEIGHT 21
+
+_Static_assert(MAX7219_NUM_DEVICES == GRID_COLS * GRID_ROWS, "one device per grid cell");
+
+static uint8_t canvas_buf[((CANVAS_WIDTH + 7) / 8) * CANVAS_HEIGHT];
+static canvas_t canvas;
+static max7219_emu_t emu;
+
+// Chain order of the serpentine grid: left to right on row 0, right to
+// left on row 1
+static uint8_t device_at(uint8_t col, uint8_t row) {
+    return (uint8_t)(row * GRID_COLS + (row & 1 ? GRID_COLS - 1 - col : col));
+}
+
+// Device pixel behind cell pixel (cx, cy): the mounting undone, turned
+// back anticlockwise, then unflipped
+static void cell_to_device(uint8_t orient, int cx, int cy, int *dx, int *dy) {
+    int u = cx, v = cy;
+    for (int r = 0; r < (orient & MODULE_ROT_MASK); r++) {
+        int t = u;
+        u = v;
+        v = 7 - t;
+    }
+    *dx = orient & MODULE_FLIP_X ? 7 - u : u;
+    *dy = orient & MODULE_FLIP_Y ? 7 - v : v;
+}
+
+static void fill_canvas(void) {
+    canvas_init(&canvas, canvas_buf, CANVAS_WIDTH, CANVAS_HEIGHT);
+    for (int y = 0; y < CANVAS_HEIGHT; y++) {
+        for (int x = 0; x < CANVAS_WIDTH; x++) {
+            canvas_pixel(&canvas, (int16_t)x, (int16_t)y, rand() & 1);
+        }
+        // Padding past the right edge is never shown
+        canvas_buf[y * canvas.stride + canvas.stride - 1] |= 0xFF >> (CANVAS_WIDTH % 8);
+    }
+    // A border, so the edges are lit wherever the random pixels are not
+    canvas_rect(&canvas, 0, 0, CANVAS_WIDTH, CANVAS_HEIGHT, 1, 0);
+}
+
+// Render, flush and compare the panel; returns the pixels that differ
+static int check_view(const layout_t *l, uint8_t orient, int16_t x, int16_t y) {
+    uint8_t rows[MAX7219_NUM_DEVICES][8];
+    int bad = 0;
+
+    viewport_render(&canvas, l, x, y, rows);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int r = 0; r < 8; r++) fb_set_row((uint8_t)dev, (uint8_t)r, rows[dev][r]);
+    }
+    fb_flush();
+    hw_sync();
+
+    for (int py = 0; py < PANEL_H; py++) {
+        for (int px = 0; px < PANEL_W; px++) {
+            int dx, dy;
+            uint8_t dev = device_at((uint8_t)(px / 8), (uint8_t)(py / 8));
+            cell_to_device(orient, px % 8, py % 8, &dx, &dy);
+            uint8_t lit = (max7219_emu_row(&emu, dev, (uint8_t)dy) >> (7 - dx)) & 1;
+            uint8_t want = canvas_get(&canvas, (int16_t)(x + px), (int16_t)(y + py));
+            if (lit != want && bad++ < 2) {
+                CHECK(0, "orient %X at (%d, %d): panel (%d, %d) is %u, canvas %u", orient, x, y,
+                      px, py, lit, want);
+            }
+        }
+    }
+    return bad;
+}
+
+static void test_orientations(void) {
+    static const int16_t views[][2] = {
+        { 0, 0 },                                            // Top left
+        { 7, 3 },
+        { CANVAS_WIDTH - PANEL_W, CANVAS_HEIGHT - PANEL_H }, // Bottom right, flush
+        { -5, -3 },                                          // Off the top and left
+        { CANVAS_WIDTH - 20, CANVAS_HEIGHT - 9 },            // Off the bottom and right
+        { -9, 11 },
+        { CANVAS_WIDTH - 1, CANVAS_HEIGHT - 1 },             // One pixel in
+        { -PANEL_W, -PANEL_H },                              // Just clear of it
+        { 200, -100 },
+    };
+    layout_t l;
+
+    hw_reset();
+    max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_attach(NULL, &emu);
+    transport_init(TRANSPORT_BITBANG);
+    init_max7219(0x04);
+    fb_init();
+
+    for (uint8_t orient = 0; orient < 16; orient++) {
+        layout_grid(&l, GRID_COLS, GRID_ROWS, 1, orient);
+
+        int cells = 0;
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            const module_place_t *m = &l.modules[dev];
+            cells += m->col < GRID_COLS && m->row < GRID_ROWS && device_at(m->col, m->row) == dev &&
+                     m->orient == orient;
+        }
+        CHECK(cells == MAX7219_NUM_DEVICES, "orient %X: %d of %d modules placed serpentine",
+              orient, cells, MAX7219_NUM_DEVICES);
+
+        int bad = 0;
+        for (unsigned v = 0; v < sizeof(views) / sizeof(views[0]); v++) {
+            bad += check_view(&l, orient, views[v][0], views[v][1]);
+        }
+        CHECK(bad == 0, "orient %X: %d panel pixels differ from the canvas", orient, bad);
+    }
+
+    // Every viewport position across the canvas and a module beyond
+    layout_grid(&l, GRID_COLS, GRID_ROWS, 1, MODULE_ROT_90 | MODULE_FLIP_X);
+    int bad = 0;
+    for (int16_t y = -PANEL_H; y <= CANVAS_HEIGHT; y += 3) {
+        for (int16_t x = -PANEL_W; x <= CANVAS_WIDTH; x += 5) {
+            bad += check_view(&l, MODULE_ROT_90 | MODULE_FLIP_X, x, y);
+        }
+    }
+    CHECK(bad == 0, "sweep: %d panel pixels differ from the canvas", bad);
+    hw_set_bus(NULL);
+}
+
+// Padding bits and off-canvas reads come back dark
+static void test_edges(void) {
+    int lit = 0;
+    for (int y = -2; y < CANVAS_HEIGHT + 2; y++) {
+        for (int x = CANVAS_WIDTH; x < 8 * canvas.stride + 2; x++) {
+            lit += canvas_get(&canvas, (int16_t)x, (int16_t)y);
+        }
+        lit += canvas_get(&canvas, -1, (int16_t)y);
+    }
+    CHECK(lit == 0, "%d pixels lit off the canvas", lit);
+}
+
+int main(void) {
+    srand(18);
+    fill_canvas();
+    test_edges();
+    test_orientations();
+    return check_done("test_canvas");
+}
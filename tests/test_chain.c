@@ -0,0 +1,105 @@
+// A 16-module chain: the bit stream shifted per latch is recorded from the
+// pins (bit-bang) or the SPI (SPI+DMA) and checked word by word, then the
+// model shows whether every device ended up with its own data.
+#include "check.h"
+#include "hw.h"
+#include "max7219.h"
+
+_Static_assert(MAX7219_NUM_DEVICES == 16, "build with -DMAX7219_NUM_DEVICES=16");
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+static const char *names[] = { "bitbang", "spi_dma" };
+
+// Word latch l of the recording carries for dev (shift order: last device first)
+static uint16_t recorded(const hw_wire_t *w, int l, int dev) {
+    int i = MAX7219_NUM_DEVICES - 1 - dev;
+    return (uint16_t)(w->data[l][2 * i] << 8 | w->data[l][2 * i + 1]);
+}
+
+static void test_chain(transport_t transport) {
+    static hw_wire_t wire;
+    static max7219_emu_t emu;
+    static uint16_t frame[MAX7219_FRAME_WORDS];
+    const char *name = names[transport];
+
+    hw_reset();
+    hw_wire_init(&wire);
+    max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_attach(&wire, &emu);
+    transport_init(transport);
+    init_max7219(0x03);
+    hw_sync();
+
+    // init_max7219: 13 latches of one command for every device
+    CHECK(wire.latches == 13 && !wire.overflow, "%s: %u latches from init", name, wire.latches);
+    for (int l = 0; l < wire.latches; l++) {
+        CHECK(wire.len[l] == 2 * MAX7219_NUM_DEVICES, "%s: latch %d has %u bytes", name, l,
+              wire.len[l]);
+    }
+
+    // A frame with a different word for every (row, device)
+    hw_wire_init(&wire);
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            frame[MAX7219_FRAME_INDEX(row, dev)] = MAX7219_WORD(REG_DIGIT0 + row, row * 16 + dev);
+        }
+    }
+    send_frame(frame, 8);
+    while (transport_busy());
+    hw_sync();
+
+    CHECK(wire.latches == 8, "%s: %u latches for a frame", name, wire.latches);
+    int bad = 0;
+    for (int l = 0; l < wire.latches; l++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            uint16_t want = MAX7219_WORD(REG_DIGIT0 + l, l * 16 + dev);
+            if (recorded(&wire, l, dev) != want && bad++ < 4) {
+                CHECK(0, "%s: latch %d device %d carried %04X, not %04X", name, l, dev,
+                      recorded(&wire, l, dev), want);
+            }
+        }
+    }
+    CHECK(bad == 0, "%s: %d words wrong", name, bad);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            CHECK(max7219_emu_row(&emu, dev, row) == row * 16 + dev, "%s: device %d row %d = %02X",
+                  name, dev, row, max7219_emu_row(&emu, dev, row));
+        }
+    }
+
+    // One device addressed, NOOP for the fifteen others
+    hw_wire_init(&wire);
+    send_cmd_to(9, REG_INTENSITY, 0x0C);
+    hw_sync();
+    CHECK(wire.latches == 1, "%s: %u latches for send_cmd_to", name, wire.latches);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        uint16_t want = dev == 9 ? MAX7219_WORD(REG_INTENSITY, 0x0C) : MAX7219_WORD(REG_NOOP, 0);
+        CHECK(recorded(&wire, 0, dev) == want, "%s: send_cmd_to device %d got %04X", name, dev,
+              recorded(&wire, 0, dev));
+        CHECK(emu.regs[dev].intensity == (dev == 9 ? 0x0C : 0x03), "%s: device %d intensity %u",
+              name, dev, emu.regs[dev].intensity);
+    }
+
+    // A row across the whole chain in a single latch
+    uint8_t data[MAX7219_NUM_DEVICES];
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        data[dev] = (uint8_t)(0xF0 ^ dev);
+    }
+    hw_wire_init(&wire);
+    send_row(REG_DIGIT0 + 4, data);
+    hw_sync();
+    CHECK(wire.latches == 1, "%s: %u latches for send_row", name, wire.latches);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        CHECK(max7219_emu_row(&emu, dev, 4) == data[dev], "%s: send_row device %d = %02X", name,
+              dev, max7219_emu_row(&emu, dev, 4));
+    }
+}
+
+int main(void) {
+    test_chain(TRANSPORT_BITBANG);
+    test_chain(TRANSPORT_SPI_DMA);
+    return check_done("test_chain");
+}
@@ -0,0 +1,107 @@
+// PLL divider sets: clock_full_pll and every set clock_pll_compute() gives
+// are checked against the F401 limits restated here from RM0368, so a
+// mistake shared by clock.c and clock.h does not hide itself.
+#include "check.h"
+#include "hw.h"
+#include "clock.h"
+
+void sched_recalibrate(void) {}
+void transport_recalibrate(void) {}
+void fb_vsync_recalibrate(void) {}
+void gray_recalibrate(void) {}
+void uart_recalibrate(void) {}
+void spiflash_recalibrate(void) {}
+
+// HSI / M * N / P with every limit of the data sheet, 0 if one is broken
+static uint32_t recheck(const clock_pll_t *p, const char *what) {
+    int failures = check_failures;
+    uint64_t vco_in = 16000000ULL / p->pllm;
+    uint64_t vco = vco_in * p->plln;
+    uint64_t sysclk = p->pllp ? vco / p->pllp : 0;
+
+    CHECK(16000000 % p->pllm == 0, "%s: M %u does not divide HSI", what, p->pllm);
+    CHECK(p->pllm >= 2 && p->pllm <= 63, "%s: M %u", what, p->pllm);
+    CHECK(vco_in >= 1000000 && vco_in <= 2000000, "%s: VCO input %llu", what,
+          (unsigned long long)vco_in);
+    CHECK(p->plln >= 192 && p->plln <= 432, "%s: N %u", what, p->plln);
+    CHECK(vco >= 192000000 && vco <= 432000000, "%s: VCO %llu", what,
+          (unsigned long long)vco);
+    CHECK(p->pllp == 2 || p->pllp == 4 || p->pllp == 6 || p->pllp == 8, "%s: P %u",
+          what, p->pllp);
+    CHECK(p->pllq >= 2 && p->pllq <= 15, "%s: Q %u", what, p->pllq);
+    CHECK(vco / p->pllq <= 48000000, "%s: 48 MHz domain at %llu", what,
+          (unsigned long long)(vco / p->pllq));
+    CHECK(sysclk <= 84000000, "%s: SYSCLK %llu", what, (unsigned long long)sysclk);
+    CHECK(p->latency >= (sysclk - 1) / 30000000 && p->latency <= 2, "%s: %u wait states",
+          what, p->latency);
+    CHECK(sysclk / p->apb1_div <= 42000000, "%s: APB1 %llu", what,
+          (unsigned long long)(sysclk / p->apb1_div));
+    CHECK(sysclk / p->apb2_div <= 84000000, "%s: APB2 %llu", what,
+          (unsigned long long)(sysclk / p->apb2_div));
+    return check_failures == failures ? (uint32_t)sysclk : 0;
+}
+
+static void test_full(void) {
+    const clock_pll_t *p = &clock_full_pll;
+
+    CHECK(p->pllm == 16 && p->plln == 336 && p->pllp == 4 && p->pllq == 7,
+          "84 MHz set M%u N%u P%u Q%u", p->pllm, p->plln, p->pllp, p->pllq);
+    CHECK(clock_pll_valid(p), "clock_full_pll rejected");
+    CHECK(clock_pll_sysclk(p) == CLOCK_SYSCLK_HZ, "clock_full_pll gives %u Hz",
+          clock_pll_sysclk(p));
+    CHECK(recheck(p, "clock_full_pll") == CLOCK_SYSCLK_HZ, "clock_full_pll off");
+}
+
+// Every whole MHz the VCO range reaches, and nothing else
+static void test_compute(void) {
+    clock_pll_t p;
+    char what[32];
+
+    for (uint32_t mhz = 24; mhz <= 84; mhz++) {
+        snprintf(what, sizeof(what), "%u MHz", mhz);
+        CHECK(clock_pll_compute(mhz * 1000000, &p), "%s not reachable", what);
+        CHECK(recheck(&p, what) == mhz * 1000000, "%s: divider set gives another clock", what);
+    }
+
+    // Too slow for the VCO, too fast for the part, or off the VCO grid
+    uint32_t unreachable[] = { 0, 1000000, 16000000, 23000000, 85000000, 100000000, 84000001,
+                               50100000 };
+    for (unsigned i = 0; i < sizeof(unreachable) / sizeof(unreachable[0]); i++) {
+        CHECK(!clock_pll_compute(unreachable[i], &p), "%u Hz accepted", unreachable[i]);
+    }
+}
+
+// clock_pll_valid() rejects a set that breaks any one limit
+static void test_valid(void) {
+    clock_pll_t p;
+
+    struct {
+        const char *what;
+        uint32_t field;
+        uint32_t value;
+    } breaks[] = {
+        { "M below 2", 0, 1 },      { "M above 63", 0, 64 },
+        { "VCO input 0.5 MHz", 0, 32 }, { "VCO input 4 MHz", 0, 4 },
+        { "N below 192", 1, 191 },  { "N above 432", 1, 433 },
+        { "P of 3", 2, 3 },         { "SYSCLK 168 MHz", 2, 2 },
+        { "Q below 2", 3, 1 },      { "48 MHz domain at 56 MHz", 3, 6 },
+        { "Q above 15", 3, 16 },    { "too few wait states", 4, 1 },
+        { "8 wait states", 4, 8 },  { "APB1 at 84 MHz", 5, 1 },
+        { "VCO 440 MHz", 1, 440 },
+    };
+
+    for (unsigned i = 0; i < sizeof(breaks) / sizeof(breaks[0]); i++) {
+        p = clock_full_pll;
+        uint32_t *fields[] = { &p.pllm, &p.plln, &p.pllp, &p.pllq, &p.latency, &p.apb1_div };
+        *fields[breaks[i].field] = breaks[i].value;
+        CHECK(!clock_pll_valid(&p), "%s accepted", breaks[i].what);
+    }
+
+}
+
+int main(void) {
+    test_full();
+    test_compute();
+    test_valid();
+    return check_done("test_clock");
+}
@@ -0,0 +1,132 @@
+// Dirty-row flushing: the digit, capital and letter sequences of the
+// benchmarks are replayed on every transport twice, once diffed against
+// the shadow and once with fb_invalidate() before every flush. Bytes on
+// the bus are checked against a count of the rows that changed, and the
+// model of the chain must show the same pixels after every frame of both
+// runs. Prints the traffic of each pair.
+#include <string.h>
+#include "check.h"
+#include "hw.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "font.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+#define MAX_FRAMES 32
+#define LATCH_BYTES (2 * MAX7219_NUM_DEVICES)
+
+static const struct {
+    const char *name;
+    const char *text;
+} sequences[] = {
+    { "digits",   "0123456789" },
+    { "capitals", "ABCÇDEFGĞHIİJKLMNOÖPRSŞTUÜVYZ" },
+    { "letters",  "abcçdefgğhıijklmnoöprsştuüvyz" },
+};
+
+static const char *transport_names[] = { "bitbang", "spi_dma", "gpio_dma" };
+
+static max7219_emu_t emu;
+
+// Glyphs of a sequence. Every module shows the glyph of frame k, as the
+// benchmarks draw them, or with stagger module d shows the one d places
+// behind, so rows change on some modules and not on others.
+static uint8_t glyphs[MAX_FRAMES];
+static uint32_t frames;
+static uint8_t stagger;
+
+static void load(const char *text) {
+    uint32_t cp;
+    frames = 0;
+    while ((cp = utf8_next(&text)) != 0 && frames < MAX_FRAMES) glyphs[frames++] = font_index(cp);
+}
+
+static uint8_t shown(uint32_t k, int dev, int row) {
+    uint32_t behind = stagger ? (uint32_t)dev : 0;
+    return k < behind ? 0x00 : font_glyphs[glyphs[k - behind]][row];
+}
+
+// Latches a diffing flush needs: rows with a change on any module
+static uint32_t rows_changed(uint32_t k) {
+    uint32_t n = 0;
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            if (shown(k, dev, row) != (k ? shown(k - 1, dev, row) : 0x00)) {
+                n++;
+                break;
+            }
+        }
+    }
+    return n;
+}
+
+// Play the sequence, screens[k] what the chain showed after frame k.
+// Returns the bytes sent for the frames.
+static uint32_t play(transport_t transport, uint8_t full, uint8_t screens[][MAX7219_NUM_DEVICES][8],
+                     int *bad) {
+    hw_reset();
+    max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_attach(NULL, &emu);
+    transport_init(transport);
+    init_max7219(0x04);
+    fb_init();
+    hw_sync();
+    transport_reset_stats();
+
+    for (uint32_t k = 0; k < frames; k++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            for (int row = 0; row < 8; row++) {
+                fb_set_row((uint8_t)dev, (uint8_t)row, shown(k, dev, row));
+            }
+        }
+        if (full) fb_invalidate();
+        fb_flush();
+        hw_sync();
+        max7219_emu_capture(&emu, screens[k]);
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            for (int row = 0; row < 8; row++) *bad += screens[k][dev][row] != shown(k, dev, row);
+        }
+    }
+    hw_set_bus(NULL);
+    return transport_bytes_sent();
+}
+
+int main(void) {
+    static uint8_t diffed[MAX_FRAMES][MAX7219_NUM_DEVICES][8];
+    static uint8_t whole[MAX_FRAMES][MAX7219_NUM_DEVICES][8];
+
+    printf("%-9s %-9s %-9s %7s %7s %6s\n", "sequence", "modules", "transport", "full", "diffed",
+           "saved");
+    for (unsigned i = 0; i < 2 * sizeof(sequences) / sizeof(sequences[0]); i++) {
+        unsigned s = i / 2;
+        stagger = i & 1;
+        load(sequences[s].text);
+        uint32_t want = 0;
+        for (uint32_t k = 0; k < frames; k++) want += rows_changed(k) * LATCH_BYTES;
+
+        for (int t = TRANSPORT_BITBANG; t <= TRANSPORT_GPIO_DMA; t++) {
+            const char *name = sequences[s].name;
+            const char *modules = stagger ? "staggered" : "same";
+            int bad_diff = 0, bad_full = 0;
+            uint32_t full = play((transport_t)t, 1, whole, &bad_full);
+            uint32_t diff = play((transport_t)t, 0, diffed, &bad_diff);
+
+            CHECK(full == frames * 8 * LATCH_BYTES,
+                  "%s %s on %s: %u bytes resending every row, not %u", name, modules,
+                  transport_names[t], full, frames * 8 * LATCH_BYTES);
+            CHECK(diff == want, "%s %s on %s: %u bytes diffed, %u rows' worth changed", name,
+                  modules, transport_names[t], diff, want);
+            CHECK(bad_full == 0 && bad_diff == 0, "%s %s on %s: %d and %d rows off the frames",
+                  name, modules, transport_names[t], bad_full, bad_diff);
+            CHECK(memcmp(diffed, whole, frames * sizeof(whole[0])) == 0,
+                  "%s %s on %s: diffed frames show differently", name, modules,
+                  transport_names[t]);
+            printf("%-9s %-9s %-9s %7u %7u %5u%%\n", name, modules, transport_names[t], full, diff,
+                   full ? 100 * (full - diff) / full : 0);
+        }
+    }
+    return check_done("test_diff");
+}
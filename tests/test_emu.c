@@ -0,0 +1,208 @@
+// MAX7219 model and frame capture: the driver runs against the fake GPIOA
+// and the model decodes its pin writes into the pixels a chain would show.
+#include <string.h>
+#include "check.h"
+#include "hw.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "dlcache.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+// Shift a word in with the pin pattern of send_byte()
+static void pins_word(max7219_emu_t *emu, uint16_t word) {
+    for (int i = 15; i >= 0; i--) {
+        max7219_emu_bsrr(emu, 1U << (2 + 16));
+        max7219_emu_bsrr(emu, (word >> i) & 1 ? 1U << 0 : 1U << 16);
+        max7219_emu_bsrr(emu, 1U << 2);
+    }
+}
+
+static void pins_latch(max7219_emu_t *emu, const uint16_t *words, int n) {
+    max7219_emu_bsrr(emu, 1U << (1 + 16));
+    for (int i = 0; i < n; i++) {
+        pins_word(emu, words[i]);
+    }
+    max7219_emu_bsrr(emu, 1U << 1);
+}
+
+// Register semantics of one device, driven straight through its pins
+static void test_model(void) {
+    max7219_emu_t emu;
+    max7219_emu_init(&emu, 0, 2, 1, 1);
+
+    uint16_t w = MAX7219_WORD(REG_DIGIT0 + 2, 0xA5);
+    pins_latch(&emu, &w, 1);
+    CHECK(emu.regs[0].digits[2] == 0xA5, "digit 2 = %02X", emu.regs[0].digits[2]);
+    CHECK(max7219_emu_row(&emu, 0, 2) == 0x00, "shown while in shutdown");
+    CHECK(emu.clocks == 16 && emu.latches == 1, "%u clocks, %u latches", emu.clocks, emu.latches);
+
+    w = MAX7219_WORD(REG_SHUTDOWN, 0x01);
+    pins_latch(&emu, &w, 1);
+    CHECK(max7219_emu_row(&emu, 0, 2) == 0x00, "row 2 past scan limit 0");
+    w = MAX7219_WORD(REG_SCAN_LIMIT, 0x07);
+    pins_latch(&emu, &w, 1);
+    CHECK(max7219_emu_row(&emu, 0, 2) == 0xA5, "row 2 = %02X", max7219_emu_row(&emu, 0, 2));
+
+    // Code B on digit 2: 0x05 shows "5", the DP bit is kept
+    w = MAX7219_WORD(REG_DECODE_MODE, 1 << 2);
+    pins_latch(&emu, &w, 1);
+    w = MAX7219_WORD(REG_DIGIT0 + 2, 0x85);
+    pins_latch(&emu, &w, 1);
+    CHECK(max7219_emu_row(&emu, 0, 2) == 0xDB, "Code B 5. = %02X", max7219_emu_row(&emu, 0, 2));
+
+    w = MAX7219_WORD(REG_DISPLAY_TEST, 0x01);
+    pins_latch(&emu, &w, 1);
+    CHECK(max7219_emu_row(&emu, 0, 7) == 0xFF, "display test lights everything");
+
+    // Data is only taken on a CS rising edge
+    max7219_emu_t chain;
+    max7219_emu_init(&chain, 0, 2, 1, 3);
+    uint16_t words[3] = { MAX7219_WORD(REG_INTENSITY, 3), MAX7219_WORD(REG_NOOP, 0),
+                          MAX7219_WORD(REG_INTENSITY, 9) };
+    max7219_emu_bsrr(&chain, 1U << (1 + 16));
+    for (int i = 0; i < 3; i++) pins_word(&chain, words[i]);
+    CHECK(chain.latches == 0 && chain.regs[2].intensity == 0, "latched before CS rose");
+    max7219_emu_bsrr(&chain, 1U << 1);
+
+    // The first word shifted ends up in the last device
+    CHECK(chain.regs[2].intensity == 3 && chain.regs[0].intensity == 9 &&
+          chain.regs[1].intensity == 0, "intensities %u %u %u", chain.regs[0].intensity,
+          chain.regs[1].intensity, chain.regs[2].intensity);
+    CHECK(chain.writes == 2, "NOOP counted as a write");
+}
+
+static const uint8_t pattern[8] = { 0x18, 0x3C, 0x7E, 0xFF, 0xFF, 0x7E, 0x3C, 0x18 };
+
+// Frames drawn through the framebuffer, captured from the pins
+static void test_capture(void) {
+    max7219_emu_t emu;
+    uint8_t rows[MAX7219_NUM_DEVICES][8];
+
+    hw_reset();
+    max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_attach(NULL, &emu);
+
+    transport_init(TRANSPORT_BITBANG);
+    fb_init();
+    init_max7219(0x05);
+    hw_sync();
+
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        CHECK(emu.regs[dev].shutdown == 1 && emu.regs[dev].scan_limit == 7 &&
+              emu.regs[dev].intensity == 5 && emu.regs[dev].decode_mode == 0,
+              "device %d not configured", dev);
+    }
+
+    // Every device gets its own picture
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            fb_set_row(dev, row, (uint8_t)(pattern[row] ^ (dev * 0x11)));
+        }
+    }
+    uint8_t latches = fb_flush();
+    hw_sync();
+    CHECK(latches == 8, "%u latches for a full frame", latches);
+
+    max7219_emu_capture(&emu, rows);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            CHECK(rows[dev][row] == (uint8_t)(pattern[row] ^ (dev * 0x11)),
+                  "device %d row %d = %02X", dev, row, rows[dev][row]);
+        }
+    }
+
+    // One pixel changes: one latch, the other devices get NOOP
+    uint32_t writes = emu.writes;
+    fb_set_row(0, 3, 0x81);
+    latches = fb_flush();
+    hw_sync();
+    CHECK(latches == 1, "%u latches for one row", latches);
+    CHECK(emu.writes - writes == 1, "%u register writes for one row", emu.writes - writes);
+    CHECK(max7219_emu_row(&emu, 0, 3) == 0x81, "row 3 = %02X", max7219_emu_row(&emu, 0, 3));
+
+    // Shutdown blanks the picture without losing it
+    send_cmd(REG_SHUTDOWN, 0x00);
+    hw_sync();
+    CHECK(max7219_emu_row(&emu, 0, 0) == 0x00, "shown in shutdown");
+    send_cmd(REG_SHUTDOWN, 0x01);
+    hw_sync();
+    CHECK(max7219_emu_row(&emu, 0, 0) == pattern[0], "lost in shutdown");
+
+#ifdef MAX7219_EMULATOR
+    // The driver's own mirror agrees with what the pins carried
+    CHECK(memcmp(max7219_emu.regs, emu.regs, sizeof(emu.regs)) == 0, "mirror differs from pins");
+    CHECK(max7219_emu.latches == emu.latches, "mirror latched %u times, pins %u",
+          max7219_emu.latches, emu.latches);
+#endif
+}
+
+// Frames A and B, differing in the first rows_changed rows, shown in
+// turn. Returns the latches of the last two flushes, after the cache has
+// had its chance to store both.
+static uint32_t cache_run(max7219_emu_t *emu, uint8_t rows_changed) {
+    uint32_t latches = 0;
+
+    for (int i = 0; i < 6; i++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            for (int row = 0; row < 8; row++) {
+                uint8_t flip = (i & 1) && row < rows_changed ? 0xFF : 0x00;
+                fb_set_row(dev, row, (uint8_t)(pattern[row] ^ flip));
+            }
+        }
+        if (i == 4) latches = emu->latches;
+        fb_flush();
+        while (transport_busy());
+        hw_sync();
+    }
+    uint8_t last = (uint8_t)(pattern[0] ^ 0xFF);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        CHECK(max7219_emu_row(emu, dev, 0) == last, "device %d row 0 = %02X", dev,
+              max7219_emu_row(emu, dev, 0));
+    }
+    return emu->latches - latches;
+}
+
+// The display-list cache only replays whole frames, and never on bit-bang
+static void test_cache(void) {
+    static max7219_emu_t emu;
+    dlcache_stats_t stats;
+
+    for (transport_t t = TRANSPORT_BITBANG; t <= TRANSPORT_SPI_DMA; t++) {
+        for (uint8_t rows = 2; rows <= 8; rows += 6) {
+            hw_reset();
+            max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+            hw_attach(NULL, &emu);
+            transport_init(t);
+            fb_init();
+            init_max7219(0x05);
+            dlcache_reset();
+            dlcache_reset_stats();
+            fb_display_cache(1);
+
+            uint32_t latches = cache_run(&emu, rows);
+            dlcache_get_stats(&stats);
+            CHECK(latches == 2U * rows, "transport %d, %u rows changing: %u latches", t, rows,
+                  latches);
+
+            // Two misses each before A and B are stored, then hits
+            uint32_t hits = t == TRANSPORT_BITBANG || rows < 8 ? 0 : 2;
+            CHECK(stats.hits == hits, "transport %d, %u rows changing: %u hits", t, rows,
+                  stats.hits);
+            fb_display_cache(0);
+        }
+    }
+    CHECK(dlcache_capacity() > 0, "nothing cached on SPI DMA");
+    transport_init(TRANSPORT_BITBANG);
+    dlcache_reset();
+    CHECK(dlcache_capacity() == 0, "%u entries on bit-bang", dlcache_capacity());
+}
+
+int main(void) {
+    test_model();
+    test_capture();
+    test_cache();
+    return check_done("test_emu");
+}
@@ -0,0 +1,177 @@
+// Font tables: the column-major copy is transposed back and compared with
+// the rows, the capitals are compared with the glyphs of the original
+// A-Z firmware, and the proportional metrics, the Turkish letters and the
+// UTF-8 decoder are checked.
+#include <string.h>
+#include "check.h"
+#include "font.h"
+
+// capital_letters[] of the original A-Zcounter.c, A to Z without Q, W, X
+static const struct {
+    char c;
+    uint8_t rows[8];
+} capital_letters[23] = {
+    { 'A', { 0x3C, 0x42, 0x42, 0x42, 0x7E, 0x42, 0x42, 0x42 } },
+    { 'B', { 0x7C, 0x42, 0x42, 0x7C, 0x42, 0x42, 0x42, 0x7C } },
+    { 'C', { 0x3C, 0x42, 0x40, 0x40, 0x40, 0x40, 0x42, 0x3C } },
+    { 'D', { 0x78, 0x44, 0x42, 0x42, 0x42, 0x42, 0x44, 0x78 } },
+    { 'E', { 0x7E, 0x40, 0x40, 0x7C, 0x40, 0x40, 0x40, 0x7E } },
+    { 'F', { 0x7E, 0x40, 0x40, 0x7C, 0x40, 0x40, 0x40, 0x40 } },
+    { 'G', { 0x3C, 0x42, 0x40, 0x40, 0x4E, 0x42, 0x42, 0x3C } },
+    { 'H', { 0x42, 0x42, 0x42, 0x7E, 0x42, 0x42, 0x42, 0x42 } },
+    { 'I', { 0x3C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x3C } },
+    { 'J', { 0x02, 0x02, 0x02, 0x02, 0x02, 0x42, 0x42, 0x3C } },
+    { 'K', { 0x42, 0x44, 0x48, 0x50, 0x60, 0x50, 0x48, 0x44 } },
+    { 'L', { 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7E } },
+    { 'M', { 0x42, 0x66, 0x5A, 0x42, 0x42, 0x42, 0x42, 0x42 } },
+    { 'N', { 0x42, 0x62, 0x52, 0x4A, 0x46, 0x42, 0x42, 0x42 } },
+    { 'O', { 0x3C, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3C } },
+    { 'P', { 0x7C, 0x42, 0x42, 0x7C, 0x40, 0x40, 0x40, 0x40 } },
+    { 'R', { 0x7C, 0x42, 0x42, 0x7C, 0x60, 0x50, 0x48, 0x44 } },
+    { 'S', { 0x3C, 0x42, 0x40, 0x38, 0x04, 0x02, 0x42, 0x3C } },
+    { 'T', { 0x7E, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 } },
+    { 'U', { 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3C } },
+    { 'V', { 0x42, 0x42, 0x42, 0x42, 0x42, 0x24, 0x18, 0x00 } },
+    { 'Y', { 0x42, 0x42, 0x24, 0x18, 0x10, 0x10, 0x10, 0x10 } },
+    { 'Z', { 0x7E, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x7E } },
+};
+
+// Rows of a glyph rebuilt from its columns
+static void rows_from_columns(const uint8_t *cols, uint8_t *rows) {
+    for (int row = 0; row < 8; row++) {
+        rows[row] = 0;
+        for (int col = 0; col < 8; col++) {
+            if (cols[col] & (1 << row)) rows[row] |= 0x80 >> col;
+        }
+    }
+}
+
+static void test_transpose(void) {
+    int bad = 0;
+
+    for (int g = 0; g < FONT_GLYPH_COUNT; g++) {
+        uint8_t rows[8];
+        rows_from_columns(font_columns[g], rows);
+        if (memcmp(rows, font_glyphs[g], 8) != 0 && bad++ < 4) {
+            CHECK(0, "glyph %d: columns do not transpose back to its rows", g);
+        }
+    }
+    CHECK(bad == 0, "%d of %d glyphs transpose wrong", bad, FONT_GLYPH_COUNT);
+
+    bad = 0;
+    for (int i = 0; i < 23; i++) {
+        uint8_t g = font_index((uint8_t)capital_letters[i].c);
+        uint8_t rows[8];
+        rows_from_columns(font_columns[g], rows);
+        if (memcmp(font_glyphs[g], capital_letters[i].rows, 8) != 0 ||
+            memcmp(rows, capital_letters[i].rows, 8) != 0) {
+            CHECK(0, "%c differs from the original capital_letters", capital_letters[i].c);
+            bad++;
+        }
+    }
+    CHECK(bad == 0, "%d capitals differ", bad);
+}
+
+// Left column and width from the rows, as proportional text needs them
+static void test_metrics(void) {
+    int bad = 0;
+
+    for (int g = 0; g < FONT_GLYPH_COUNT; g++) {
+        uint8_t used = 0;
+        for (int row = 0; row < 8; row++) used |= font_glyphs[g][row];
+        uint8_t left = 0, width = FONT_BLANK_WIDTH;
+        if (used) {
+            uint8_t right = 7;
+            while (!(used & (0x80 >> left))) left++;
+            while (!(used & (0x80 >> right))) right--;
+            width = (uint8_t)(right - left + 1);
+        }
+        if ((font_left((uint8_t)g) != left || font_width((uint8_t)g) != width) && bad++ < 4) {
+            CHECK(0, "glyph %d: left %u width %u, not %u %u", g, font_left((uint8_t)g),
+                  font_width((uint8_t)g), left, width);
+        }
+    }
+    CHECK(bad == 0, "%d glyphs with wrong metrics", bad);
+
+    // Narrow glyphs do not pay for blank columns
+    uint8_t one = font_index('1'), i = font_index('I'), space = font_index(' ');
+    CHECK(font_left(one) == 2 && font_width(one) == 5, "'1' left %u width %u", font_left(one),
+          font_width(one));
+    CHECK(font_left(i) == 2 && font_width(i) == 4, "'I' left %u width %u", font_left(i),
+          font_width(i));
+    CHECK(font_left(space) == 0 && font_width(space) == FONT_BLANK_WIDTH,
+          "space left %u width %u", font_left(space), font_width(space));
+    CHECK(font_width(FONT_GLYPH_COUNT) == font_width(FONT_GLYPH_MISSING),
+          "index past the table not clamped");
+}
+
+// Every Turkish letter has a glyph of its own
+static void test_turkish(void) {
+    static const char letters[] = "ÇĞİÖŞÜçğıöşü";
+    static const uint32_t codepoints[12] = {
+        0x00C7, 0x011E, 0x0130, 0x00D6, 0x015E, 0x00DC,
+        0x00E7, 0x011F, 0x0131, 0x00F6, 0x015F, 0x00FC
+    };
+    uint8_t seen[12];
+    const char *s = letters;
+
+    for (int k = 0; k < 12; k++) {
+        uint32_t cp = utf8_next(&s);
+        CHECK(cp == codepoints[k], "letter %d decoded as U+%04X", k, cp);
+        seen[k] = font_index(cp);
+        CHECK(seen[k] != FONT_GLYPH_MISSING, "U+%04X has no glyph", cp);
+        for (int j = 0; j < k; j++) {
+            CHECK(seen[j] != seen[k], "U+%04X shares a glyph with U+%04X", cp, codepoints[j]);
+        }
+    }
+    CHECK(utf8_next(&s) == 0, "string did not end");
+
+    // Dotted and dotless I are four different letters
+    CHECK(font_index(0x0130) != font_index('I') && font_index(0x0131) != font_index('i'),
+          "I variants fold together");
+    CHECK(font_index(0x0160) == FONT_GLYPH_MISSING && font_index(0x1F600) == FONT_GLYPH_MISSING,
+          "code points past the map have a glyph");
+}
+
+// Malformed input gives U+FFFD and never runs past the terminator
+static void test_utf8(void) {
+    static const struct {
+        const char *in;
+        uint32_t cp[4];
+        int n;
+    } cases[] = {
+        { "A\xC3\xA7", { 'A', 0x00E7 }, 2 },
+        { "\xE2\x82\xAC", { 0x20AC }, 1 },
+        { "\xF0\x9F\x98\x80", { 0x1F600 }, 1 },
+        { "\x80" "A", { FONT_REPLACEMENT, 'A' }, 2 },             // Stray continuation
+        { "\xFF" "B", { FONT_REPLACEMENT, 'B' }, 2 },             // Invalid lead byte
+        { "\xC3" "A", { FONT_REPLACEMENT, 'A' }, 2 },             // Cut short by ASCII
+        { "\xE2\x82" "C", { FONT_REPLACEMENT, 'C' }, 2 },
+        { "\xF0\x9F\x98", { FONT_REPLACEMENT }, 1 },             // Truncated at the end
+        { "\xC3", { FONT_REPLACEMENT }, 1 },
+        { "\xE2\x82\xE2\x82\xAC", { FONT_REPLACEMENT, 0x20AC }, 2 },
+    };
+
+    for (unsigned c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const char *s = cases[c].in;
+        const char *end = s + strlen(s);
+        int k;
+        for (k = 0; k < 4; k++) {
+            uint32_t cp = utf8_next(&s);
+            if (cp == 0) break;
+            CHECK(k < cases[c].n && cp == cases[c].cp[k], "case %u: code point %d is U+%04X", c,
+                  k, cp);
+            CHECK(s <= end, "case %u: read past the end", c);
+        }
+        CHECK(k == cases[c].n, "case %u: %d code points, not %d", c, k, cases[c].n);
+        CHECK(utf8_next(&s) == 0 && s == end, "case %u: does not stay at the end", c);
+    }
+}
+
+int main(void) {
+    test_transpose();
+    test_metrics();
+    test_turkish();
+    test_utf8();
+    return check_done("test_font");
+}
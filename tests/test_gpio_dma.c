@@ -0,0 +1,225 @@
+// GPIO DMA transport: the BSRR word streams bitslice_encode_latch() builds
+// are decoded back into per-chain frames by one model per DIN pin, and the
+// TIM1-paced DMA2 Stream1 path of max7219.c is replayed word for word.
+// Also checks the slot timing against the MAX7219 and DMA limits.
+#include <stdlib.h>
+#include "check.h"
+#include "hw.h"
+#include "bitslice.h"
+#include "max7219.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+#define MAX_CHAINS 8
+#define LATCH_BYTES (2 * MAX7219_NUM_DEVICES)
+
+static const uint8_t chain_pins[MAX_CHAINS] = { 0, 3, 4, 5, 6, 7, 8, 9 };
+
+// A bit is only valid if DIN and CS stay put while CLK is high
+static int check_stream(const uint32_t *words, uint32_t n, uint32_t din_mask) {
+    uint32_t clk = 1UL << CLK_PIN;
+    uint32_t held = din_mask | 1UL << CS_PIN;
+    int bad = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t touched = (words[i] | words[i] >> 16) & 0xFFFF;
+        if ((words[i] & clk) && (touched & held)) bad++;
+        if ((words[i] & clk) && (words[i] & clk << 16)) bad++;
+    }
+    return bad;
+}
+
+static void test_chains(void) {
+    static uint8_t frames[MAX_CHAINS][8][LATCH_BYTES];
+    static uint32_t stream[8 * BITSLICE_LATCH_WORDS(LATCH_BYTES)];
+    static max7219_emu_t emu[MAX_CHAINS];
+    static const uint8_t counts[] = { 1, 2, 4, 8 };
+    const uint8_t *src[MAX_CHAINS];
+    bitslice_t b;
+
+    srand(22);
+    for (unsigned t = 0; t < sizeof(counts) / sizeof(counts[0]); t++) {
+        uint8_t chains = counts[t];
+        uint32_t din_mask = 0;
+
+        bitslice_init(&b, chain_pins, chains, CLK_PIN);
+        for (int c = 0; c < chains; c++) {
+            max7219_emu_init(&emu[c], chain_pins[c], CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+            din_mask |= 1UL << chain_pins[c];
+        }
+
+        // Configure, then one random frame per chain, in shift order
+        uint32_t n = 0;
+        for (int c = 0; c < chains; c++) {
+            for (int l = 0; l < 8; l++) {
+                for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                    uint16_t word = MAX7219_WORD(REG_DIGIT0 + l, rand() & 0xFF);
+                    int i = MAX7219_FRAME_INDEX(0, dev);
+                    frames[c][l][2 * i] = word >> 8;
+                    frames[c][l][2 * i + 1] = word & 0xFF;
+                }
+            }
+        }
+        uint8_t setup[2][LATCH_BYTES];
+        for (int i = 0; i < MAX7219_NUM_DEVICES; i++) {
+            setup[0][2 * i] = REG_SCAN_LIMIT;
+            setup[0][2 * i + 1] = 0x07;
+            setup[1][2 * i] = REG_SHUTDOWN;
+            setup[1][2 * i + 1] = 0x01;
+        }
+        for (int s = 0; s < 2; s++) {
+            for (int c = 0; c < chains; c++) src[c] = setup[s];
+            n += bitslice_encode_latch(&b, src, LATCH_BYTES, CS_PIN, &stream[n]);
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            for (int c = 0; c < chains; c++) max7219_emu_bsrr(&emu[c], stream[i]);
+        }
+
+        n = 0;
+        for (int l = 0; l < 8; l++) {
+            for (int c = 0; c < chains; c++) src[c] = frames[c][l];
+            n += bitslice_encode_latch(&b, src, LATCH_BYTES, CS_PIN, &stream[n]);
+        }
+        CHECK(n == 8 * BITSLICE_LATCH_WORDS(LATCH_BYTES), "%u chains: %u words", chains, n);
+        CHECK(check_stream(stream, n, din_mask) == 0, "%u chains: data moves while CLK is high",
+              chains);
+        for (uint32_t i = 0; i < n; i++) {
+            for (int c = 0; c < chains; c++) max7219_emu_bsrr(&emu[c], stream[i]);
+        }
+
+        int bad = 0;
+        for (int c = 0; c < chains; c++) {
+            CHECK(emu[c].latches == 10 && emu[c].clocks == 10UL * 8 * LATCH_BYTES,
+                  "%u chains: chain %d saw %u latches, %u clocks", chains, c, emu[c].latches,
+                  emu[c].clocks);
+            for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+                int i = MAX7219_FRAME_INDEX(0, dev);
+                for (int row = 0; row < 8; row++) {
+                    if (max7219_emu_row(&emu[c], dev, row) != frames[c][row][2 * i + 1]) bad++;
+                }
+            }
+        }
+        CHECK(bad == 0, "%u chains: %d rows decoded wrong", chains, bad);
+    }
+}
+
+// What the DMA wrote to BSRR, in order
+static uint32_t written[8 * BITSLICE_LATCH_WORDS(LATCH_BYTES) + 64];
+static uint32_t written_n;
+static max7219_emu_t dma_emu;
+
+static void record_bus(hw_event_t event, uint32_t value) {
+    if (event != HW_PIN) return;
+    if (written_n < sizeof(written) / sizeof(written[0])) written[written_n] = value;
+    written_n++;
+    max7219_emu_bsrr(&dma_emu, value);
+}
+
+// The max7219.c path: transport_encode() and the TIM1-paced Stream1
+static void test_transport(void) {
+    static uint16_t frame[MAX7219_FRAME_WORDS];
+    static uint32_t stream[8 * BITSLICE_LATCH_WORDS(LATCH_BYTES)];
+
+    hw_reset();
+    max7219_emu_init(&dma_emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_set_bus(record_bus);
+    transport_init(TRANSPORT_GPIO_DMA);
+    init_max7219(0x02);
+    while (transport_busy());
+    hw_sync();
+
+    uint32_t ticks;
+    gpio_dma_timing(SystemCoreClock, GPIO_DMA_BIT_HZ, &ticks);
+    CHECK(TIM1->ARR == ticks - 1, "TIM1 ARR %u, slot of %u ticks", TIM1->ARR, ticks);
+
+    for (int row = 0; row < 8; row++) {
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            frame[MAX7219_FRAME_INDEX(row, dev)] =
+                MAX7219_WORD(REG_DIGIT0 + row, 0x5A ^ (row << 4) ^ dev);
+        }
+    }
+    uint32_t bytes = transport_encode(frame, 8, stream);
+    uint32_t n = bytes / sizeof(uint32_t);
+    CHECK(n == 8 * BITSLICE_LATCH_WORDS(LATCH_BYTES), "%u words encoded", n);
+    CHECK(check_stream(stream, n, 1UL << DIN_PIN) == 0, "data moves while CLK is high");
+
+    written_n = 0;
+    send_encoded_ref(stream, 8);
+    while (transport_busy());
+    hw_sync();
+
+    CHECK(written_n == n, "DMA wrote %u words of %u", written_n, n);
+    int bad = 0;
+    for (uint32_t i = 0; i < n && i < written_n; i++) {
+        bad += written[i] != stream[i];
+    }
+    CHECK(bad == 0, "%d words reached BSRR changed", bad);
+    CHECK(!(TIM1->CR1 & TIM_CR1_CEN) && !(DMA2_Stream1->CR & DMA_SxCR_EN),
+          "pacing left running");
+
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            uint8_t want = (uint8_t)(0x5A ^ (row << 4) ^ dev);
+            CHECK(max7219_emu_row(&dma_emu, dev, row) == want, "device %d row %d = %02X, not %02X",
+                  dev, row, max7219_emu_row(&dma_emu, dev, row), want);
+            CHECK(dma_emu.regs[dev].intensity == 0x02, "device %d intensity %u", dev,
+                  dma_emu.regs[dev].intensity);
+        }
+    }
+
+    // send_frame() encodes into the driver's own buffer, same result
+    for (int i = 0; i < MAX7219_FRAME_WORDS; i++) frame[i] ^= 0x00FF;
+    written_n = 0;
+    send_frame(frame, 8);
+    while (transport_busy());
+    hw_sync();
+    CHECK(written_n == n, "send_frame wrote %u words of %u", written_n, n);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        CHECK(max7219_emu_row(&dma_emu, dev, 3) == (uint8_t)~(0x5A ^ (3 << 4) ^ dev),
+              "send_frame device %d row 3 = %02X", dev, max7219_emu_row(&dma_emu, dev, 3));
+    }
+    hw_set_bus(NULL);
+}
+
+// Slots within 10 MHz, at least 50 ns and GPIO_DMA_MIN_SLOT_TICKS long
+static void test_timing(void) {
+    static const uint32_t timers[] = { 16000000, 42000000, 48000000, 84000000, 100000000 };
+    static const uint32_t rates[] = { 0, 1000, 100000, 1000000, 2000000, 3000000, 5000000,
+                                      10000000, 20000000 };
+
+    for (unsigned t = 0; t < sizeof(timers) / sizeof(timers[0]); t++) {
+        for (unsigned r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            uint32_t hz = timers[t], want = rates[r], ticks;
+            uint32_t got = gpio_dma_timing(hz, want, &ticks);
+            uint32_t limit = want == 0 ? 1 : want > MAX7219_MAX_CLK_HZ ? MAX7219_MAX_CLK_HZ : want;
+
+            CHECK(ticks >= GPIO_DMA_MIN_SLOT_TICKS && ticks <= 65536,
+                  "%u Hz timer, %u Hz: %u ticks", hz, want, ticks);
+            CHECK((uint64_t)ticks * 1000000000 >= (uint64_t)hz * MAX7219_MIN_PULSE_NS,
+                  "%u Hz timer, %u Hz: slot of %u ticks under %u ns", hz, want, ticks,
+                  MAX7219_MIN_PULSE_NS);
+            // Never faster than asked, unless the 16-bit timer cannot go slower
+            CHECK(got == hz / ticks / 2 && (got <= limit || ticks == 65536),
+                  "%u Hz timer, %u Hz asked: %u Hz", hz, want, got);
+
+            // No shorter slot would have done
+            uint32_t floor = GPIO_DMA_MIN_SLOT_TICKS;
+            uint32_t pulse =
+                (uint32_t)(((uint64_t)hz * MAX7219_MIN_PULSE_NS + 999999999) / 1000000000);
+            if (pulse > floor) floor = pulse;
+            if (ticks > floor && ticks < 65536) {
+                CHECK((uint64_t)hz > (uint64_t)2 * (ticks - 1) * limit,
+                      "%u Hz timer, %u Hz: %u ticks longer than needed", hz, want, ticks);
+            }
+        }
+    }
+}
+
+int main(void) {
+    test_chains();
+    test_transport();
+    test_timing();
+    return check_done("test_gpio_dma");
+}
@@ -0,0 +1,259 @@
+// Grayscale bit planes: TIM3 slots are stepped by hand and the model's
+// rows are sampled in every slot, so the time each pixel is lit can be
+// compared with its level. Also checks that the planes and the vsync flip
+// never share the bus, and that a plane due in the middle of a command
+// latch waits instead of cutting it.
+#include "check.h"
+#include "hw.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "gray.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+void TIM2_IRQHandler(void);
+void TIM3_IRQHandler(void);
+
+static const char *names[] = { "bitbang", "spi_dma" };
+
+#define BASE_US 200
+
+static uint8_t level_at(uint16_t x, uint8_t y, uint8_t bits) {
+    return (uint8_t)((x * 7 + y * 3) % (1U << bits));
+}
+
+// Run one TIM3 slot, returns how long the plane it sent stays up
+static uint32_t slot(void) {
+    uint32_t us = TIM3->ARR + 1;
+    TIM3->SR = TIM_SR_UIF;
+    TIM3_IRQHandler();
+    while (transport_busy());
+    hw_sync();
+    return us;
+}
+
+static void test_duty(transport_t transport, uint8_t bits) {
+    static max7219_emu_t emu;
+    static uint32_t lit[8 * MAX7219_NUM_DEVICES][8];
+    const char *name = names[transport];
+
+    hw_reset();
+    max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_attach(NULL, &emu);
+    transport_init(transport);
+    init_max7219(0x08);
+
+    gray_init(bits);
+    for (uint16_t x = 0; x < 8 * MAX7219_NUM_DEVICES; x++) {
+        for (uint8_t y = 0; y < 8; y++) {
+            gray_set_pixel(x, y, level_at(x, y, bits));
+            lit[x][y] = 0;
+        }
+    }
+    gray_commit();
+    gray_start(BASE_US);
+
+    // Two refreshes: the time each pixel spends lit adds up slot by slot
+    uint32_t total = 0;
+    for (int s = 0; s < 2 * bits; s++) {
+        uint32_t us = slot();
+        total += us;
+        for (uint16_t x = 0; x < 8 * MAX7219_NUM_DEVICES; x++) {
+            for (uint8_t y = 0; y < 8; y++) {
+                if (max7219_emu_row(&emu, x >> 3, y) & (0x80 >> (x & 7))) {
+                    lit[x][y] += us;
+                }
+            }
+        }
+    }
+    gray_stop();
+
+    uint32_t period = BASE_US * ((1UL << bits) - 1);
+    CHECK(total == 2 * period, "%s %u bits: slots add up to %u us, not %u", name, bits, total,
+          2 * period);
+    CHECK(gray_overruns() == 0, "%s %u bits: %u overruns", name, bits, gray_overruns());
+
+    // Lit for level / (2^bits - 1) of every refresh
+    int bad = 0;
+    for (uint16_t x = 0; x < 8 * MAX7219_NUM_DEVICES; x++) {
+        for (uint8_t y = 0; y < 8; y++) {
+            uint32_t want = 2UL * level_at(x, y, bits) * BASE_US;
+            if (lit[x][y] != want && bad++ < 4) {
+                CHECK(0, "%s %u bits: pixel (%u, %u) level %u lit %u us, not %u", name, bits, x,
+                      y, level_at(x, y, bits), lit[x][y], want);
+            }
+        }
+    }
+    CHECK(bad == 0, "%s %u bits: %d pixels off", name, bits, bad);
+}
+
+static void test_budget(void) {
+    gray_budget_t b;
+
+    // 8 rows of 16 bits per device at 1 Mbit/s
+    gray_budget(4, 1000000, 0, &b);
+    CHECK(b.transfer_us == 8UL * MAX7219_NUM_DEVICES * 16 + 1, "transfer %u us", b.transfer_us);
+    CHECK(b.plane_us == b.transfer_us, "plane %u us below the transfer", b.plane_us);
+    CHECK(b.period_us == 15 * b.plane_us, "period %u us", b.period_us);
+
+    gray_budget(2, 1000000, GRAY_SCAN_PERIOD_US, &b);
+    CHECK(b.plane_us == GRAY_SCAN_PERIOD_US && b.scan_aligned, "plane %u us", b.plane_us);
+    CHECK(b.refresh_hz == 1000000 / (3 * GRAY_SCAN_PERIOD_US), "refresh %u Hz", b.refresh_hz);
+    CHECK(b.flicker_free == (b.refresh_hz >= GRAY_MIN_REFRESH_HZ), "flicker flag");
+
+    gray_budget(4, 1000000, GRAY_SCAN_PERIOD_US, &b);
+    CHECK(!b.flicker_free, "4 bits at one scan per plane flickers (%u Hz)", b.refresh_hz);
+
+    for (uint8_t k = 0; k < GRAY_MAX_BITS; k++) {
+        CHECK(gray_plane_weight(k) == 1UL << k, "plane %u weight %u", k, gray_plane_weight(k));
+    }
+}
+
+// The plane timer and the vsync flip both drive the digit registers
+static void test_exclusive(void) {
+    static max7219_emu_t emu;
+
+    hw_reset();
+    max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_attach(NULL, &emu);
+    transport_init(TRANSPORT_SPI_DMA);
+    init_max7219(0x08);
+    fb_init();
+    fb_vsync_start(50);
+    CHECK(hw_irq_enabled(TIM2_IRQn), "vsync not running");
+
+    // Loading planes does not start the plane timer
+    gray_init(2);
+    CHECK(!hw_irq_enabled(TIM3_IRQn), "gray_init started the planes");
+    gray_start(BASE_US);
+    CHECK(!hw_irq_enabled(TIM2_IRQn), "vsync runs next to the planes");
+    gray_commit();
+    CHECK(hw_irq_enabled(TIM3_IRQn), "gray_commit stopped the planes");
+
+    // A frame drawn meanwhile waits, nested holds do not let vsync in
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            fb_set_row(dev, row, (uint8_t)(0x11 * row + dev));
+        }
+    }
+    fb_swap();
+    CHECK(!hw_irq_enabled(TIM2_IRQn), "fb_swap let vsync in");
+    fb_vsync_hold();
+    fb_vsync_release();
+    CHECK(!hw_irq_enabled(TIM2_IRQn), "release let vsync in");
+    gray_start(BASE_US);
+    slot();
+
+    gray_stop();
+    CHECK(hw_irq_enabled(TIM2_IRQn), "vsync not back after gray_stop");
+    gray_stop();
+    CHECK(hw_irq_enabled(TIM2_IRQn), "second gray_stop changed vsync");
+    gray_commit();
+    CHECK(!hw_irq_enabled(TIM3_IRQn), "gray_commit restarted the planes");
+
+    // The next flip replaces the last plane with the whole frame
+    TIM2->SR = TIM_SR_UIF;
+    TIM2_IRQHandler();
+    while (transport_busy());
+    hw_sync();
+    CHECK(!fb_flip_pending_get(), "flip still pending");
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        for (int row = 0; row < 8; row++) {
+            CHECK(max7219_emu_row(&emu, dev, row) == (uint8_t)(0x11 * row + dev),
+                  "device %d row %d = %02X after the flip", dev, row,
+                  max7219_emu_row(&emu, dev, row));
+        }
+    }
+}
+
+// Records the bus and fires the plane interrupt after its fire_at-th event
+static hw_wire_t cut_wire;
+static max7219_emu_t cut_emu;
+static uint32_t cut_events, fire_at;
+
+static void cut_bus(hw_event_t event, uint32_t value) {
+    hw_wire_event(&cut_wire, event, value);
+    if (event == HW_PIN) {
+        max7219_emu_bsrr(&cut_emu, value);
+    } else {
+        max7219_emu_shift_word(&cut_emu, (uint16_t)value);
+    }
+    if (++cut_events == fire_at) {
+        TIM3->SR = TIM_SR_UIF;
+        TIM3_IRQHandler();
+    }
+}
+
+// A plane due while send_cmd() shifts must not split the latch
+static void test_cut(transport_t transport) {
+    const char *name = names[transport];
+
+    hw_reset();
+    max7219_emu_init(&cut_emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_set_bus(cut_bus);
+    transport_init(transport);
+    init_max7219(0x08);
+    gray_init(2);
+    for (uint16_t x = 0; x < 8 * MAX7219_NUM_DEVICES; x++) {
+        for (uint8_t y = 0; y < 8; y++) {
+            gray_set_pixel(x, y, level_at(x, y, 2));
+        }
+    }
+    gray_commit();
+    gray_start(BASE_US);
+    while (transport_busy());
+    hw_sync();
+
+    // Bus events of one command latch
+    fire_at = 0;
+    cut_events = 0;
+    send_cmd(REG_INTENSITY, 0x08);
+    hw_sync();
+    uint32_t events = cut_events;
+
+    uint32_t overruns = gray_overruns();
+    int bad = 0;
+    for (fire_at = 1; fire_at < events; fire_at++) {
+        uint8_t level = (uint8_t)(fire_at & 0x0F);
+
+        hw_wire_init(&cut_wire);
+        cut_events = 0;
+        send_cmd(REG_INTENSITY, level);
+        while (transport_busy());
+        hw_sync();
+
+        int ok = cut_wire.latches == 1 && cut_wire.len[0] == 2 * MAX7219_NUM_DEVICES;
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            ok &= cut_emu.regs[dev].intensity == level;
+        }
+        if (!ok && bad++ < 4) {
+            CHECK(0, "%s: plane at event %u of %u: %u latches, first of %u bytes", name, fire_at,
+                  events, cut_wire.latches, cut_wire.len[0]);
+        }
+    }
+    CHECK(bad == 0, "%s: %d of %u command latches cut", name, bad, events - 1);
+    CHECK(gray_overruns() == overruns + events - 1, "%s: %u planes skipped, not %u", name,
+          gray_overruns() - overruns, events - 1);
+
+    // The bus is free again for the next plane
+    fire_at = 0;
+    overruns = gray_overruns();
+    slot();
+    CHECK(gray_overruns() == overruns, "%s: plane after the command skipped", name);
+    gray_stop();
+    hw_set_bus(NULL);
+}
+
+int main(void) {
+    for (uint8_t bits = GRAY_MIN_BITS; bits <= GRAY_MAX_BITS; bits++) {
+        test_duty(TRANSPORT_BITBANG, bits);
+        test_duty(TRANSPORT_SPI_DMA, bits);
+    }
+    test_budget();
+    test_exclusive();
+    test_cut(TRANSPORT_BITBANG);
+    test_cut(TRANSPORT_SPI_DMA);
+    return check_done("test_gray");
+}
@@ -0,0 +1,184 @@
+// Power state accounting and the energy model. The scheduler clock, the
+// RTC and the bus are stubbed: __WFI() moves the clock on in SLEEP and
+// fires the wakeup timer in STOP, as the hardware would, or wakes early
+// with only the RTC counting the time slept.
+#include "check.h"
+#include "hw.h"
+#include "power.h"
+#include "sched.h"
+#include "rtc.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "spiflash.h"
+
+static uint64_t now_us;
+static uint32_t sleep_us;
+static uint32_t wakeup_ms;
+static uint8_t wakeup_fired, wakeup_lost;
+static uint32_t rtc_now, early_ms;
+static uint8_t flip_pending, holds, resumes;
+static uint32_t unheld_sends;
+
+uint64_t sched_time_us(void) { return now_us; }
+void sched_advance(uint32_t ms) { now_us += (uint64_t)ms * 1000; }
+
+void rtc_init(void) {}
+void rtc_wakeup_start(uint32_t ms) { wakeup_ms = ms; }
+void rtc_wakeup_stop(void) { wakeup_ms = 0; }
+uint8_t rtc_wakeup_fired(void) { return wakeup_fired; }
+void rtc_wakeup_clear(void) { wakeup_fired = 0; }
+uint32_t rtc_ticks(void) { return rtc_now; }
+uint32_t rtc_elapsed_ms(uint32_t start, uint32_t end) {
+    return (uint32_t)((uint64_t)(end - start) * 1000 / RTC_TICK_HZ);
+}
+
+uint8_t transport_busy(void) { return 0; }
+uint8_t spiflash_busy(void) { return 0; }
+uint8_t fb_flip_pending_get(void) { return flip_pending; }
+void fb_vsync_hold(void) { holds++; }
+void fb_vsync_release(void) { holds--; }
+
+void send_cmd(uint8_t reg, uint8_t data) {
+    (void)reg; (void)data;
+    if (!holds) unheld_sends++;
+}
+
+void send_cmd_to(uint8_t dev, uint8_t reg, uint8_t data) {
+    (void)dev; (void)reg; (void)data;
+    if (!holds) unheld_sends++;
+}
+
+// SysTick keeps counting in SLEEP and stops in STOP, the RTC runs on
+static void wfi(void) {
+    if (SCB->SCR & SCB_SCR_SLEEPDEEP_Msk) {
+        wakeup_fired = !wakeup_lost && wakeup_ms > 0;
+        rtc_now += (wakeup_lost ? early_ms : wakeup_ms) * RTC_TICK_HZ / 1000;
+    } else {
+        now_us += sleep_us;
+    }
+}
+
+static void resume(void) {
+    resumes++;
+}
+
+static void test_stats(void) {
+    power_stats_t s;
+
+    hw_reset();
+    hw_wfi_hook = wfi;
+    now_us = 1000;
+    power_init(resume);
+
+    now_us += 3000;                 // Run
+    sleep_us = 4000;
+    power_idle(5);                  // Too short for STOP
+    power_idle(50);                 // STOP for 49 ms
+    now_us += 1000;
+    flip_pending = 1;
+    power_idle(50);                 // A frame waits for the bus: SLEEP
+    flip_pending = 0;
+
+    power_get_stats(&s);
+    CHECK(s.us[POWER_STOP] == 49000, "stop %llu us", (unsigned long long)s.us[POWER_STOP]);
+    CHECK(s.us[POWER_SLEEP] == 8000, "sleep %llu us", (unsigned long long)s.us[POWER_SLEEP]);
+    CHECK(s.us[POWER_RUN] == 4000, "run %llu us", (unsigned long long)s.us[POWER_RUN]);
+    CHECK(s.us[POWER_RUN] + s.us[POWER_SLEEP] + s.us[POWER_STOP] == now_us - 1000,
+          "states add up to %llu us of %llu", (unsigned long long)(s.us[POWER_RUN] +
+          s.us[POWER_SLEEP] + s.us[POWER_STOP]), (unsigned long long)(now_us - 1000));
+    CHECK(s.stop_entries == 1 && resumes == 1, "%u stop entries, %u resumes", s.stop_entries,
+          resumes);
+    CHECK(wakeup_ms == 0, "wakeup timer left running");
+
+    // Woken early by another interrupt: the part slept still counts, on
+    // the scheduler clock and as STOP
+    power_reset_stats();
+    uint64_t before = now_us;
+    wakeup_lost = 1;
+    early_ms = 125;
+    power_idle(200);
+    CHECK(now_us - before == 125000, "scheduler moved %llu us for 125 ms of STOP",
+          (unsigned long long)(now_us - before));
+    now_us += 2000;
+    power_get_stats(&s);
+    CHECK(s.stop_entries == 1 && s.us[POWER_STOP] == 125000, "early wakeup counted %llu us",
+          (unsigned long long)s.us[POWER_STOP]);
+    CHECK(s.us[POWER_RUN] == 2000, "run %llu us after early wakeup",
+          (unsigned long long)s.us[POWER_RUN]);
+
+    // Never more than the period asked for
+    power_reset_stats();
+    early_ms = 500;
+    power_idle(100);
+    wakeup_lost = 0;
+    power_get_stats(&s);
+    CHECK(s.us[POWER_STOP] == 99000, "early wakeup counted %llu us of 99 ms",
+          (unsigned long long)s.us[POWER_STOP]);
+
+    // Long periods are cut to what the wakeup timer can count
+    power_reset_stats();
+    power_idle(RTC_WAKEUP_MAX_MS * 2);
+    power_get_stats(&s);
+    CHECK(s.us[POWER_STOP] == (uint64_t)RTC_WAKEUP_MAX_MS * 1000 && s.us[POWER_RUN] == 0,
+          "stop %llu us, run %llu us", (unsigned long long)s.us[POWER_STOP],
+          (unsigned long long)s.us[POWER_RUN]);
+}
+
+static void test_model(void) {
+    power_stats_t s = { { 0 }, 0 };
+    uint32_t n = MAX7219_NUM_DEVICES;
+
+    CHECK(power_model_current_ua(&s, n, 0, 0) == 0, "no time, no current");
+
+    s.us[POWER_RUN] = 1000;
+    CHECK(power_model_current_ua(&s, n, 0, 0) == POWER_MCU_RUN_UA + n * POWER_MAX7219_ON_UA,
+          "run, all on: %u uA", power_model_current_ua(&s, n, 0, 0));
+    CHECK(power_model_current_ua(&s, 0, 0, 0) == POWER_MCU_RUN_UA + n * POWER_MAX7219_OFF_UA,
+          "run, all off: %u uA", power_model_current_ua(&s, 0, 0, 0));
+
+    // A quarter running, the rest in STOP
+    s.us[POWER_STOP] = 3000;
+    uint32_t mcu = (POWER_MCU_RUN_UA + 3 * POWER_MCU_STOP_UA) / 4;
+    CHECK(power_model_current_ua(&s, 0, 0, 0) == mcu + n * POWER_MAX7219_OFF_UA,
+          "run/stop mix: %u uA", power_model_current_ua(&s, 0, 0, 0));
+
+    // Every pixel lit at full intensity: 31/32 of one digit slot in 8
+    s.us[POWER_STOP] = 0;
+    uint32_t lit = 64 * n;
+    uint32_t leds = (uint32_t)((uint64_t)lit * POWER_SEGMENT_PEAK_UA * 31 / 256);
+    CHECK(power_model_current_ua(&s, n, lit, 15) ==
+          POWER_MCU_RUN_UA + n * POWER_MAX7219_ON_UA + leds,
+          "all lit: %u uA", power_model_current_ua(&s, n, lit, 15));
+    CHECK(power_model_current_ua(&s, n, lit, 0) < power_model_current_ua(&s, n, lit, 1),
+          "intensity does not raise the current");
+
+    // The figures test_stats measured
+    s.us[POWER_RUN] = 4000;
+    s.us[POWER_SLEEP] = 8000;
+    s.us[POWER_STOP] = 49000;
+    mcu = (uint32_t)((4000ULL * POWER_MCU_RUN_UA + 8000ULL * POWER_MCU_SLEEP_UA +
+                      49000ULL * POWER_MCU_STOP_UA) / 61000);
+    CHECK(power_model_current_ua(&s, n, 0, 0) == mcu + n * POWER_MAX7219_ON_UA,
+          "measured mix: %u uA", power_model_current_ua(&s, n, 0, 0));
+}
+
+static void test_shutdown(void) {
+    unheld_sends = 0;
+    power_display_enable(0);
+    CHECK(power_modules_on() == 0, "%u modules on", power_modules_on());
+    power_module_enable(1, 1);
+    CHECK(power_modules_on() == 1 && power_module_is_on(1) && !power_module_is_on(0),
+          "module 1 alone not on");
+    power_module_enable(MAX7219_NUM_DEVICES, 1);
+    CHECK(!power_module_is_on(MAX7219_NUM_DEVICES), "module past the chain");
+    power_display_enable(1);
+    CHECK(power_modules_on() == MAX7219_NUM_DEVICES, "%u modules on", power_modules_on());
+    CHECK(unheld_sends == 0 && holds == 0, "%u sends outside a vsync hold", unheld_sends);
+}
+
+int main(void) {
+    test_stats();
+    test_model();
+    test_shutdown();
+    return check_done("test_power");
+}
@@ -0,0 +1,232 @@
+// Serial framing: frames built with proto_encode() go through a pty, as
+// they would from a host over the UART, and the slave side feeds the
+// ring the parser consumes. Covers frames split over the end of the
+// ring, partial frames, resync after a bad CRC or an impossible length,
+// and the link counters.
+#include <pty.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "check.h"
+#include "proto.h"
+
+#define RING_SIZE 512
+
+static ring_t ring;
+static uint8_t ring_buf[RING_SIZE];
+static int master, slave;
+
+// What the handler saw
+static uint8_t got_type[8];
+static uint16_t got_len[8];
+static uint8_t got_payload[8][PROTO_MAX_PAYLOAD];
+static int got;
+
+static void handler(const proto_frame_t *frame) {
+    if (got >= 8) return;
+    got_type[got] = frame->type;
+    got_len[got] = proto_copy(frame, got_payload[got], PROTO_MAX_PAYLOAD);
+    got++;
+}
+
+// Host writes n bytes, the UART side moves them into the ring
+static void feed(const uint8_t *data, uint32_t n) {
+    uint8_t chunk[64];
+    uint32_t moved = 0;
+
+    while (moved < n) {
+        uint32_t len = n - moved < sizeof(chunk) ? n - moved : sizeof(chunk);
+        if (write(master, data + moved, len) != (ssize_t)len) break;
+        uint32_t in = 0;
+        while (in < len) {
+            ssize_t r = read(slave, chunk + in, len - in);
+            if (r <= 0) return;
+            in += (uint32_t)r;
+        }
+        ring_write(&ring, chunk, len);
+        moved += len;
+    }
+}
+
+// Ring emptied, head and tail at buffer offset at
+static void restart(uint32_t at) {
+    ring_init(&ring, ring_buf, sizeof(ring_buf));
+    atomic_store(&ring.head, at);
+    atomic_store(&ring.tail, at);
+    proto_reset_stats();
+    got = 0;
+}
+
+static void open_link(void) {
+    struct termios t;
+
+    if (openpty(&master, &slave, NULL, NULL, NULL) != 0) {
+        CHECK(0, "no pty");
+        return;
+    }
+    tcgetattr(slave, &t);
+    cfmakeraw(&t);
+    tcsetattr(slave, TCSANOW, &t);
+}
+
+static uint16_t text_frame(const char *text, uint8_t *out) {
+    return proto_encode(PROTO_CMD_TEXT, (const uint8_t *)text, (uint16_t)strlen(text), out);
+}
+
+// Every frame placement around the end of the buffer, payload intact
+static void test_wrap(void) {
+    uint8_t frame[PROTO_HEADER_LEN + 64 + PROTO_CRC_LEN];
+    uint8_t payload[64];
+    int bad = 0;
+
+    for (int i = 0; i < 64; i++) payload[i] = (uint8_t)(i * 37 + 1);
+    uint16_t n = proto_encode(PROTO_CMD_FRAME, payload, sizeof(payload), frame);
+
+    for (uint32_t at = RING_SIZE - n; at <= RING_SIZE; at++) {
+        restart(at);
+        feed(frame, n);
+        uint8_t handled = proto_poll(&ring, handler);
+        if (handled != 1 || got_type[0] != PROTO_CMD_FRAME || got_len[0] != sizeof(payload) ||
+            memcmp(got_payload[0], payload, sizeof(payload)) != 0 || ring_count(&ring) != 0) {
+            bad++;
+        }
+    }
+    CHECK(bad == 0, "%d of %u placements across the end broke the frame", bad, n + 1);
+
+    // And across the 2^32 wrap of the counters
+    restart(0xFFFFFFFFU - 10);
+    feed(frame, n);
+    CHECK(proto_poll(&ring, handler) == 1 && got_len[0] == sizeof(payload),
+          "frame across the counter wrap lost");
+}
+
+// Split at every byte: nothing handled or dropped until the rest arrives
+static void test_partial(void) {
+    uint8_t frame[64];
+    uint16_t n = text_frame("partial frame", frame);
+    int bad = 0;
+
+    for (uint16_t k = 1; k < n; k++) {
+        restart(RING_SIZE - k / 2);
+        feed(frame, k);
+        if (proto_poll(&ring, handler) != 0 || ring_count(&ring) != k) bad++;
+        feed(frame + k, n - k);
+        if (proto_poll(&ring, handler) != 1 || ring_count(&ring) != 0) bad++;
+    }
+    CHECK(bad == 0, "%d splits of a %u byte frame misparsed", bad, n);
+
+    proto_stats_t s;
+    proto_get_stats(&s);
+    CHECK(s.frames == 1 && s.dropped == 0 && s.crc_errors == 0, "split frame counted %u/%u/%u",
+          s.frames, s.dropped, s.crc_errors);
+}
+
+static uint32_t count_sync(const uint8_t *data, uint16_t n) {
+    uint32_t c = 0;
+    for (uint16_t i = 0; i < n; i++) c += data[i] == PROTO_SYNC;
+    return c;
+}
+
+// A corrupted frame costs one CRC error and its bytes, the next one parses
+static void test_bad_crc(void) {
+    uint8_t bad[64], good[64];
+    uint16_t nb = text_frame("first", bad);
+    uint16_t ng = text_frame("second", good);
+    proto_stats_t s;
+
+    bad[PROTO_HEADER_LEN + 2] ^= 0x01;
+    CHECK(count_sync(bad + 1, nb - 1) == 0, "test frame holds a sync byte");
+
+    restart(RING_SIZE - 7);
+    feed(bad, nb);
+    feed(good, ng);
+    CHECK(proto_poll(&ring, handler) == 1 && got_len[0] == 6 &&
+          memcmp(got_payload[0], "second", 6) == 0, "frame after a bad CRC lost");
+    proto_get_stats(&s);
+    CHECK(s.crc_errors == 1 && s.dropped == nb - 1u && s.frames == 1,
+          "bad CRC: %u errors, %u dropped, %u frames", s.crc_errors, s.dropped, s.frames);
+
+    // Line noise ahead of a frame is dropped byte by byte
+    static const uint8_t noise[] = { 0x00, 0x13, 0xFF, 0x5A, 0x42 };
+    restart(0);
+    feed(noise, sizeof(noise));
+    feed(good, ng);
+    CHECK(proto_poll(&ring, handler) == 1, "frame after noise lost");
+    proto_get_stats(&s);
+    CHECK(s.dropped == sizeof(noise) && s.crc_errors == 0, "noise: %u dropped", s.dropped);
+}
+
+// A length past PROTO_MAX_PAYLOAD is not a header, the largest one is
+static void test_length(void) {
+    static uint8_t big[PROTO_HEADER_LEN + PROTO_MAX_PAYLOAD + PROTO_CRC_LEN];
+    static uint8_t payload[PROTO_MAX_PAYLOAD];
+    static const uint8_t oversize[] = { PROTO_SYNC, PROTO_CMD_TEXT, 0x01, 0x01 };
+    uint8_t good[64];
+    uint16_t ng = text_frame("after", good);
+    proto_stats_t s;
+
+    restart(100);
+    feed(oversize, sizeof(oversize));
+    feed(good, ng);
+    CHECK(proto_poll(&ring, handler) == 1 && got_len[0] == 5, "frame after a bad length lost");
+    proto_get_stats(&s);
+    CHECK(s.dropped == sizeof(oversize) && s.crc_errors == 0 && s.frames == 1,
+          "oversize length: %u dropped, %u CRC errors", s.dropped, s.crc_errors);
+
+    // Never waits for the payload of an impossible length
+    restart(0);
+    feed(oversize, sizeof(oversize));
+    CHECK(proto_poll(&ring, handler) == 0 && ring_count(&ring) == 0,
+          "%u bytes held for an oversize frame", ring_count(&ring));
+
+    for (int i = 0; i < PROTO_MAX_PAYLOAD; i++) payload[i] = (uint8_t)(i ^ 0x5A);
+    uint16_t n = proto_encode(PROTO_CMD_FRAME, payload, PROTO_MAX_PAYLOAD, big);
+    restart(RING_SIZE - 100);
+    feed(big, n);
+    CHECK(proto_poll(&ring, handler) == 1 && got_len[0] == PROTO_MAX_PAYLOAD &&
+          memcmp(got_payload[0], payload, PROTO_MAX_PAYLOAD) == 0, "largest frame refused");
+}
+
+// Several frames in one poll, counters add up and reset
+static void test_stats(void) {
+    uint8_t buf[3][64];
+    uint16_t n[3];
+    static const uint8_t level = 0x07;
+    static const uint8_t time[3] = { 12, 34, 56 };
+    proto_stats_t s;
+
+    n[0] = proto_encode(PROTO_CMD_BRIGHTNESS, &level, 1, buf[0]);
+    n[1] = proto_encode(PROTO_CMD_TIME, time, 3, buf[1]);
+    n[2] = proto_encode(PROTO_CMD_TEXT, NULL, 0, buf[2]);
+
+    restart(RING_SIZE - 3);
+    for (int i = 0; i < 3; i++) feed(buf[i], n[i]);
+    CHECK(proto_poll(&ring, handler) == 3, "%d frames of 3 handled", got);
+    CHECK(got_type[0] == PROTO_CMD_BRIGHTNESS && got_payload[0][0] == level &&
+          got_type[1] == PROTO_CMD_TIME && memcmp(got_payload[1], time, 3) == 0 &&
+          got_type[2] == PROTO_CMD_TEXT && got_len[2] == 0, "frames out of order");
+    proto_get_stats(&s);
+    CHECK(s.frames == 3 && s.dropped == 0 && s.crc_errors == 0, "counted %u/%u/%u", s.frames,
+          s.dropped, s.crc_errors);
+
+    proto_reset_stats();
+    proto_get_stats(&s);
+    CHECK(s.frames == 0 && s.dropped == 0 && s.crc_errors == 0, "counters not reset");
+
+    // CRC-16/CCITT-FALSE check value
+    uint16_t crc = 0xFFFF;
+    for (const char *p = "123456789"; *p; p++) crc = proto_crc16(crc, (uint8_t)*p);
+    CHECK(crc == 0x29B1, "CRC of 123456789 is %04X", crc);
+}
+
+int main(void) {
+    open_link();
+    test_wrap();
+    test_partial();
+    test_bad_crc();
+    test_length();
+    test_stats();
+    close(master);
+    close(slave);
+    return check_done("test_proto");
+}
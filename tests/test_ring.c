@@ -0,0 +1,160 @@
+// ring.c under two real threads: a producer and a consumer hammer a small
+// ring with every access path and the consumer checks that the byte
+// stream arrives complete and in order. Also run with head and tail just
+// below the 2^32 wrap. Build line for running it alone, from the root:
+//
+//   cc -O2 -I. -o test_ring tests/test_ring.c ring.c -lpthread
+#include <pthread.h>
+#include <string.h>
+#include "check.h"
+#include "ring.h"
+
+// <sched.h> is shadowed by the firmware's sched.h on the include path
+int sched_yield(void);
+
+#define RING_SIZE   64
+#define STREAM_LEN  (8UL << 20)
+
+static ring_t ring;
+static uint8_t ring_buf[RING_SIZE];
+
+// Byte i of the stream, so a lost or repeated byte shows up at once
+static uint8_t stream_byte(uint32_t i) {
+    uint32_t x = i * 2654435761U;
+    return (uint8_t)(x >> 24 ^ i);
+}
+
+// Small xorshift, one per thread so the access patterns differ
+static uint32_t next_rand(uint32_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static volatile int space_errors;
+
+static void *producer(void *arg) {
+    uint32_t seed = 0x1234567;
+    uint32_t sent = 0;
+    uint8_t block[RING_SIZE + 8];
+    (void)arg;
+
+    while (sent < STREAM_LEN) {
+        uint32_t before = sent;
+        uint32_t space = ring_space(&ring);
+        if (space > RING_SIZE) space_errors++;
+
+        uint32_t len = next_rand(&seed) % (RING_SIZE + 8) + 1;
+        if (len > STREAM_LEN - sent) len = STREAM_LEN - sent;
+
+        switch (next_rand(&seed) % 3) {
+        case 0:
+            if (ring_push(&ring, stream_byte(sent))) sent++;
+            break;
+        case 1:
+            for (uint32_t i = 0; i < len; i++) block[i] = stream_byte(sent + i);
+            sent += ring_write(&ring, block, len);
+            break;
+        default: {
+            // As a DMA would: fill the free space in place, then publish
+            uint32_t head = atomic_load_explicit(&ring.head, memory_order_relaxed);
+            if (len > space) len = space;
+            for (uint32_t i = 0; i < len; i++) {
+                ring.buf[(head + i) & ring.mask] = stream_byte(sent + i);
+            }
+            ring_produced(&ring, len);
+            sent += len;
+            break;
+        }
+        }
+        // Full: let the consumer in, on a single core it would not run
+        if (sent == before) sched_yield();
+    }
+    return NULL;
+}
+
+static volatile int order_errors, count_errors;
+
+static void *consumer(void *arg) {
+    uint32_t seed = 0x89ABCDE;
+    uint32_t got = 0;
+    uint8_t block[RING_SIZE + 8];
+    (void)arg;
+
+    while (got < STREAM_LEN) {
+        uint32_t count = ring_count(&ring);
+        if (count > RING_SIZE) count_errors++;
+
+        uint32_t max = next_rand(&seed) % (RING_SIZE + 8) + 1;
+        uint32_t n = 0;
+        uint8_t b;
+
+        switch (next_rand(&seed) % 3) {
+        case 0:
+            if (ring_pop(&ring, &b)) {
+                block[0] = b;
+                n = 1;
+            }
+            break;
+        case 1:
+            n = ring_read(&ring, block, max);
+            break;
+        default:
+            n = count < max ? count : max;
+            for (uint32_t i = 0; i < n; i++) block[i] = ring_peek(&ring, i);
+            ring_consume(&ring, n);
+            break;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            if (block[i] != stream_byte(got + i)) order_errors++;
+        }
+        got += n;
+        if (n == 0) sched_yield();
+    }
+    return NULL;
+}
+
+static void run(uint32_t start, const char *what) {
+    pthread_t p, c;
+
+    ring_init(&ring, ring_buf, sizeof(ring_buf));
+    atomic_store(&ring.head, start);
+    atomic_store(&ring.tail, start);
+    space_errors = count_errors = order_errors = 0;
+
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+
+    CHECK(order_errors == 0, "%s: %d bytes out of order", what, order_errors);
+    CHECK(space_errors == 0 && count_errors == 0, "%s: space above size %d times, count %d times",
+          what, space_errors, count_errors);
+    CHECK(ring_count(&ring) == 0, "%s: %u bytes left", what, ring_count(&ring));
+    CHECK(atomic_load(&ring.head) == start + (uint32_t)STREAM_LEN, "%s: head at %u", what,
+          atomic_load(&ring.head));
+}
+
+// Single-threaded edges: sizes, full and empty
+static void test_edges(void) {
+    uint8_t buf[8], out[8];
+    uint8_t b;
+
+    CHECK(!ring_init(&ring, buf, 0) && !ring_init(&ring, buf, 6), "size not a power of two taken");
+    CHECK(ring_init(&ring, buf, sizeof(buf)), "size 8 refused");
+    CHECK(!ring_pop(&ring, &b) && ring_read(&ring, out, 8) == 0, "empty ring gave data");
+    CHECK(ring_write(&ring, (const uint8_t *)"abcdefghij", 10) == 8, "wrote past full");
+    CHECK(!ring_push(&ring, 'x') && ring_space(&ring) == 0, "push into a full ring");
+    CHECK(ring_peek(&ring, 7) == 'h', "peek 7 = %c", ring_peek(&ring, 7));
+    ring_consume(&ring, 3);
+    CHECK(ring_read(&ring, out, 8) == 5 && memcmp(out, "defgh", 5) == 0, "read after consume");
+}
+
+int main(void) {
+    test_edges();
+    run(0, "from 0");
+    run(0xFFFFFFFFU - 1000, "across the wrap");
+    return check_done("test_ring");
+}
@@ -0,0 +1,190 @@
+// Cooperative scheduler: sched_run() sleeps through an idle hook that
+// plays SysTick_Handler() for the milliseconds it was told to sleep, and
+// tasks call it themselves to take time. Checks periods against a
+// drift-free reference, that a stalled task skips its missed runs, the
+// sleep lengths sched_next_due_ms() hands out, the 32-bit tick wrap and
+// the latency statistics.
+#include <setjmp.h>
+#include "check.h"
+#include "hw.h"
+#include "sched.h"
+
+void SysTick_Handler(void);
+
+#define MAX_RUNS 256
+
+typedef struct {
+    uint32_t at[MAX_RUNS];
+    uint32_t n;
+} runs_t;
+
+static runs_t fast_runs, steady_runs;
+static uint32_t burn_ticks;
+static int8_t stall_id, fast_id;
+
+// Time spent inside a task: SysTick keeps interrupting it
+static void burn(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) SysTick_Handler();
+}
+
+static void record(runs_t *r) {
+    if (r->n < MAX_RUNS) r->at[r->n] = sched_ticks();
+    r->n++;
+}
+
+static void stall_task(void) {
+    burn(burn_ticks);
+}
+
+static void fast_task(void) {
+    record(&fast_runs);
+}
+
+static void steady_task(void) {
+    record(&steady_runs);
+}
+
+// Sleeps exactly as long as sched_run() asked, leaves after run_for ticks
+static jmp_buf leave;
+static uint32_t run_start, run_for, longest_sleep;
+static int early_wakeups, late_wakeups;
+
+static void idle(uint32_t ms) {
+    if (sched_ticks() - run_start >= run_for) longjmp(leave, 1);
+    if (ms > longest_sleep) longest_sleep = ms;
+
+    for (uint32_t i = 0; i < ms; i++) {
+        if (sched_next_due_ms() != ms - i) early_wakeups++;
+        SysTick_Handler();
+    }
+    if (sched_next_due_ms() != 0) late_wakeups++;
+}
+
+static void run(uint32_t ticks) {
+    fast_runs.n = steady_runs.n = 0;
+    run_start = sched_ticks();
+    run_for = ticks;
+    longest_sleep = 0;
+    early_wakeups = late_wakeups = 0;
+    if (!setjmp(leave)) {
+        sched_run();
+    }
+    // Left from the idle hook, with interrupts still masked
+    __enable_irq();
+}
+
+// A short stall, out of step with the others, delays runs but never
+// shifts the schedule
+static void test_drift(void) {
+    burn_ticks = 3;
+    run(1000);
+
+    // Every due time from 0 to 1000 ms inclusive, the run ends after a pass
+    CHECK(fast_runs.n == 201 && steady_runs.n == 101, "%u fast and %u steady runs in 1000 ms",
+          fast_runs.n, steady_runs.n);
+    uint32_t max_late = 0, total_late = 0;
+    int bad = 0;
+    for (uint32_t i = 0; i < fast_runs.n && i < MAX_RUNS; i++) {
+        uint32_t late = fast_runs.at[i] - (run_start + 5 * i);
+        if (late > burn_ticks) bad++;
+        if (late > max_late) max_late = late;
+        total_late += late;
+    }
+    for (uint32_t i = 0; i < steady_runs.n && i < MAX_RUNS; i++) {
+        if (steady_runs.at[i] - (run_start + 10 * i) > burn_ticks) bad++;
+    }
+    CHECK(bad == 0, "%d runs off the 5/10 ms grid by more than %u ms", bad, burn_ticks);
+    CHECK(early_wakeups == 0 && late_wakeups == 0, "slept %d times too short, %d too long",
+          early_wakeups, late_wakeups);
+    CHECK(longest_sleep <= 5, "slept %u ms with a 5 ms task", longest_sleep);
+
+    // The scheduler measured the same lateness
+    task_stats_t s;
+    sched_get_stats(fast_id, &s);
+    CHECK(s.runs == fast_runs.n && s.max_latency == max_late && s.total_latency == total_late,
+          "stats %u runs, max %u, total %u; measured %u, %u, %u", s.runs, s.max_latency,
+          s.total_latency, fast_runs.n, max_late, total_late);
+    sched_get_stats(stall_id, &s);
+    CHECK(s.runs == 31 && s.max_latency == 0, "stall task %u runs, %u late", s.runs,
+          s.max_latency);
+}
+
+// A stall longer than several periods: one late run, then back on time
+static void test_skip(void) {
+    burn_ticks = 23;
+    run(1000);
+
+    int bursts = 0;
+    for (uint32_t i = 1; i < fast_runs.n && i < MAX_RUNS; i++) {
+        if (fast_runs.at[i] - fast_runs.at[i - 1] < 5 - 1) bursts++;
+    }
+    CHECK(bursts == 0, "%d fast runs bunched after a stall", bursts);
+    CHECK(fast_runs.n < 200 && steady_runs.n < 100,
+          "%u fast and %u steady runs, missed ones replayed", fast_runs.n, steady_runs.n);
+
+    task_stats_t s;
+    sched_get_stats(fast_id, &s);
+    CHECK(s.max_latency >= 20 && s.max_latency <= 23, "max latency %u ms, stall 23 ms",
+          s.max_latency);
+    burn_ticks = 0;
+}
+
+// Tick counter wrapping through 2^32 changes nothing
+static void test_wrap(void) {
+    uint32_t target = 0xFFFFFFFFU - 200;
+
+    // sched_advance() takes what STOP can sleep, so get there in steps a
+    // pass each, or the tasks would fall 2^31 ticks behind
+    burn_ticks = 0;
+    while (target - sched_ticks() > 4000000) {
+        sched_advance(4000000);
+        sched_run_pending();
+    }
+    sched_advance(target - sched_ticks());
+    run(100);
+    run(400);
+
+    int bad = 0;
+    for (uint32_t i = 1; i < fast_runs.n && i < MAX_RUNS; i++) {
+        bad += fast_runs.at[i] - fast_runs.at[i - 1] != 5;
+    }
+    for (uint32_t i = 1; i < steady_runs.n && i < MAX_RUNS; i++) {
+        bad += steady_runs.at[i] - steady_runs.at[i - 1] != 10;
+    }
+    CHECK(sched_ticks() < 1000, "ticks %u did not wrap", sched_ticks());
+    CHECK(bad == 0 && fast_runs.n >= 80 && fast_runs.n <= 81 && steady_runs.n >= 40 &&
+          steady_runs.n <= 41,
+          "across the wrap: %d uneven periods, %u fast and %u steady runs", bad, fast_runs.n,
+          steady_runs.n);
+    CHECK(early_wakeups == 0 && late_wakeups == 0 && longest_sleep <= 5,
+          "across the wrap: %d early, %d late wakeups, longest sleep %u ms", early_wakeups,
+          late_wakeups, longest_sleep);
+}
+
+// Without the idle hook every __WFI() is one SysTick
+static void test_delay(void) {
+    hw_wfi_hook = SysTick_Handler;
+    uint32_t start = sched_ticks();
+    sched_delay(37);
+    CHECK(sched_ticks() - start == 37, "sched_delay(37) took %u ms", sched_ticks() - start);
+    hw_wfi_hook = NULL;
+}
+
+int main(void) {
+    hw_reset();
+    sched_init();
+    sched_set_idle_hook(idle);
+    CHECK(sched_next_due_ms() == UINT32_MAX, "no tasks, next due in %u ms", sched_next_due_ms());
+
+    stall_id = sched_add(stall_task, 33);
+    fast_id = sched_add(fast_task, 5);
+    sched_add(steady_task, 10);
+    CHECK(sched_next_due_ms() == 0, "new tasks not due");
+    CHECK(sched_add(fast_task, 0) == -1, "zero period taken");
+
+    test_drift();
+    test_skip();
+    test_wrap();
+    test_delay();
+    return check_done("test_sched");
+}
@@ -0,0 +1,181 @@
+// Marquee: scroller_step() is run over the framebuffer and every frame is
+// compared with a column sequence built straight from the glyph rows, so
+// the glyph order, the inter-glyph gap, the blank tail and the restart
+// of a looping message are all checked. Frames also go through fb_flush()
+// to the model. With a file name argument the frames of the first message
+// are written there as one PBM, top to bottom:
+//
+//   ./test_scroll frames.pbm
+#include <stdio.h>
+#include "check.h"
+#include "hw.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "font.h"
+#include "scroll.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+#define WIDTH      (8 * MAX7219_NUM_DEVICES)
+#define MAX_COLS   512
+
+static uint8_t want[MAX_COLS];
+static uint32_t want_n;
+
+// Column c of a glyph from its rows, bit 0 is the top row
+static uint8_t glyph_column(uint8_t g, uint8_t c) {
+    uint8_t col = 0;
+    for (int row = 0; row < 8; row++) {
+        if (font_glyphs[g][row] & (0x80 >> c)) col |= 1 << row;
+    }
+    return col;
+}
+
+// What should enter at the right edge, glyph by glyph, then the tail
+static void expect(const char *text) {
+    const char *p = text;
+    uint32_t cp;
+
+    want_n = 0;
+    while ((cp = utf8_next(&p)) != 0) {
+        uint8_t g = font_index(cp);
+        uint8_t used = 0;
+        for (int row = 0; row < 8; row++) used |= font_glyphs[g][row];
+
+        uint8_t left = 0, right = FONT_BLANK_WIDTH - 1;
+        if (used) {
+            right = 7;
+            while (!(used & (0x80 >> left))) left++;
+            while (!(used & (0x80 >> right))) right--;
+        }
+        for (uint8_t c = left; c <= right; c++) want[want_n++] = glyph_column(g, c);
+        for (int i = 0; i < SCROLL_GLYPH_GAP; i++) want[want_n++] = 0x00;
+    }
+    for (int i = 0; i < WIDTH; i++) want[want_n++] = 0x00;
+}
+
+// Screen column x of the framebuffer
+static uint8_t fb_column(uint16_t x) {
+    uint8_t col = 0;
+    for (int row = 0; row < 8; row++) {
+        if (fb_get_row(x >> 3, row) & (0x80 >> (x & 7))) col |= 1 << row;
+    }
+    return col;
+}
+
+static void dump_frame(FILE *f) {
+    for (int row = 0; row < 8; row++) {
+        for (uint16_t x = 0; x < WIDTH; x++) {
+            fputc(fb_get_row(x >> 3, row) & (0x80 >> (x & 7)) ? '1' : '0', f);
+        }
+        fputc('\n', f);
+    }
+}
+
+// Step through one message: after step k the display shows the last
+// WIDTH columns of the sequence up to k
+static void test_message(const char *text, FILE *pbm) {
+    static max7219_emu_t emu;
+    scroller_t s;
+    int frames_bad = 0, display_bad = 0;
+
+    expect(text);
+    hw_reset();
+    max7219_emu_init(&emu, DIN_PIN, CLK_PIN, CS_PIN, MAX7219_NUM_DEVICES);
+    hw_attach(NULL, &emu);
+    transport_init(TRANSPORT_BITBANG);
+    init_max7219(0x04);
+    fb_init();
+
+    if (pbm) fprintf(pbm, "P1\n%d %u\n", WIDTH, 8 * (want_n + 1));
+    scroller_start(&s, text, 0);
+    uint32_t steps = 0;
+    while (scroller_step(&s) && steps < MAX_COLS) {
+        steps++;
+        for (uint16_t x = 0; x < WIDTH; x++) {
+            int32_t k = (int32_t)steps - WIDTH + x;
+            uint8_t col = k < 0 ? 0x00 : want[k];
+            if (fb_column(x) != col) {
+                if (frames_bad++ < 4) {
+                    CHECK(0, "\"%s\" step %u: column %u is %02X, not %02X", text, steps, x,
+                          fb_column(x), col);
+                }
+            }
+        }
+
+        fb_flush();
+        hw_sync();
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            for (int row = 0; row < 8; row++) {
+                display_bad += max7219_emu_row(&emu, dev, row) != fb_get_row(dev, row);
+            }
+        }
+        if (pbm) dump_frame(pbm);
+    }
+    if (pbm) dump_frame(pbm);
+    hw_set_bus(NULL);
+
+    CHECK(frames_bad == 0, "\"%s\": %d columns wrong", text, frames_bad);
+    CHECK(display_bad == 0, "\"%s\": %d rows differ on the display", text, display_bad);
+    CHECK(steps == want_n, "\"%s\": %u steps, not %u", text, steps, want_n);
+
+    // Finished: blank, and later steps do nothing
+    int lit = 0;
+    for (uint16_t x = 0; x < WIDTH; x++) lit += fb_column(x) != 0;
+    CHECK(lit == 0 && s.done, "\"%s\": %d columns lit at the end", text, lit);
+    fb_set_row(0, 0, 0xAA);
+    CHECK(!scroller_step(&s) && fb_get_row(0, 0) == 0xAA, "\"%s\": stepped after the end", text);
+}
+
+// Glyph, gap, glyph: narrow glyphs keep their own width
+static void test_gap(void) {
+    scroller_t s;
+    uint8_t i = font_index('I');
+    uint8_t w = font_width(i);
+    uint8_t cols[32];
+
+    scroller_start(&s, "II", 0);
+    for (int k = 0; k < 2 * (w + SCROLL_GLYPH_GAP); k++) cols[k] = scroller_next_column(&s);
+
+    int bad = 0;
+    for (int g = 0; g < 2; g++) {
+        uint8_t *c = &cols[g * (w + SCROLL_GLYPH_GAP)];
+        for (int k = 0; k < w; k++) bad += c[k] != font_columns[i][font_left(i) + k];
+        for (int k = 0; k < SCROLL_GLYPH_GAP; k++) bad += c[w + k] != 0x00;
+    }
+    CHECK(bad == 0, "\"II\": %d columns off the glyph-gap-glyph pattern", bad);
+    CHECK(cols[0] != 0x00 && cols[w - 1] != 0x00, "'I' padded with blank columns");
+}
+
+// A looping message comes round again, without a second tail
+static void test_loop(void) {
+    static const char text[] = "Ab 1";
+    scroller_t s;
+    int bad = 0;
+
+    expect(text);
+    scroller_start(&s, text, 1);
+    for (int round = 0; round < 3; round++) {
+        for (uint32_t k = 0; k < want_n; k++) bad += scroller_next_column(&s) != want[k];
+    }
+    CHECK(bad == 0 && !s.done, "looping \"%s\": %d columns off over three rounds", text, bad);
+    CHECK(scroller_period_ms(25) == 40 && scroller_period_ms(2000) == 1 &&
+          scroller_period_ms(0) == 0, "scroll periods");
+}
+
+int main(int argc, char **argv) {
+    FILE *pbm = NULL;
+    if (argc > 1 && !(pbm = fopen(argv[1], "w"))) {
+        perror(argv[1]);
+        return 1;
+    }
+    test_message("Ab1 ÇI!", pbm);
+    if (pbm) fclose(pbm);
+    test_message("", NULL);
+    test_message("Wide MW, narrow il1.", NULL);
+    test_gap();
+    test_loop();
+    return check_done("test_scroll");
+}
@@ -0,0 +1,93 @@
+// Frame-to-wire comparison of the transports: the same calls go through
+// bit-bang, SPI+DMA and GPIO DMA, and the bytes shifted between CS edges
+// must be identical. Built for one module and for a chain.
+#include <stdlib.h>
+#include "check.h"
+#include "hw.h"
+#include "max7219.h"
+
+uint32_t clock_pclk2_hz(void) {
+    return SystemCoreClock;
+}
+
+#define TRANSPORTS 3
+
+static const char *names[TRANSPORTS] = { "bitbang", "spi_dma", "gpio_dma" };
+
+// Frames and encodings the DMA reads in place, so static (see hw.h)
+static uint16_t frames[9][MAX7219_FRAME_WORDS];
+static uint32_t encoded[8 * (2 + 32 * MAX7219_NUM_DEVICES)];
+
+static void make_frames(void) {
+    srand(7);
+    for (int latches = 0; latches <= 8; latches++) {
+        for (int i = 0; i < latches * MAX7219_NUM_DEVICES; i++) {
+            frames[latches][i] = MAX7219_WORD(REG_DIGIT0 + i / MAX7219_NUM_DEVICES, rand() & 0xFF);
+        }
+    }
+}
+
+// Everything a firmware sends, in one recording
+static void run(transport_t transport, hw_wire_t *wire) {
+    uint8_t data[MAX7219_NUM_DEVICES];
+
+    hw_reset();
+    hw_wire_init(wire);
+    hw_attach(wire, NULL);
+    transport_init(transport);
+    transport_reset_stats();
+
+    init_max7219(0x0A);
+    send_cmd(REG_NOOP, 0x00);
+    max7219_set_intensity(0x04);
+    for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+        send_cmd_to(dev, REG_SHUTDOWN, dev & 1);
+        data[dev] = (uint8_t)(0x81 + dev);
+    }
+    send_row(REG_DIGIT0 + 5, data);
+
+    for (int latches = 0; latches <= 8; latches++) {
+        send_frame(frames[latches], latches);
+    }
+    while (transport_busy());
+    send_frame_ref(frames[8], 8);
+    while (transport_busy());
+    send_frame(frames[8], 12);      // Clamped to 8
+
+    // Pre-encoded frames go out the same way
+    uint32_t bytes = transport_encode(frames[3], 3, encoded);
+    CHECK(bytes == transport_encoded_bytes(3), "%s: encode gave %u bytes", names[transport], bytes);
+    while (transport_busy());
+    send_encoded_ref(encoded, 3);
+    while (transport_busy());
+    hw_sync();
+}
+
+int main(void) {
+    static hw_wire_t wires[TRANSPORTS];
+    uint32_t sent[TRANSPORTS];
+
+    make_frames();
+    for (int t = 0; t < TRANSPORTS; t++) {
+        run((transport_t)t, &wires[t]);
+        sent[t] = transport_bytes_sent();
+        CHECK(!wires[t].overflow, "%s: recording overflowed", names[t]);
+    }
+
+    // 13 init latches, NOOP, intensity, one per device, the row, 36 frame
+    // latches, send_frame_ref, the clamped frame and the encoded one
+    uint16_t want = 13 + 2 + MAX7219_NUM_DEVICES + 1 + 36 + 8 + 8 + 3;
+    CHECK(wires[0].latches == want, "bitbang: %u latches, expected %u", wires[0].latches, want);
+    for (int l = 0; l < wires[0].latches; l++) {
+        CHECK(wires[0].len[l] == 2 * MAX7219_NUM_DEVICES, "bitbang: latch %d has %u bytes", l,
+              wires[0].len[l]);
+    }
+    CHECK(sent[0] == (uint32_t)want * 2 * MAX7219_NUM_DEVICES, "bitbang: %u bytes counted", sent[0]);
+
+    for (int t = 1; t < TRANSPORTS; t++) {
+        CHECK(hw_wire_equal(&wires[0], &wires[t]), "%s: wire differs from bitbang (%u latches)",
+              names[t], wires[t].latches);
+        CHECK(sent[t] == sent[0], "%s: %u bytes counted, bitbang %u", names[t], sent[t], sent[0]);
+    }
+    return check_done(MAX7219_NUM_DEVICES == 1 ? "test_transport" : "test_transport (chain)");
+}
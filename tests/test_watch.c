@@ -0,0 +1,152 @@
+// Clock face: a simulated RTC is stepped one second at a time with
+// watch_time_add() through a whole day and across midnight, with and
+// without seconds. Checks that the face is redrawn once a minute (once a
+// second with seconds shown), the mask of digits redrawn, and every row
+// against a face drawn here from the glyphs, plus the RTC_TR BCD
+// conversions both ways.
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "watch.h"
+#include "font.h"
+
+#define WIDTH (8 * MAX7219_NUM_DEVICES)
+
+_Static_assert(WATCH_WIDTH(1) <= WIDTH, "face with seconds wider than the chain");
+
+static uint8_t digit_of(const watch_time_t *t, int i) {
+    uint8_t v = i < 2 ? t->hours : i < 4 ? t->minutes : t->seconds;
+    return i % 2 ? v % 10 : v / 10;
+}
+
+// Lit pixels of a glyph with its first lit column at x
+static void put_glyph(uint8_t face[8][WIDTH], int x, uint8_t index) {
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            if (font_glyphs[index][row] & (0x80 >> col)) face[row][x + col - font_left(index)] = 1;
+        }
+    }
+}
+
+// HH:MM[:SS] centred, 7-pixel digit cells and 3-pixel colon cells
+static void draw_face(const watch_time_t *t, uint8_t show_seconds, uint8_t face[8][WIDTH]) {
+    int count = show_seconds ? 6 : 4;
+    int x = (WIDTH - (count * WATCH_DIGIT_W + (count / 2 - 1) * WATCH_COLON_W)) / 2;
+
+    memset(face, 0, 8 * WIDTH);
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && i % 2 == 0) {
+            put_glyph(face, x, GLYPH_COLON);
+            x += WATCH_COLON_W;
+        }
+        put_glyph(face, x, (uint8_t)(GLYPH_DIGIT_0 + digit_of(t, i)));
+        x += WATCH_DIGIT_W;
+    }
+}
+
+static int rows_differ(uint8_t rows[][8], uint8_t face[8][WIDTH]) {
+    int bad = 0;
+    for (int x = 0; x < WIDTH; x++) {
+        for (int row = 0; row < 8; row++) {
+            bad += ((rows[x / 8][row] >> (7 - x % 8)) & 1) != face[row][x];
+        }
+    }
+    return bad;
+}
+
+// From start, one second at a time for a day and a bit
+static void run_day(uint8_t show_seconds, watch_time_t start) {
+    static uint8_t face[8][WIDTH];
+    uint8_t rows[MAX7219_NUM_DEVICES][8];
+    uint8_t count = show_seconds ? 6 : 4;
+    watch_time_t t = start, prev;
+    watch_t w;
+    uint32_t redraws = 0, late = 0, extra = 0, bad_mask = 0, bad_rows = 0, bad_time = 0;
+    uint32_t s0 = start.hours * 3600u + start.minutes * 60u + start.seconds;
+
+    watch_init(&w, show_seconds);
+    uint8_t mask = watch_update(&w, &t, rows);
+    draw_face(&t, show_seconds, face);
+    CHECK(mask == (1 << count) - 1 && rows_differ(rows, face) == 0,
+          "first update: mask %02X, %d pixels off the face", mask, rows_differ(rows, face));
+
+    for (uint32_t k = 1; k <= 86400 + 120; k++) {
+        prev = t;
+        watch_time_add(&t, 1);
+        uint32_t s = (s0 + k) % 86400;
+        if (t.hours != s / 3600 || t.minutes != s / 60 % 60 || t.seconds != s % 60) bad_time++;
+
+        uint8_t want = 0;
+        for (int i = 0; i < count; i++) {
+            if (digit_of(&t, i) != digit_of(&prev, i)) want |= (uint8_t)(1 << i);
+        }
+        mask = watch_update(&w, &t, rows);
+        if (mask) {
+            redraws++;
+            draw_face(&t, show_seconds, face);
+            if (rows_differ(rows, face) && bad_rows++ < 2) {
+                CHECK(0, "%02u:%02u:%02u: %d pixels off the face", t.hours, t.minutes, t.seconds,
+                      rows_differ(rows, face));
+            }
+        }
+        if (mask != want && bad_mask++ < 2) {
+            CHECK(0, "%02u:%02u:%02u: mask %02X, not %02X", t.hours, t.minutes, t.seconds, mask,
+                  want);
+        }
+        // A new minute must redraw, nothing else may without seconds
+        if (!mask && (show_seconds || t.seconds == 0)) late++;
+        if (mask && !show_seconds && t.seconds != 0) extra++;
+    }
+    CHECK(bad_time == 0, "watch_time_add off the second count %u times", bad_time);
+    CHECK(bad_mask == 0, "%u wrong masks", bad_mask);
+    CHECK(bad_rows == 0, "%u redraws off the face", bad_rows);
+    CHECK(late == 0 && extra == 0, "%u missed and %u extra redraws", late, extra);
+    uint32_t want_redraws = show_seconds ? 86400 + 120 : 1440 + 2;
+    CHECK(redraws == want_redraws, "%u redraws in a day from %02u:%02u:%02u, not %u", redraws,
+          start.hours, start.minutes, start.seconds, want_redraws);
+}
+
+static uint32_t tr(int h, int m, int s) {
+    return (uint32_t)(h / 10) << 20 | (uint32_t)(h % 10) << 16 | (uint32_t)(m / 10) << 12 |
+           (uint32_t)(m % 10) << 8 | (uint32_t)(s / 10) << 4 | (uint32_t)(s % 10);
+}
+
+// Every second of the day through RTC_TR and back
+static void test_bcd(void) {
+    watch_time_t t = { 0, 0, 0 }, back;
+    int bad = 0;
+
+    for (uint32_t k = 0; k < 86400; k++) {
+        uint32_t bcd = watch_time_to_bcd(&t);
+        watch_time_from_bcd(bcd, &back);
+        if (bcd != tr(t.hours, t.minutes, t.seconds) || memcmp(&back, &t, sizeof(t)) != 0) bad++;
+        watch_time_add(&t, 1);
+    }
+    CHECK(bad == 0, "%d seconds of the day do not round trip", bad);
+    CHECK(t.hours == 0 && t.minutes == 0 && t.seconds == 0,
+          "a day from midnight ends at %02u:%02u:%02u", t.hours, t.minutes, t.seconds);
+
+    // Midnight rollover as the RTC registers see it
+    watch_time_from_bcd(0x235959, &t);
+    watch_time_add(&t, 1);
+    CHECK(watch_time_to_bcd(&t) == 0x000000, "23:59:59 + 1 s is %06X",
+          (unsigned)watch_time_to_bcd(&t));
+    watch_time_from_bcd(0x235930, &t);
+    watch_time_add(&t, 3 * 86400 + 45);
+    CHECK(watch_time_to_bcd(&t) == 0x000015, "23:59:30 + 3 days 45 s is %06X",
+          (unsigned)watch_time_to_bcd(&t));
+
+    // PM flag and reserved bits of RTC_TR are not part of the time
+    watch_time_from_bcd(0x00400000 | 0x8080 | 0x123456, &t);
+    CHECK(t.hours == 12 && t.minutes == 34 && t.seconds == 56,
+          "RTC_TR flags read as %02u:%02u:%02u", t.hours, t.minutes, t.seconds);
+}
+
+int main(void) {
+    run_day(0, (watch_time_t){ 0, 0, 0 });
+    run_day(0, (watch_time_t){ 23, 58, 30 });
+    run_day(1, (watch_time_t){ 0, 0, 0 });
+    run_day(1, (watch_time_t){ 23, 59, 59 });
+    test_bcd();
+    return check_done("test_watch");
+}
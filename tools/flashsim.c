@@ -0,0 +1,306 @@
+// flashsim: play an animation image (anim.h) through the firmware's
+// streaming decoder from a simulated SPI flash backed by a file, to size
+// the read-ahead and find underruns before an image goes to the board.
+// Host tool, built from the repository root:
+//
+//   cc -O2 -I. [-DMAX7219_NUM_DEVICES=n] -o flashsim tools/flashsim.c stream.c anim.c
+//   ./flashsim -w image.bin [-d devices] [-n frames] [-m ms] [-k percent] [-f frame]
+//   ./flashsim [-c chunks] [-l us] [-b kB/s] [-p ms] [-t ms] [-s seconds] [-x stalls]
+//              image.bin
+//
+// make -C tests stream builds it and plays a test image both ways.
+//
+//   -w  write a test image instead of playing: pseudo-random frames with
+//       k percent of the bytes changing each frame (default 25), m ms
+//       each (default 20), a key frame every 16 and at the loop frame f
+//       (default 0)
+//   -c  chunk sizes to try, e.g. 96,128,256 (default ANIM_STREAM_CHUNK)
+//   -l  latency of a read command in us (default 10)
+//   -b  transfer rate in kB/s (default 1250, READ at 10 MHz)
+//   -p  read-ahead poll period in ms (default 2, as the firmware)
+//   -t  player tick in ms (default 20, the vsync rate)
+//   -s  simulated playing time in seconds (default 60)
+//   -x  stalls a chunk size may have before the exit status says so
+//       (default no limit)
+//
+// Time is simulated in 100 us steps: a read completes latency plus its
+// transfer time after it starts. Every decoded frame is checked against
+// the record at the same place in the file, found by walking the length
+// prefixes and going back to the loop record after the last, so a wrong
+// wrap of the read-ahead shows as a mismatch. A stall is a tick at which
+// the next frame was due but its record was not in RAM yet.
+//
+// Exit status 1 for a mismatch or a malformed image, 2 when a chunk size
+// stalled more often than -x allows, 0 otherwise.
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "anim.h"
+
+#define STEP_US 100
+#define MAX_CHUNKS 16
+
+static uint8_t *image;
+static uint32_t image_size;
+
+// Storage timing and the simulated clock
+static uint64_t now_us;
+static uint64_t done_us;
+static uint32_t latency_us = 10;
+static uint32_t rate_kbs = 1250;
+static uint32_t reads;
+static uint8_t playing;
+
+static void die(const char *msg, const char *arg) {
+    fprintf(stderr, "flashsim: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(1);
+}
+
+// Erased flash past the end of the image
+static void copy_image(uint32_t addr, uint8_t *buf, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        buf[i] = addr + i < image_size ? image[addr + i] : 0xFF;
+    }
+}
+
+// The file as a flash chip: data lands at once, busy until it would have
+static void flash_read(uint32_t addr, uint8_t *buf, uint16_t len) {
+    copy_image(addr, buf, len);
+    done_us = now_us + latency_us + (uint64_t)len * 1000 / rate_kbs;
+    reads++;
+}
+
+// Blocking waits before playback (the header read) just let time pass
+static uint8_t flash_busy(void) {
+    if (!playing && now_us < done_us) now_us = done_us;
+    return now_us < done_us;
+}
+
+static const storage_t flash = { flash_read, flash_busy };
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    return in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static void write_image(const char *path, uint8_t devices, uint16_t frames, uint16_t ms,
+                        uint32_t percent, uint16_t loop_frame) {
+    uint16_t size = 8 * devices;
+    uint8_t prev[ANIM_FRAME_BYTES] = { 0 };
+    uint8_t cur[ANIM_FRAME_BYTES] = { 0 };
+    uint8_t record[3 + 2 * (ANIM_FRAME_BYTES + ANIM_FRAME_BYTES / 128 + 1)];
+    uint32_t body = 0, loop_offset = 0;
+
+    if (devices == 0 || devices > MAX7219_NUM_DEVICES) die("devices out of range", NULL);
+    if (loop_frame >= frames) die("loop frame out of range", NULL);
+    image = malloc(ANIM_IMAGE_HEADER + (size_t)frames * (2 + sizeof(record)));
+    if (!image) die("out of memory", NULL);
+
+    for (uint16_t f = 0; f < frames; f++) {
+        for (uint16_t i = 0; i < size; i++) {
+            if (rng() % 100 < percent) cur[i] = (uint8_t)rng();
+        }
+        // Playback comes back to the loop frame from the last one
+        uint8_t key = f % 16 == 0 || f == loop_frame;
+        uint16_t len = anim_encode_frame(key ? NULL : prev, cur, size, ms, ANIM_CUT, record);
+        if (f == loop_frame) loop_offset = body;
+        uint8_t *out = image + ANIM_IMAGE_HEADER + body;
+        out[0] = (uint8_t)len;
+        out[1] = (uint8_t)(len >> 8);
+        memcpy(out + 2, record, len);
+        body += 2u + len;
+        memcpy(prev, cur, size);
+    }
+
+    anim_seq_t seq = { 0, frames, loop_frame, 0, devices };
+    anim_image_header(&seq, loop_offset, body, image);
+    image_size = ANIM_IMAGE_HEADER + body;
+
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(image, 1, image_size, f) != image_size) die(strerror(errno), path);
+    fclose(f);
+    printf("%s: %u frames of %u devices, %u bytes, %u bytes/s at %u ms per frame\n", path, frames,
+           devices, image_size, (uint32_t)((uint64_t)body * 1000 / ((uint64_t)frames * ms)), ms);
+}
+
+static void load_image(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) die(strerror(errno), path);
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    image = malloc(n > 0 ? (size_t)n : 1);
+    if (!image || fread(image, 1, (size_t)n, f) != (size_t)n) die("cannot read", path);
+    fclose(f);
+    image_size = (uint32_t)n;
+}
+
+// Decode the record at *at of the image in memory, without the stream,
+// and move *at to the next one, back to the loop record after the last
+static void decode_reference(uint32_t *at, uint8_t *frame, anim_frame_info_t *info,
+                             uint32_t *loops) {
+    uint32_t size = get_u32(&image[16]);
+    uint32_t len = 0;
+    anim_decoder_t dec;
+
+    if (*at + 2 <= size && ANIM_IMAGE_HEADER + size <= image_size) {
+        const uint8_t *p = image + ANIM_IMAGE_HEADER + *at;
+        len = p[0] | ((uint32_t)p[1] << 8);
+    }
+    if (len < 4 || *at + 2 + len > size) die("malformed record", NULL);
+
+    // The record alone, as a one-frame sequence
+    anim_seq_t one = { image + ANIM_IMAGE_HEADER + *at + 2, 1, 0, 0, image[8] };
+    anim_decoder_start(&dec, &one);
+    if (!anim_decode_next(&dec, frame, info) || dec.pos != one.data + len) {
+        die("malformed record", NULL);
+    }
+    *at += 2 + len;
+    if (*at == size) {
+        *at = get_u32(&image[12]);
+        (*loops)++;
+    }
+}
+
+// Play for seconds with one chunk size and print one result line.
+// Returns the stalls, or -1 after a mismatch.
+static int32_t play(uint16_t chunk, uint32_t poll_ms, uint32_t tick_ms, uint32_t seconds) {
+    static anim_seq_t seq;
+    static stream_t s;
+    static anim_decoder_t dec;
+    uint8_t *buf = malloc(2u * chunk);
+    uint8_t frame[ANIM_FRAME_BYTES] = { 0 };
+    uint8_t ref_frame[ANIM_FRAME_BYTES] = { 0 };
+    anim_frame_info_t info, ref_info;
+    uint32_t ref_at = 0, loops = 0;
+
+    now_us = done_us = 0;
+    reads = 0;
+    playing = 0;
+    if (!buf) die("out of memory", NULL);
+    if (!anim_image_open(&seq, &s, &flash, buf, chunk, 0)) {
+        if (image_size < ANIM_IMAGE_HEADER || get_u32(image) != ANIM_IMAGE_MAGIC) {
+            die("not a valid animation image", NULL);
+        }
+        printf("chunk %5u: too small for the records\n", chunk);
+        free(buf);
+        return 0;
+    }
+    anim_decoder_stream(&dec, &seq, &s);
+
+    uint32_t frames = 0, stalls = 0, run = 0, longest = 0, mismatches = 0;
+    uint32_t margin = UINT32_MAX;
+    // Playback starts on the first tick after the header is in
+    uint64_t tick_us = (uint64_t)tick_ms * 1000;
+    uint64_t due_us = (now_us + tick_us - 1) / tick_us * tick_us;
+    uint64_t end_us = due_us + (uint64_t)seconds * 1000000;
+
+    playing = 1;
+    for (now_us = due_us; now_us < end_us; now_us += STEP_US) {
+        if (now_us % ((uint64_t)poll_ms * 1000) == 0) stream_poll(&s);
+        if (now_us % tick_us != 0 || now_us < due_us) continue;
+
+        uint8_t r = anim_decode_next(&dec, frame, &info);
+        if (r == ANIM_WAIT) {
+            stalls++;
+            if (++run > longest) longest = run;
+            continue;
+        }
+        if (r == 0) die("malformed record", NULL);
+        decode_reference(&ref_at, ref_frame, &ref_info, &loops);
+        if (memcmp(frame, ref_frame, 8u * seq.devices) || info.duration_ms != ref_info.duration_ms) {
+            mismatches++;
+        }
+        // Data already in RAM for the frames after this one
+        uint32_t ahead = stream_available(&s);
+        if (ahead < margin) margin = ahead;
+
+        // A late frame starts late, as on the display
+        due_us = (run ? now_us : due_us) + (uint64_t)info.duration_ms * 1000;
+        run = 0;
+        frames++;
+    }
+
+    printf("chunk %5u: %u frames, %u stalls (longest %u ms), read-ahead min %u bytes, "
+           "%u reads, %u bytes, %u loops, %u mismatches\n",
+           chunk, frames, stalls, longest * tick_ms, margin == UINT32_MAX ? 0 : margin, reads,
+           s.bytes_read, loops, mismatches);
+    free(buf);
+    return mismatches ? -1 : (int32_t)stalls;
+}
+
+int main(int argc, char **argv) {
+    const char *out = NULL, *src = NULL;
+    uint32_t devices = MAX7219_NUM_DEVICES, frames = 256, ms = 20, percent = 25;
+    uint32_t poll_ms = 2, tick_ms = 20, seconds = 60, loop_frame = 0;
+    uint32_t max_stalls = UINT32_MAX;
+    int status = 0;
+    uint16_t chunks[MAX_CHUNKS] = { ANIM_STREAM_CHUNK };
+    int chunk_count = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (a[0] != '-') {
+            src = a;
+            continue;
+        }
+        if (a[1] == '\0' || a[2] != '\0' || i + 1 >= argc) die("bad option", a);
+        const char *v = argv[++i];
+        switch (a[1]) {
+        case 'w': out = v; break;
+        case 'd': devices = (uint32_t)atoi(v); break;
+        case 'n': frames = (uint32_t)atoi(v); break;
+        case 'm': ms = (uint32_t)atoi(v); break;
+        case 'k': percent = (uint32_t)atoi(v); break;
+        case 'l': latency_us = (uint32_t)atoi(v); break;
+        case 'b': rate_kbs = (uint32_t)atoi(v); break;
+        case 'p': poll_ms = (uint32_t)atoi(v); break;
+        case 't': tick_ms = (uint32_t)atoi(v); break;
+        case 's': seconds = (uint32_t)atoi(v); break;
+        case 'f': loop_frame = (uint32_t)atoi(v); break;
+        case 'x': max_stalls = (uint32_t)atoi(v); break;
+        case 'c':
+            chunk_count = 0;
+            for (char *p = (char *)v; *p && chunk_count < MAX_CHUNKS; ) {
+                chunks[chunk_count++] = (uint16_t)strtoul(p, &p, 0);
+                if (*p == ',') p++;
+            }
+            break;
+        default: die("bad option", a);
+        }
+    }
+    if (rate_kbs == 0 || poll_ms == 0 || tick_ms == 0 || frames == 0 || frames > 0xFFFF) {
+        die("bad option value", NULL);
+    }
+
+    if (out) {
+        write_image(out, (uint8_t)devices, (uint16_t)frames, (uint16_t)ms, percent,
+                    (uint16_t)loop_frame);
+        return 0;
+    }
+    if (!src) die("usage: flashsim [options] image.bin, or flashsim -w image.bin", NULL);
+
+    load_image(src);
+    printf("%s: %u bytes, read latency %u us at %u kB/s, poll %u ms, tick %u ms, %u s\n", src,
+           image_size, latency_us, rate_kbs, poll_ms, tick_ms, seconds);
+    for (int c = 0; c < chunk_count; c++) {
+        int32_t stalls = play(chunks[c], poll_ms, tick_ms, seconds);
+        if (stalls < 0) {
+            status = 1;
+        } else if ((uint32_t)stalls > max_stalls && status == 0) {
+            status = 2;
+        }
+    }
+    free(image);
+    return status;
+}
@@ -0,0 +1,589 @@
+// fontc: compile a BDF or PSF bitmap font into an atlas (atlas.h) that
+// the firmware links in. Host tool, plain C99:
+//
+//   cc -O2 -o fontc tools/fontc.c
+//   ./fontc [-n name] [-o out.c] [-r ranges] [-t row] [-c raw|crop|rows] font
+//
+//   -n  atlas variable name, default atlas_<file name>
+//   -o  output file, default stdout
+//   -r  code points to keep, e.g. 0x20-0x7E,0xC7,0x11E-0x11F (default all)
+//   -t  font row shown as matrix row 0, counted from the top of the cell
+//       (the ascent line for BDF). May be negative to pad the top.
+//   -c  raw: 8x8 cells, crop: per-glyph width, rows: crop plus a lit row
+//       mask. Default: whichever is smallest for the font.
+//
+// Glyphs are cropped to the 8x8 matrix; pixels that fall outside are
+// counted and reported. The flash size of every compression mode goes to
+// stderr so fonts and modes can be compared.
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_GLYPHS 65536
+#define MAX_RANGES 64
+#define NO_CODEPOINT 0xFFFFFFFFu
+
+// Mirrors atlas.h, which is firmware code and not included here
+#define ATLAS_CROPPED  0x01
+#define ATLAS_ROW_MASK 0x02
+#define ATLAS_GROUP 8
+#define ATLAS_NO_GLYPH 0xFFFF
+#define ATLAS_RANGE_BYTES 8
+
+typedef struct {
+    uint32_t cp;
+    uint8_t rows[8];
+} glyph_t;
+
+typedef struct {
+    glyph_t *glyphs;
+    uint32_t count;
+    int32_t missing;            // Index of the default glyph, -1 if none
+    uint32_t clipped;           // Lit pixels outside the matrix
+} font_t;
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} cp_range_t;
+
+static cp_range_t keep[MAX_RANGES];
+static int keep_count;
+
+static void die(const char *msg, const char *arg) {
+    fprintf(stderr, "fontc: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(1);
+}
+
+static uint8_t *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) die(strerror(errno), path);
+
+    size_t cap = 65536;
+    size_t n = 0;
+    uint8_t *buf = malloc(cap + 1);
+    size_t got;
+    while (buf && (got = fread(buf + n, 1, cap - n, f)) > 0) {
+        n += got;
+        if (n == cap) {
+            cap *= 2;
+            buf = realloc(buf, cap + 1);
+        }
+    }
+    if (!buf) die("out of memory", NULL);
+    fclose(f);
+    buf[n] = 0;
+    *len = n;
+    return buf;
+}
+
+static int keep_cp(uint32_t cp) {
+    if (cp == NO_CODEPOINT) return 0;
+    if (keep_count == 0) return cp <= 0x10FFFF;
+    for (int i = 0; i < keep_count; i++) {
+        if (cp >= keep[i].first && cp <= keep[i].last) return 1;
+    }
+    return 0;
+}
+
+static void parse_ranges(const char *s) {
+    while (*s) {
+        char *end;
+        if (keep_count == MAX_RANGES) die("too many ranges", NULL);
+        keep[keep_count].first = (uint32_t)strtoul(s, &end, 0);
+        if (end == s) die("bad range list", s);
+        keep[keep_count].last = keep[keep_count].first;
+        s = end;
+        if (*s == '-') {
+            keep[keep_count].last = (uint32_t)strtoul(s + 1, &end, 0);
+            if (end == s + 1) die("bad range list", s);
+            s = end;
+        }
+        keep_count++;
+        if (*s == ',') s++;
+        else if (*s) die("bad range list", s);
+    }
+}
+
+// Light up matrix pixel (x, row), or count it as clipped
+static void put_pixel(uint8_t rows[8], int x, int row, uint32_t *clipped) {
+    if (x < 0 || x > 7 || row < 0 || row > 7) {
+        (*clipped)++;
+        return;
+    }
+    rows[row] |= (uint8_t)(0x80 >> x);
+}
+
+static glyph_t *new_glyph(font_t *f, uint32_t cp) {
+    if (f->count == MAX_GLYPHS) die("too many glyphs", NULL);
+    glyph_t *g = &f->glyphs[f->count++];
+    memset(g, 0, sizeof(*g));
+    g->cp = cp;
+    return g;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int starts_with(const char *line, const char *key) {
+    size_t n = strlen(key);
+    return strncmp(line, key, n) == 0 && (line[n] == ' ' || line[n] == '\0' ||
+                                          line[n] == '\r' || line[n] == '\n');
+}
+
+// BDF 2.1. Pixel rows are placed relative to the baseline: matrix row 0
+// is the font row top_row below the ascent line.
+static void load_bdf(font_t *f, char *text, int have_top, int top_row) {
+    int ascent = -1, descent = -1, bbx_h = 0, bbx_y = 0;
+    long default_char = -1;
+    char *line = text;
+
+    // Properties first, they come before the glyphs
+    for (char *p = text; p && *p; ) {
+        char *next = strchr(p, '\n');
+        if (starts_with(p, "FONT_ASCENT")) ascent = atoi(p + 11);
+        else if (starts_with(p, "FONT_DESCENT")) descent = atoi(p + 12);
+        else if (starts_with(p, "DEFAULT_CHAR")) default_char = atol(p + 12);
+        else if (starts_with(p, "FONTBOUNDINGBOX")) sscanf(p + 15, "%*d %d %*d %d", &bbx_h, &bbx_y);
+        else if (starts_with(p, "CHARS")) break;
+        p = next ? next + 1 : NULL;
+    }
+    if (ascent < 0) ascent = bbx_h + bbx_y;
+    if (descent < 0) descent = -bbx_y;
+
+    // Default: the whole cell when it fits (padded at the top), else the
+    // ascent and at most one row of descent
+    if (!have_top) {
+        if (ascent + descent <= 8) top_row = ascent + descent - 8;
+        else top_row = ascent - 8 + (descent > 0 ? 1 : 0);
+    }
+    int top_y = ascent - 1 - top_row;
+
+    glyph_t *g = NULL;
+    long encoding = -1;
+    int w = 0, h = 0, xoff = 0, yoff = 0, bitmap_row = -1;
+
+    while (line && *line) {
+        char *next = strchr(line, '\n');
+        if (next) *next = '\0';
+
+        if (starts_with(line, "STARTCHAR")) {
+            encoding = -1;
+            w = h = xoff = yoff = 0;
+        } else if (starts_with(line, "ENCODING")) {
+            encoding = atol(line + 8);
+        } else if (starts_with(line, "BBX")) {
+            sscanf(line + 3, "%d %d %d %d", &w, &h, &xoff, &yoff);
+        } else if (starts_with(line, "BITMAP")) {
+            uint32_t cp = encoding >= 0 ? (uint32_t)encoding : NO_CODEPOINT;
+            int is_default = encoding >= 0 && encoding == default_char;
+            // Unencoded glyphs are kept only as the default glyph
+            if (keep_cp(cp) || is_default || (encoding < 0 && f->missing < 0)) {
+                g = new_glyph(f, keep_cp(cp) ? cp : NO_CODEPOINT);
+                if (is_default || encoding < 0) f->missing = (int32_t)(f->count - 1);
+            } else {
+                g = NULL;
+            }
+            bitmap_row = 0;
+        } else if (starts_with(line, "ENDCHAR")) {
+            g = NULL;
+            bitmap_row = -1;
+        } else if (bitmap_row >= 0 && bitmap_row < h) {
+            if (g) {
+                int y = yoff + (h - 1 - bitmap_row);
+                for (int x = 0; x < w; x++) {
+                    int d = hex_digit(line[x / 4]);
+                    if (d < 0) break;
+                    if (d & (8 >> (x % 4))) put_pixel(g->rows, xoff + x, top_y - y, &f->clipped);
+                }
+            }
+            bitmap_row++;
+        }
+        line = next ? next + 1 : NULL;
+    }
+}
+
+// PSF1 and PSF2 console fonts, with or without a Unicode table. Every
+// code point of the table that is kept becomes a glyph of its own.
+static void load_psf(font_t *f, const uint8_t *data, size_t len, int have_top, int top_row) {
+    uint32_t count, charsize, height, width, header;
+    int has_table, psf2;
+
+    if (len >= 4 && data[0] == 0x36 && data[1] == 0x04) {
+        psf2 = 0;
+        header = 4;
+        count = (data[2] & 0x01) ? 512 : 256;
+        has_table = (data[2] & 0x06) != 0;
+        charsize = height = data[3];
+        width = 8;
+    } else if (len >= 32 && data[0] == 0x72 && data[1] == 0xB5 && data[2] == 0x4A && data[3] == 0x86) {
+        psf2 = 1;
+#define LE32(o) ((uint32_t)data[o] | (uint32_t)data[(o) + 1] << 8 | \
+                 (uint32_t)data[(o) + 2] << 16 | (uint32_t)data[(o) + 3] << 24)
+        header = LE32(8);
+        has_table = LE32(12) & 0x01;
+        count = LE32(16);
+        charsize = LE32(20);
+        height = LE32(24);
+        width = LE32(28);
+#undef LE32
+    } else {
+        die("not a BDF or PSF font", NULL);
+    }
+    if (header > len || count > MAX_GLYPHS || (size_t)count * charsize > len - header ||
+        (size_t)height * ((width + 7) / 8) > charsize) {
+        die("truncated PSF font", NULL);
+    }
+    if (!have_top) top_row = height >= 8 ? (int)(height - 8) / 2 : (int)height - 8;
+
+    // Crop every bitmap first, the table may name a glyph several times
+    uint32_t stride = (width + 7) / 8;
+    glyph_t *cells = calloc(count, sizeof(glyph_t));
+    uint32_t *clipped = calloc(count, sizeof(uint32_t));
+    if (!cells || !clipped) die("out of memory", NULL);
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *bm = data + header + (size_t)i * charsize;
+        for (uint32_t r = 0; r < height; r++) {
+            for (uint32_t x = 0; x < width; x++) {
+                if (bm[r * stride + x / 8] & (0x80 >> (x % 8))) {
+                    put_pixel(cells[i].rows, (int)x, (int)r - top_row, &clipped[i]);
+                }
+            }
+        }
+    }
+
+    // Table: per glyph its code points, then sequences we do not use,
+    // ended by 0xFFFF (PSF1, UCS-2) or 0xFF (PSF2, UTF-8)
+    size_t pos = header + (size_t)count * charsize;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!has_table) {
+            if (!keep_cp(i)) continue;
+            glyph_t *g = new_glyph(f, i);
+            memcpy(g->rows, cells[i].rows, sizeof(g->rows));
+            f->clipped += clipped[i];
+            continue;
+        }
+
+        int in_seq = 0;
+        while (pos < len) {
+            uint32_t cp;
+            if (!psf2) {
+                if (pos + 1 >= len) die("truncated PSF Unicode table", NULL);
+                cp = data[pos] | (uint32_t)data[pos + 1] << 8;
+                pos += 2;
+                if (cp == 0xFFFF) break;
+                if (cp == 0xFFFE) { in_seq = 1; continue; }
+            } else {
+                uint8_t b = data[pos++];
+                if (b == 0xFF) break;
+                if (b == 0xFE) { in_seq = 1; continue; }
+                int extra = b >= 0xF0 ? 3 : b >= 0xE0 ? 2 : b >= 0xC0 ? 1 : 0;
+                cp = extra ? b & (0x3Fu >> extra) : b;
+                for (int k = 0; k < extra && pos < len; k++) cp = cp << 6 | (data[pos++] & 0x3F);
+            }
+            if (in_seq || !keep_cp(cp)) continue;
+            glyph_t *g = new_glyph(f, cp);
+            memcpy(g->rows, cells[i].rows, sizeof(g->rows));
+            f->clipped += clipped[i];
+        }
+    }
+    free(cells);
+    free(clipped);
+}
+
+// Same split as the built-in font: first lit column and lit width
+static void metrics(const glyph_t *g, uint8_t *left, uint8_t *width) {
+    uint8_t m = 0;
+    for (int r = 0; r < 8; r++) m |= g->rows[r];
+    if (m == 0) {
+        *left = 0;
+        *width = 0;
+        return;
+    }
+    int first = 0, last = 7;
+    while (!(m & (0x80 >> first))) first++;
+    while (!(m & (0x80 >> last))) last--;
+    *left = (uint8_t)first;
+    *width = (uint8_t)(last - first + 1);
+}
+
+typedef struct {
+    uint8_t *bits;
+    uint32_t pos;
+} bitstream_t;
+
+static void put_bits(bitstream_t *s, uint32_t v, int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        if (v & (1u << i)) s->bits[s->pos >> 3] |= (uint8_t)(0x80 >> (s->pos & 7));
+        s->pos++;
+    }
+}
+
+typedef struct {
+    uint8_t flags;
+    uint8_t *metrics;
+    uint32_t *offsets;
+    uint8_t *bits;
+    uint32_t bit_bytes;         // Including the padding byte
+    uint32_t offset_count;
+    uint32_t range_first[MAX_GLYPHS];
+    uint16_t range_count[MAX_GLYPHS];
+    uint16_t range_glyph[MAX_GLYPHS];
+    uint32_t ranges;
+} atlas_out_t;
+
+static int by_codepoint(const void *a, const void *b) {
+    uint32_t x = ((const glyph_t *)a)->cp, y = ((const glyph_t *)b)->cp;
+    return x < y ? -1 : x > y;
+}
+
+static void build(const font_t *f, uint8_t flags, atlas_out_t *o) {
+    uint32_t n = f->count;
+
+    o->flags = flags;
+    o->metrics = calloc(n ? n : 1, 1);
+    o->offset_count = (n + ATLAS_GROUP - 1) / ATLAS_GROUP;
+    o->offsets = calloc(o->offset_count ? o->offset_count : 1, sizeof(uint32_t));
+    o->bits = calloc((size_t)n * 9 + 2, 1);
+    if (!o->metrics || !o->offsets || !o->bits) die("out of memory", NULL);
+
+    bitstream_t s = { o->bits, 0 };
+    for (uint32_t i = 0; i < n; i++) {
+        const glyph_t *g = &f->glyphs[i];
+        uint8_t left, width;
+        metrics(g, &left, &width);
+        o->metrics[i] = (uint8_t)(left << 4 | width);
+        if (i % ATLAS_GROUP == 0) o->offsets[i / ATLAS_GROUP] = s.pos;
+
+        if (!(flags & ATLAS_CROPPED)) {
+            for (int r = 0; r < 8; r++) put_bits(&s, g->rows[r], 8);
+            continue;
+        }
+        if (width == 0) continue;
+        uint8_t mask = 0xFF;
+        if (flags & ATLAS_ROW_MASK) {
+            mask = 0;
+            for (int r = 0; r < 8; r++) {
+                if (g->rows[r]) mask |= (uint8_t)(0x80 >> r);
+            }
+            put_bits(&s, mask, 8);
+        }
+        for (int r = 0; r < 8; r++) {
+            if (mask & (0x80 >> r)) put_bits(&s, (uint32_t)(g->rows[r] << left) >> (8 - width), width);
+        }
+    }
+    o->bit_bytes = (s.pos + 7) / 8 + 1;
+
+    // Consecutive code points with consecutive glyphs share a range
+    o->ranges = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t cp = f->glyphs[i].cp;
+        if (cp == NO_CODEPOINT) continue;
+        if (o->ranges && cp == o->range_first[o->ranges - 1] + o->range_count[o->ranges - 1] &&
+            o->range_count[o->ranges - 1] < 0xFFFF) {
+            o->range_count[o->ranges - 1]++;
+            continue;
+        }
+        o->range_first[o->ranges] = cp;
+        o->range_count[o->ranges] = 1;
+        o->range_glyph[o->ranges] = (uint16_t)i;
+        o->ranges++;
+    }
+}
+
+static uint32_t flash_bytes(const atlas_out_t *o, uint32_t glyphs) {
+    uint32_t total = o->ranges * ATLAS_RANGE_BYTES + o->bit_bytes;
+    if (o->flags & ATLAS_CROPPED) total += glyphs + o->offset_count * 4;
+    return total;
+}
+
+static void free_out(atlas_out_t *o) {
+    free(o->metrics);
+    free(o->offsets);
+    free(o->bits);
+}
+
+static void emit_bytes(FILE *out, const char *decl, const uint8_t *v, uint32_t n) {
+    fprintf(out, "%s = {", decl);
+    for (uint32_t i = 0; i < n; i++) {
+        fprintf(out, "%s0x%02X,", i % 12 ? " " : "\n    ", v[i]);
+    }
+    fprintf(out, "\n};\n\n");
+}
+
+static void emit(FILE *out, const char *name, const char *src, const font_t *f, const atlas_out_t *o) {
+    const char *base = strrchr(src, '/');
+    base = base ? base + 1 : src;
+
+    fprintf(out, "// Generated by tools/fontc from %s, do not edit.\n", base);
+    fprintf(out, "// %u glyphs in %u ranges, %u bytes of flash.\n", f->count, o->ranges,
+            flash_bytes(o, f->count));
+    fprintf(out, "#include \"atlas.h\"\n\n");
+
+    fprintf(out, "static const atlas_range_t %s_ranges[] = {\n", name);
+    for (uint32_t i = 0; i < o->ranges; i++) {
+        fprintf(out, "    { 0x%04X, %u, %u },\n", o->range_first[i], o->range_count[i], o->range_glyph[i]);
+    }
+    fprintf(out, "};\n\n");
+
+    char decl[128];
+    if (o->flags & ATLAS_CROPPED) {
+        snprintf(decl, sizeof(decl), "static const uint8_t %s_metrics[]", name);
+        emit_bytes(out, decl, o->metrics, f->count);
+        fprintf(out, "static const uint32_t %s_offsets[] = {", name);
+        for (uint32_t i = 0; i < o->offset_count; i++) {
+            fprintf(out, "%s%u,", i % 8 ? " " : "\n    ", o->offsets[i]);
+        }
+        fprintf(out, "\n};\n\n");
+    }
+    snprintf(decl, sizeof(decl), "static const uint8_t %s_bits[]", name);
+    emit_bytes(out, decl, o->bits, o->bit_bytes);
+
+    fprintf(out, "const atlas_t %s = {\n", name);
+    fprintf(out, "    .ranges = %s_ranges,\n", name);
+    if (o->flags & ATLAS_CROPPED) {
+        fprintf(out, "    .metrics = %s_metrics,\n", name);
+        fprintf(out, "    .offsets = %s_offsets,\n", name);
+    }
+    fprintf(out, "    .bits = %s_bits,\n", name);
+    fprintf(out, "    .range_count = %u,\n", o->ranges);
+    fprintf(out, "    .glyphs = %u,\n", f->count);
+    if (f->missing >= 0) fprintf(out, "    .missing = %d,\n", f->missing);
+    else fprintf(out, "    .missing = ATLAS_NO_GLYPH,\n");
+    fprintf(out, "    .flags = %s,\n",
+            (o->flags & ATLAS_ROW_MASK) ? "ATLAS_CROPPED | ATLAS_ROW_MASK" :
+            (o->flags & ATLAS_CROPPED) ? "ATLAS_CROPPED" : "0");
+    fprintf(out, "};\n");
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: fontc [-n name] [-o out.c] [-r ranges] [-t row] "
+                    "[-c raw|crop|rows] font.bdf|font.psf\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *name = NULL, *out_path = NULL, *src = NULL;
+    int have_top = 0, top_row = 0;
+    int flags = -1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (a[0] != '-' || a[1] == '\0') {
+            if (src) usage();
+            src = a;
+            continue;
+        }
+        if (a[2] != '\0' || i + 1 >= argc) usage();
+        const char *v = argv[++i];
+        switch (a[1]) {
+        case 'n': name = v; break;
+        case 'o': out_path = v; break;
+        case 'r': parse_ranges(v); break;
+        case 't': have_top = 1; top_row = atoi(v); break;
+        case 'c':
+            if (!strcmp(v, "raw")) flags = 0;
+            else if (!strcmp(v, "crop")) flags = ATLAS_CROPPED;
+            else if (!strcmp(v, "rows")) flags = ATLAS_CROPPED | ATLAS_ROW_MASK;
+            else usage();
+            break;
+        default: usage();
+        }
+    }
+    if (!src) usage();
+
+    // Default name from the file: atlas_<base name without extension>
+    char default_name[64];
+    if (!name) {
+        const char *base = strrchr(src, '/');
+        base = base ? base + 1 : src;
+        snprintf(default_name, sizeof(default_name), "atlas_%s", base);
+        for (char *p = default_name; *p; p++) {
+            if (*p == '.') { *p = '\0'; break; }
+            if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') ||
+                  (*p >= '0' && *p <= '9'))) *p = '_';
+        }
+        name = default_name;
+    }
+
+    size_t len;
+    uint8_t *data = read_file(src, &len);
+    font_t f = { calloc(MAX_GLYPHS, sizeof(glyph_t)), 0, -1, 0 };
+    if (!f.glyphs) die("out of memory", NULL);
+
+    if (len >= 9 && !memcmp(data, "STARTFONT", 9)) load_bdf(&f, (char *)data, have_top, top_row);
+    else load_psf(&f, data, len, have_top, top_row);
+    if (f.count == 0) die("no glyphs selected", src);
+
+    // Glyph order follows the code points, the default glyph goes first
+    // when it has none
+    glyph_t missing;
+    int unencoded_missing = f.missing >= 0 && f.glyphs[f.missing].cp == NO_CODEPOINT;
+    if (unencoded_missing) missing = f.glyphs[f.missing];
+    uint32_t missing_cp = f.missing >= 0 ? f.glyphs[f.missing].cp : NO_CODEPOINT;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < f.count; i++) {
+        if (f.glyphs[i].cp != NO_CODEPOINT) f.glyphs[kept++] = f.glyphs[i];
+    }
+    qsort(f.glyphs, kept, sizeof(glyph_t), by_codepoint);
+    // Duplicate code points keep their first bitmap
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < kept; i++) {
+        if (unique && f.glyphs[unique - 1].cp == f.glyphs[i].cp) continue;
+        f.glyphs[unique++] = f.glyphs[i];
+    }
+    f.count = unique;
+    f.missing = -1;
+    if (unencoded_missing) {
+        memmove(&f.glyphs[1], &f.glyphs[0], sizeof(glyph_t) * f.count);
+        f.glyphs[0] = missing;
+        f.count++;
+        f.missing = 0;
+    } else {
+        // Without a default glyph, U+FFFD stands in when the font has it
+        if (missing_cp == NO_CODEPOINT) missing_cp = 0xFFFD;
+        for (uint32_t i = 0; i < f.count; i++) {
+            if (f.glyphs[i].cp == missing_cp) f.missing = (int32_t)i;
+        }
+    }
+    if (f.count > 0xFFFF) die("more than 65535 glyphs", src);
+
+    // Flash per compression mode, the chosen one is marked
+    static atlas_out_t modes[3];
+    static const uint8_t mode_flags[3] = { 0, ATLAS_CROPPED, ATLAS_CROPPED | ATLAS_ROW_MASK };
+    static const char *mode_names[3] = { "raw", "crop", "rows" };
+    atlas_out_t *chosen = NULL;
+
+    for (int m = 0; m < 3; m++) {
+        build(&f, mode_flags[m], &modes[m]);
+        if (flags >= 0 ? mode_flags[m] == flags
+                       : !chosen || flash_bytes(&modes[m], f.count) < flash_bytes(chosen, f.count)) {
+            chosen = &modes[m];
+        }
+    }
+    fprintf(stderr, "%s: %u glyphs, %u lit pixels clipped\n", src, f.count, f.clipped);
+    for (int m = 0; m < 3; m++) {
+        const atlas_out_t *o = &modes[m];
+        fprintf(stderr, "  %-4s %6u bytes: ranges %u, metrics %u, offsets %u, bits %u%s\n",
+                mode_names[m], flash_bytes(o, f.count), o->ranges * ATLAS_RANGE_BYTES,
+                (o->flags & ATLAS_CROPPED) ? f.count : 0,
+                (o->flags & ATLAS_CROPPED) ? o->offset_count * 4 : 0, o->bit_bytes,
+                o == chosen ? " <" : "");
+    }
+
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) die(strerror(errno), out_path);
+    emit(out, name, src, &f, chosen);
+    if (out != stdout) fclose(out);
+
+    for (int m = 0; m < 3; m++) free_out(&modes[m]);
+    free(f.glyphs);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "stm32f4xx.h"
+#include "uart.h"
+#include "clock.h"
+
+ring_t uart_rx;
+
+static uint8_t rx_buf[UART_RX_SIZE];
+static uint32_t rx_pos;         // Buffer index published last
+static uint32_t rx_overruns;
+static uint8_t uart_running;
+
+// Oversampling by 16: BRR is the rounded clock / baud ratio
+static uint32_t uart_brr(void) {
+    uint32_t pclk = clock_pclk2_hz();
+    return (pclk + UART_BAUD / 2) / UART_BAUD;
+}
+
+void uart_init(void) {
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_DMA2EN;
+    RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
+    ring_init(&uart_rx, rx_buf, UART_RX_SIZE);
+    rx_pos = 0;
+
+    // PA9 (TX), PA10 (RX) as alternate function 7, RX pulled up
+    GPIOA->MODER = (GPIOA->MODER & ~(GPIO_MODER_MODER9 | GPIO_MODER_MODER10)) |
+                   GPIO_MODER_MODER9_1 | GPIO_MODER_MODER10_1;
+    GPIOA->PUPDR = (GPIOA->PUPDR & ~GPIO_PUPDR_PUPDR10) | GPIO_PUPDR_PUPDR10_0;
+    GPIOA->AFR[1] = (GPIOA->AFR[1] & ~((0xFU << ((UART_TX_PIN - 8) * 4)) | (0xFU << ((UART_RX_PIN - 8) * 4)))) |
+                    (7U << ((UART_TX_PIN - 8) * 4)) | (7U << ((UART_RX_PIN - 8) * 4));
+
+    // USART1_RX is DMA2 Stream5 Channel4, bytes into the ring, circular
+    DMA2_Stream5->CR = 0;
+    while (DMA2_Stream5->CR & DMA_SxCR_EN);
+    DMA2->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 |
+                  DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5;
+    DMA2_Stream5->PAR = (uint32_t)&USART1->DR;
+    DMA2_Stream5->M0AR = (uint32_t)rx_buf;
+    DMA2_Stream5->NDTR = UART_RX_SIZE;
+    DMA2_Stream5->CR = (4U << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MINC | DMA_SxCR_CIRC |
+                       DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+    DMA2_Stream5->CR |= DMA_SxCR_EN;
+
+    // 8N1, DMA on receive, idle line ends a burst shorter than half the ring
+    USART1->CR1 = 0;
+    USART1->BRR = uart_brr();
+    USART1->CR3 = USART_CR3_DMAR;
+    USART1->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_IDLEIE;
+
+    // Same priority for both so they never preempt each other: the ring
+    // has a single producer
+    NVIC_SetPriority(DMA2_Stream5_IRQn, 3);
+    NVIC_SetPriority(USART1_IRQn, 3);
+    NVIC_EnableIRQ(DMA2_Stream5_IRQn);
+    NVIC_EnableIRQ(USART1_IRQn);
+    uart_running = 1;
+}
+
+// Publish what the DMA wrote since the last call. Half and full transfer
+// interrupts guarantee it never gets a whole ring ahead unseen.
+static void rx_publish(void) {
+    uint32_t pos = (UART_RX_SIZE - DMA2_Stream5->NDTR) & (UART_RX_SIZE - 1);
+    uint32_t n = (pos - rx_pos) & (UART_RX_SIZE - 1);
+    if (n == 0) return;
+
+    // The DMA already overwrote unread bytes. Publish what fits and leave
+    // the rest for later so head stays in step with the DMA, the parser
+    // resyncs on the CRC.
+    uint32_t space = ring_space(&uart_rx);
+    if (n > space) {
+        rx_overruns += n - space;
+        n = space;
+    }
+    ring_produced(&uart_rx, n);
+    rx_pos = (rx_pos + n) & (UART_RX_SIZE - 1);
+}
+
+void DMA2_Stream5_IRQHandler(void) {
+    DMA2->HIFCR = DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTCIF5;
+    rx_publish();
+}
+
+void USART1_IRQHandler(void) {
+    if (USART1->SR & USART_SR_IDLE) {
+        // Cleared by reading SR then DR
+        (void)USART1->DR;
+        rx_publish();
+    }
+}
+
+void uart_recalibrate(void) {
+    if (!uart_running) {
+        return;
+    }
+
+    // Let the last byte leave before the bit timing changes
+    while (!(USART1->SR & USART_SR_TC));
+    USART1->CR1 &= ~USART_CR1_UE;
+    USART1->BRR = uart_brr();
+    USART1->CR1 |= USART_CR1_UE;
+}
+
+uint32_t uart_rx_overruns(void) {
+    return rx_overruns;
+}
+
+void uart_write(const uint8_t *data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        while (!(USART1->SR & USART_SR_TXE));
+        USART1->DR = data[i];
+    }
+}
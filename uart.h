@@ -0,0 +1,37 @@
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include "ring.h"
+
+// USART1 on PA9 (TX) and PA10 (RX), clear of the MAX7219 pins
+#define UART_TX_PIN 9
+#define UART_RX_PIN 10
+
+// 115200 baud carries a full 8-module frame (70 bytes) over 150 times
+// a second, well above the vsync rate
+#ifndef UART_BAUD
+#define UART_BAUD 115200
+#endif
+
+// Receive ring filled by DMA2 Stream5 in circular mode, power of two.
+// Holds several full frames so the parser can run from a scheduler task.
+#define UART_RX_SIZE 1024
+
+// Received bytes. The DMA half/full and line idle interrupts are the
+// producer and publish what the DMA wrote, the main loop consumes.
+extern ring_t uart_rx;
+
+// Configure USART1 and start the circular RX DMA
+void uart_init(void);
+
+// Reload the baud rate after SystemCoreClock changed
+void uart_recalibrate(void);
+
+// Bytes the DMA wrote over data not consumed yet
+uint32_t uart_rx_overruns(void);
+
+// Blocking transmit, for replies and debugging
+void uart_write(const uint8_t *data, uint16_t len);
+
+#endif
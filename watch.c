@@ -0,0 +1,74 @@
+#include "watch.h"
+#include "font.h"
+
+void watch_init(watch_t *w, uint8_t show_seconds) {
+    canvas_init(&w->canvas, w->buf, 8 * MAX7219_NUM_DEVICES, 8);
+    layout_grid(&w->layout, MAX7219_NUM_DEVICES, 1, 0, MODULE_ROT_0);
+    for (int i = 0; i < 6; i++) {
+        w->digits[i] = 0xFF;
+    }
+    w->show_seconds = show_seconds;
+    w->origin = (int16_t)(8 * MAX7219_NUM_DEVICES - WATCH_WIDTH(show_seconds)) / 2;
+}
+
+// Left edge of digit i: two digits, a separator, two digits, ...
+static int16_t digit_x(const watch_t *w, uint8_t i) {
+    return w->origin + i * WATCH_DIGIT_W + (i / 2) * WATCH_COLON_W;
+}
+
+static void draw_glyph_cell(watch_t *w, int16_t x, uint16_t width, uint8_t index) {
+    canvas_rect(&w->canvas, x, 0, width, 8, 0, 1);
+    canvas_glyph(&w->canvas, x - font_left(index), 0, index);
+}
+
+uint8_t watch_update(watch_t *w, const watch_time_t *t, uint8_t rows[][8]) {
+    uint8_t digits[6] = {
+        t->hours / 10, t->hours % 10,
+        t->minutes / 10, t->minutes % 10,
+        t->seconds / 10, t->seconds % 10,
+    };
+    uint8_t count = w->show_seconds ? 6 : 4;
+    uint8_t changed = 0;
+
+    // Separators only once, they never change
+    if (w->digits[0] == 0xFF) {
+        for (uint8_t i = 2; i < count; i += 2) {
+            draw_glyph_cell(w, digit_x(w, i) - WATCH_COLON_W, WATCH_COLON_W, GLYPH_COLON);
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (digits[i] == w->digits[i]) continue;
+        w->digits[i] = digits[i];
+        draw_glyph_cell(w, digit_x(w, i), WATCH_DIGIT_W, GLYPH_DIGIT_0 + digits[i]);
+        changed |= (uint8_t)(1 << i);
+    }
+
+    if (changed) {
+        viewport_render(&w->canvas, &w->layout, 0, 0, rows);
+    }
+    return changed;
+}
+
+static uint8_t bcd(uint32_t v) {
+    return (uint8_t)((v >> 4) * 10 + (v & 0x0F));
+}
+
+void watch_time_from_bcd(uint32_t tr, watch_time_t *t) {
+    t->hours = bcd((tr >> 16) & 0x3F);
+    t->minutes = bcd((tr >> 8) & 0x7F);
+    t->seconds = bcd(tr & 0x7F);
+}
+
+uint32_t watch_time_to_bcd(const watch_time_t *t) {
+    return ((uint32_t)(t->hours / 10) << 20) | ((uint32_t)(t->hours % 10) << 16) |
+           ((uint32_t)(t->minutes / 10) << 12) | ((uint32_t)(t->minutes % 10) << 8) |
+           ((uint32_t)(t->seconds / 10) << 4) | (t->seconds % 10);
+}
+
+void watch_time_add(watch_time_t *t, uint32_t seconds) {
+    uint32_t total = (t->hours * 3600UL + t->minutes * 60UL + t->seconds + seconds) % 86400UL;
+    t->hours = (uint8_t)(total / 3600);
+    t->minutes = (uint8_t)(total / 60 % 60);
+    t->seconds = (uint8_t)(total % 60);
+}
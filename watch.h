@@ -0,0 +1,50 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <stdint.h>
+#include "canvas.h"
+
+// Clock face: HH:MM, or HH:MM:SS, drawn with the digit glyphs across the
+// chain. Only digits that changed are redrawn. The time comes from the
+// caller: the RTC on target, watch_time_add() stepping a simulated one
+// in tests/test_watch.c.
+
+// Digit cell (6 lit columns and a gap) and separator cell (colon and a gap)
+#define WATCH_DIGIT_W 7
+#define WATCH_COLON_W 3
+
+// Width of the face in pixels
+#define WATCH_WIDTH(seconds) \
+    ((seconds) ? 6 * WATCH_DIGIT_W + 2 * WATCH_COLON_W : 4 * WATCH_DIGIT_W + WATCH_COLON_W)
+
+typedef struct {
+    uint8_t hours;
+    uint8_t minutes;
+    uint8_t seconds;
+} watch_time_t;
+
+typedef struct {
+    canvas_t canvas;
+    uint8_t buf[MAX7219_NUM_DEVICES * 8];
+    layout_t layout;
+    uint8_t digits[6];      // Digits on the canvas, 0xFF before the first draw
+    uint8_t show_seconds;
+    int16_t origin;         // Left edge of the face, centered on the chain
+} watch_t;
+
+// Clear the face, the first update draws everything
+void watch_init(watch_t *w, uint8_t show_seconds);
+
+// Redraw the digits of t that differ from the last update. Returns a
+// mask of the digits redrawn (bit 0 = tens of hours) and fills rows when
+// it is not 0.
+uint8_t watch_update(watch_t *w, const watch_time_t *t, uint8_t rows[][8]);
+
+// RTC_TR layout (BCD) to time and back
+void watch_time_from_bcd(uint32_t tr, watch_time_t *t);
+uint32_t watch_time_to_bcd(const watch_time_t *t);
+
+// Advance by seconds with a 24 h wrap, for a simulated RTC
+void watch_time_add(watch_time_t *t, uint32_t seconds);
+
+#endif
@@ -0,0 +1,97 @@
+#include "stm32f4xx.h"
+#include "watchdog.h"
+#include "max7219.h"
+#include "framebuffer.h"
+#include "power.h"
+
+static watchdog_step_t next_step;
+static watchdog_stats_t stats;
+
+void watchdog_iwdg_start(uint32_t timeout_ms) {
+    // Smallest prescaler (4 << pr) that fits the 12-bit reload
+    uint32_t pr = 0;
+    uint32_t reload = timeout_ms * (WATCHDOG_LSI_HZ / 1000) / 4;
+    while (pr < 6 && reload > 0x1000) {
+        pr++;
+        reload >>= 1;
+    }
+    if (reload > 0x1000) reload = 0x1000;
+    if (reload == 0) reload = 1;
+
+    IWDG->KR = 0xCCCC;  // Start
+    IWDG->KR = 0x5555;  // Unlock PR and RLR
+    IWDG->PR = pr;
+    IWDG->RLR = reload - 1;
+    while (IWDG->SR & (IWDG_SR_PVU | IWDG_SR_RVU));
+    IWDG->KR = 0xAAAA;
+}
+
+void watchdog_kick(void) {
+    IWDG->KR = 0xAAAA;
+}
+
+uint8_t watchdog_iwdg_reset(void) {
+    uint8_t iwdg = (RCC->CSR & RCC_CSR_IWDGRSTF) ? 1 : 0;
+    RCC->CSR |= RCC_CSR_RMVF;
+    return iwdg;
+}
+
+static watchdog_step_t watchdog_advance(watchdog_step_t step) {
+    next_step = (watchdog_step_t)(step + 1);
+    if (next_step >= WATCHDOG_STEP_COUNT) {
+        next_step = WATCHDOG_STEP_TEST;
+        stats.passes++;
+    }
+    return step;
+}
+
+watchdog_step_t watchdog_refresh_step(void) {
+    watchdog_step_t step = next_step;
+    uint32_t before = transport_bytes_sent();
+
+    if (step == WATCHDOG_STEP_ROWS) {
+        // Every row goes out with the next flip, in a single burst
+        fb_invalidate();
+        fb_swap();
+        return watchdog_advance(step);
+    }
+
+    fb_vsync_hold();
+    switch (step) {
+    case WATCHDOG_STEP_TEST:
+        send_cmd(REG_DISPLAY_TEST, 0x00);
+        break;
+    case WATCHDOG_STEP_DECODE:
+        send_cmd(REG_DECODE_MODE, 0x00);
+        break;
+    case WATCHDOG_STEP_SCAN_LIMIT:
+        send_cmd(REG_SCAN_LIMIT, 0x07);
+        break;
+    case WATCHDOG_STEP_INTENSITY:
+        send_cmd(REG_INTENSITY, max7219_get_intensity());
+        break;
+    case WATCHDOG_STEP_SHUTDOWN: {
+        uint8_t on[MAX7219_NUM_DEVICES];
+        for (int dev = 0; dev < MAX7219_NUM_DEVICES; dev++) {
+            on[dev] = power_module_is_on(dev);
+        }
+        send_row(REG_SHUTDOWN, on);
+        break;
+    }
+    default:
+        break;
+    }
+    fb_vsync_release();
+
+    stats.bytes += transport_bytes_sent() - before;
+    return watchdog_advance(step);
+}
+
+void watchdog_task(void) {
+    watchdog_refresh_step();
+    watchdog_kick();
+}
+
+void watchdog_get_stats(watchdog_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,52 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+
+// The MAX7219 can drop its configuration after a supply glitch or ESD
+// (into shutdown, display test or a short scan limit). The refresh
+// rewrites the control registers from the driver's cached settings, one
+// register per call so a full pass never holds up a frame.
+typedef enum {
+    WATCHDOG_STEP_TEST,         // REG_DISPLAY_TEST = 0
+    WATCHDOG_STEP_DECODE,       // REG_DECODE_MODE = 0
+    WATCHDOG_STEP_SCAN_LIMIT,   // REG_SCAN_LIMIT = 7
+    WATCHDOG_STEP_INTENSITY,    // Current intensity
+    WATCHDOG_STEP_SHUTDOWN,     // Per device, modules blanked by power.c stay off
+    WATCHDOG_STEP_ROWS,         // Resend every digit row with the next flip
+    WATCHDOG_STEP_COUNT
+} watchdog_step_t;
+
+// Period of the refresh task, a full pass takes WATCHDOG_STEP_COUNT calls
+#ifndef WATCHDOG_PERIOD_MS
+#define WATCHDOG_PERIOD_MS 100
+#endif
+
+// Independent watchdog timeout (LSI, 32 kHz nominal)
+#ifndef WATCHDOG_IWDG_MS
+#define WATCHDOG_IWDG_MS 2000
+#endif
+#define WATCHDOG_LSI_HZ 32000
+
+typedef struct {
+    uint32_t passes;            // Complete refresh passes
+    uint32_t bytes;             // Bus bytes of the register steps (the row
+                                // resend goes out with the next flip)
+} watchdog_stats_t;
+
+// Start the IWDG, it can only be stopped by a reset
+void watchdog_iwdg_start(uint32_t timeout_ms);
+void watchdog_kick(void);
+
+// Non-zero if the last reset came from the IWDG, clears the reset flags
+uint8_t watchdog_iwdg_reset(void);
+
+// Rewrite one register of the pass, returns the step done
+watchdog_step_t watchdog_refresh_step(void);
+
+// Scheduler task: one refresh step and an IWDG kick
+void watchdog_task(void);
+
+void watchdog_get_stats(watchdog_stats_t *stats);
+
+#endif